@@ -0,0 +1,39 @@
+// Converter of PDF set member grids from the text lhagrid1 format to binary .lhab companion files
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  if (argc < 2 || string(argv[1]) == "-h" || string(argv[1]) == "--help") {
+    cout << "Usage: lhapdf-mkbinary SETNAME [SETNAME ...]" << endl;
+    cout << "Write a binary .lhab file next to each member .dat file of the given PDF sets." << endl;
+    cout << "LHAPDF uses these in place of the .dat files while those are unchanged." << endl;
+    return (argc < 2) ? 1 : 0;
+  }
+
+  // Always read the text files, ignoring any existing binary files
+  LHAPDF::getConfig().set_entry("BinaryGrids", false);
+
+  try {
+    for (int iarg = 1; iarg < argc; ++iarg) {
+      const string setname = argv[iarg];
+      const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+      for (size_t imem = 0; imem < set.size(); ++imem) {
+        const string mempath = LHAPDF::findpdfmempath(setname, imem);
+        const LHAPDF::GridPDF pdf(mempath);
+        const string binpath = LHAPDF::GridPDF::binaryDataPath(mempath);
+        pdf.writeBinaryData(binpath);
+        if (LHAPDF::verbosity() > 0) cout << "Wrote " << binpath << endl;
+      }
+    }
+  } catch (const exception& e) {
+    cerr << "lhapdf-mkbinary: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -10,6 +10,8 @@
 #include "LHAPDF/Utils.h"
 #include "LHAPDF/Exceptions.h"
 #include "LHAPDF/KnotArray.h"
+#include <atomic>
+#include <mutex>
 
 namespace LHAPDF {
 
@@ -20,6 +22,9 @@ namespace LHAPDF {
   /// objects: hence they can be used by external code that actually doesn't
   /// want to do anything at all with PDFs, but which just wants to do some
   /// alpha_s interpolation.
+  ///
+  /// Once set up, the alphasQ2 and other const methods may be called
+  /// concurrently from several threads; the setters may not.
   class AlphaS {
   public:
 
@@ -39,6 +44,14 @@ namespace LHAPDF {
     /// @todo Throw error in this base method if Q < Lambda?
     virtual double alphasQ2(double q2) const = 0;
 
+    /// @brief Calculate alphaS(Q2) for the @a n scales in @a q2s, writing the values to @a out
+    ///
+    /// The batch equivalent of alphasQ2(q2), with identical results. This
+    /// default loops over the single-value method; the concrete calculators
+    /// do their setup once per batch, without heap allocation, so scans over
+    /// many scales should use this.
+    virtual void alphasQ2(const double* q2s, double* out, size_t n) const;
+
     //@}
 
 
@@ -181,6 +194,12 @@ namespace LHAPDF {
     /// Calculate alphaS(Q2)
     double alphasQ2(double q2) const;
 
+    /// @brief Calculate alphaS(Q2) for @a n scales
+    ///
+    /// The flavor thresholds, Lambda values and beta function coefficients
+    /// are flattened into per-nf tables once for the batch.
+    void alphasQ2(const double* q2s, double* out, size_t n) const;
+
     /// Analytic has its own numFlavorsQ2 which respects the min/max nf set by the Lambdas
     int numFlavorsQ2(double q2) const;
 
@@ -193,6 +212,9 @@ namespace LHAPDF {
     /// Get lambdaQCD for nf
     double _lambdaQCD(int nf) const;
 
+    /// The analytic approximation at Q2, for the given LambdaQCD and beta function coefficients
+    double _alphasQ2(double q2, double lambdaQCD, const double* beta) const;
+
     /// Recalculate min/max flavors in case lambdas have changed
     void _setFlavors();
 
@@ -209,7 +231,13 @@ namespace LHAPDF {
 
 
 
-  /// Interpolate alpha_s from tabulated points in Q2 via metadata
+  /// @brief Interpolate alpha_s from tabulated points in Q2 via metadata
+  ///
+  /// The knots and values are kept as given, i.e. as one flat array with the
+  /// subgrids concatenated and each boundary knot repeated. All the lookup
+  /// data is built eagerly when they are set: the knot logs, the derivative
+  /// d(alpha_s)/dlog(Q2) at each knot, and a bucket lookup in log(Q2) over
+  /// the distinct knots, giving the interval in constant time.
   ///
   /// @todo Extrapolation: log-gradient xpol at low Q, const at high Q?
   class AlphaS_Ipol : public AlphaS {
@@ -221,6 +249,9 @@ namespace LHAPDF {
     /// Calculate alphaS(Q2)
     double alphasQ2(double q2) const;
 
+    /// Calculate alphaS(Q2) for @a n scales
+    void alphasQ2(const double* q2s, double* out, size_t n) const;
+
     /// Set the array of Q values for interpolation
     ///
     /// Writes to the same internal arrays as setQ2Values, appropriately transformed.
@@ -231,55 +262,91 @@ namespace LHAPDF {
     /// Subgrids are represented by repeating the values which are the end of
     /// one subgrid and the start of the next. The supplied vector must match
     /// the layout of alpha_s values.
-    void setQ2Values(const std::vector<double>& q2s) { _q2s = q2s; }
+    void setQ2Values(const std::vector<double>& q2s) { _q2s = q2s; _setup_grids(); }
 
     /// Set the array of alpha_s(Q2) values for interpolation
     ///
     /// The supplied vector must match the layout of Q2 knots.  Subgrids may
     /// have discontinuities, i.e. different alpha_s values on either side of a
     /// subgrid boundary (for the same Q values).
-    void setAlphaSValues(const std::vector<double>& as) { _as = as; }
+    void setAlphaSValues(const std::vector<double>& as) { _as = as; _setup_grids(); }
 
 
   private:
 
     /// Standard cubic interpolation formula
     double _interpolateCubic(double T, double VL, double VDL, double VH, double VDH) const;
-    /// Get the gradient for a patch in the middle of the grid
-    double _ddq_central( size_t i ) const;
-    /// Get the gradient for a patch at the low end of the grid
-    double _ddq_forward( size_t i ) const;
-    /// Get the gradient for a patch at the high end of the grid
-    double _ddq_backward( size_t i ) const;
 
-    /// Synchronise the contents of the single Q2 / alpha_s vectors into subgrid objects
-    /// @note This is const so it can be called silently from a const method
-    void _setup_grids() const;
+    /// Interpolate or extrapolate at @a q2, with the tables set up
+    double _alphasQ2(double q2) const;
 
+    /// Throw the error for queries without valid tables
+    void _throwNoGrids() const;
+
+    /// @brief Build the lookup tables from the single Q2 / alpha_s vectors
+    ///
+    /// Called whenever either vector is set, so that the queries only read.
+    void _setup_grids();
 
-    /// Map of AlphaSArrays "binned" for lookup by low edge in (log)Q2
-    /// @note This is mutable so it can be initialized silently from a const method
-    mutable std::map<double, AlphaSArray> _knotarrays;
 
-    /// Array of ipol knots in Q2
+    /// Array of ipol knots in Q2, with the subgrid boundaries repeated
     std::vector<double> _q2s;
     /// Array of alpha_s values for the Q2 knots
     std::vector<double> _as;
 
+    /// log(Q2) of each knot
+    std::vector<double> _logq2s;
+    /// d(alpha_s)/dlog(Q2) at each knot: central, or one-sided at the subgrid edges
+    std::vector<double> _dasdlogq2s;
+
+    /// The distinct Q2 knots, strictly increasing, for the interval lookup
+    std::vector<double> _lookupq2s;
+    /// Flat index of the interval starting at each distinct knot, in the higher subgrid at boundaries
+    std::vector<size_t> _iknots;
+    /// Bucket lookup in log(Q2) over the distinct knots
+    KnotLookup _lookup;
+
+    /// Log-log gradient of the extrapolation below the lowest knot
+    double _lowloggrad;
+
   };
 
 
 
-  /// Solve the differential equation in alphaS using an implementation of RK4
+  /// @brief Solve the differential equation in alphaS using an implementation of RK4
+  ///
+  /// The ODE is solved once only, on the first query after the parameters are
+  /// set, and interpolated thereafter: concurrent first queries wait for the
+  /// solution rather than racing to compute it.
+  ///
+  /// The solution is tabulated at the interpolation knots either by the
+  /// original fixed-order RK4 with step halving, solved knot by knot, or by an
+  /// adaptive Dormand-Prince 5(4) integration in log(Q2) with error control,
+  /// which fills the knots on each side of the reference point from its dense
+  /// output in a single sweep.
+  ///
+  /// If a cache directory is set, by $LHAPDF_CACHE or setCachePath, the
+  /// tabulated solution is stored there under a hash of the LHAPDF version and
+  /// all the parameters and knots, and is loaded by later solutions with the
+  /// same parameters, in this or other processes, rather than being solved again.
   class AlphaS_ODE : public AlphaS {
   public:
 
+    /// ODE integration methods
+    enum Solver { RK4, DOPRI5 };
+
+    /// Constructor, with the RK4 solver and the ODE not yet solved
+    AlphaS_ODE() : _solver(RK4), _calculated(false) { }
+
     /// Implementation type of this solver
     std::string type() const { return "ode"; }
 
     /// Calculate alphaS(Q2)
     double alphasQ2( double q2 ) const;
 
+    /// Calculate alphaS(Q2) for @a n scales, interpolating in the solution tables
+    void alphasQ2(const double* q2s, double* out, size_t n) const;
+
     /// Set MZ, and also the caching flag
     void setMZ( double mz ) { _mz = mz; _calculated = false; }
 
@@ -300,6 +367,12 @@ namespace LHAPDF {
     /// Writes to the same internal array as setQValues, appropriately transformed.
     void setQ2Values( std::vector<double> q2s ) { _q2s = q2s; _calculated = false; }
 
+    /// Set the ODE integration method, and also the caching flag
+    void setSolver( Solver solver ) { _solver = solver; _calculated = false; }
+
+    /// The ODE integration method
+    Solver solver() const { return _solver; }
+
 
   private:
 
@@ -316,15 +389,37 @@ namespace LHAPDF {
     /// Solve alpha_s for q2 using RK4
     void _solve(double q2, double& t, double& y, const double& allowed_relative, double h, double accuracy) const;
 
-    /// Create interpolation grid
+    /// Create interpolation grid, with the solution lock held
     void _interpolate() const;
 
+    /// The parameters which determine the solution, identifying it in the on-disk cache
+    std::string _cacheParams() const;
+
+    /// Tabulate alpha_s at the Q2 knots with the RK4 solver
+    std::vector<double> _tabulateRK4() const;
+
+    /// Tabulate alpha_s at the Q2 knots with the Dormand-Prince solver
+    std::vector<double> _tabulateDoPri5() const;
+
+    /// @brief Fill @a alphas at the knots from @a first, in direction @a dir, up to but excluding @a end
+    ///
+    /// Integrates with the Dormand-Prince solver from alpha_s = y at Q2 = t,
+    /// which must not be beyond the first knot.
+    void _sweepDoPri5(int first, int end, int dir, double t, double y, std::vector<double>& alphas) const;
+
+
+    /// The ODE integration method
+    Solver _solver;
+
 
     /// Vector of Q2s in case specific anchor points are used
     mutable std::vector<double> _q2s;
 
     /// Whether or not the ODE has been solved yet
-    mutable bool _calculated;
+    mutable std::atomic<bool> _calculated;
+
+    /// Lock for solving the ODE once only
+    mutable std::mutex _calcmutex;
 
     /// The interpolation used to get Alpha_s after the ODE has been solved
     mutable AlphaS_Ipol _ipol;
@@ -17,7 +17,37 @@ namespace LHAPDF {
   /// This class will interpolate in 2D using a bicubic hermite spline.
   class BicubicInterpolator : public Interpolator {
   public:
+
+    /// @brief Constructor
+    ///
+    /// If @a precomputed is true, the d(xf)/dx and d(xf)/dQ2 derivatives at
+    /// the knots are computed once for each knot array when the grid is loaded,
+    /// rather than by finite differences in every call.
+    BicubicInterpolator(bool precomputed=false) : _precomputed(precomputed) { }
+
+    /// Compute the knot derivative tables, if in precomputed mode
+    void prepare(KnotArray1F& subgrid) const;
+
     double _interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const;
+
+    /// Interpolate several flavors with the same knots, sharing the interpolation weights
+    void _interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                           double x, size_t ix, double q2, size_t iq2, double* rtn) const;
+
+    /// Cubic interpolation stencils in x and Q2, or linear ones for fewer than 4 Q2 knots, for the vectorised kernels
+    bool _stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const;
+
+    /// Indices and Hermite weights of a point, for the query cache
+    void _cellWeights(const KnotArray1F& subgrid, CellWeights& w) const;
+
+    /// Interpolate a single flavor from cached Hermite weights
+    double _interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const;
+
+  private:
+
+    /// Use precomputed knot derivatives?
+    bool _precomputed;
+
   };
 
 
@@ -16,6 +16,22 @@ namespace LHAPDF {
   class BilinearInterpolator : public Interpolator {
   public:
     double _interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const;
+
+    /// Interpolate several flavors with the same knots, sharing the interpolation weights
+    void _interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                           double x, size_t ix, double q2, size_t iq2, double* rtn) const;
+
+    /// The linear stencils are limited by the memory accesses, so the vectorised kernels are no faster
+    bool simdFaster() const { return false; }
+
+    /// Linear interpolation stencils in x and Q2, for the vectorised kernels
+    bool _stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const;
+
+    /// Indices and linear weights of a point, for the query cache
+    void _cellWeights(const KnotArray1F& subgrid, CellWeights& w) const;
+
+    /// Interpolate a single flavor from cached linear weights
+    double _interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const;
   };
 
 
@@ -14,11 +14,59 @@ namespace LHAPDF {
 
   /// The ContinuationExtrapolator provides an implementation of the extrapolation used in
   /// the MSTW standalone code (and LHAPDFv5 when using MSTW sets), G. Watt, October 2014.
+  ///
+  /// The edge knots and their logs, and for each flavor the PDF values at the
+  /// corner points used beyond both an x and a Q2 edge, are tabulated by
+  /// prepare(), so that the corner regions need no interpolation at all and
+  /// the others only the two at the edge point(s) nearest the query. The
+  /// results are identical to those without the tables.
   class ContinuationExtrapolator : public Extrapolator {
   public:
 
+    /// Default constructor, with no precomputed data
+    ContinuationExtrapolator() : _prepared(false) { }
+
+    /// Tabulate the grid edges and the flavors' corner values
+    void prepare();
+
+    /// Drop the tabulated edge data
+    void unprepare();
+
     double extrapolateXQ2(int id, double x, double q2) const;
 
+
+  private:
+
+    /// Knots at the grid edges, and the logs used in the linear extrapolations
+    struct Edges {
+      double xmin, xmin1, xmax, q2min, q2max1, q2max;
+      double logxmin, logxmin1, logq2max, logq2max1;
+    };
+
+    /// Read the edge knots from the bound PDF
+    void _findEdges(Edges& edges) const;
+
+    /// @brief Interpolate the PDF values of PID @a id at the four corner points beyond an x and a Q2 edge
+    ///
+    /// If @a high, at (xMin,q2Max), (xMin,q2Max1), (xMin1,q2Max) and (xMin1,q2Max1), otherwise at
+    /// (xMin,q2Min), (xMin1,q2Min), (xMin,1.01*q2Min) and (xMin1,1.01*q2Min), written to @a rtn.
+    void _interpolateCorners(int id, bool high, const Edges& edges, double* rtn) const;
+
+    /// The four corner values of PID @a id as above, from the tables if present, else interpolated into @a tmp
+    const double* _cornerValues(int id, bool high, const Edges& edges, double* tmp) const;
+
+    /// Whether the tables below are filled
+    bool _prepared;
+
+    /// The tabulated edges
+    Edges _edges;
+
+    /// Sorted PIDs with tabulated corner values
+    std::vector<int> _cornerids;
+
+    /// The eight corner values of each PID in _cornerids, the four high-Q2 ones first
+    std::vector<double> _corners;
+
   };
 
 
@@ -66,6 +66,14 @@ namespace LHAPDF {
   };
 
 
+  /// @brief Error for file writing errors.
+  class WriteError : public Exception {
+  public:
+    /// Constructor with error description string
+    WriteError(const std::string& what) : Exception(what) {}
+  };
+
+
   /// @brief Error for requests for unsupported/invalid flavour PIDs.
   class FlavorError : public Exception {
   public:
@@ -28,10 +28,10 @@ namespace LHAPDF {
     //@{
 
     /// Bind to a GridPDF
-    void bind(const GridPDF* pdf) { _pdf = pdf; }
+    void bind(const GridPDF* pdf) { _pdf = pdf; unprepare(); }
 
     /// Unbind from GridPDF
-    void unbind() { _pdf = 0; }
+    void unbind() { _pdf = 0; unprepare(); }
 
     /// Identify whether this Extrapolator has an associated PDF
     bool hasPDF() { return _pdf != 0; }
@@ -39,6 +39,20 @@ namespace LHAPDF {
     /// Get the associated GridPDF
     const GridPDF& pdf() const { return *_pdf; }
 
+    /// @brief Precompute any data used by this extrapolator from the bound PDF
+    ///
+    /// Called by the bound GridPDF once both its grid data and interpolator
+    /// are available, and again whenever either is replaced, e.g. to tabulate
+    /// the PDF values at the grid edges. Does nothing by default.
+    virtual void prepare() { }
+
+    /// @brief Drop any precomputed data
+    ///
+    /// Called when the bound grid may be about to change, after which the
+    /// extrapolation must work without the precomputed data until the next
+    /// prepare call. Does nothing by default.
+    virtual void unprepare() { }
+
     //@}
 
 
@@ -8,6 +8,7 @@
 #define LHAPDF_Factories_H
 
 #include <string>
+#include <memory>
 
 namespace LHAPDF {
 
@@ -16,10 +17,13 @@ namespace LHAPDF {
   class PDF;
   class Info;
   class PDFSet;
+  class LazyPDFs;
   class PDFInfo;
   class Config;
+  class GridPDF;
   class Interpolator;
   class Extrapolator;
+  class GridEvaluatorBase;
   class AlphaS;
 
 
@@ -125,6 +129,13 @@ namespace LHAPDF {
     for (size_t i = 0; i < rawptrs.size(); ++i) pdfs.push_back(PTR(rawptrs[i]));
   }
 
+  /// @brief Get a container of all PDFs in a named set, each loaded on first access
+  ///
+  /// The memory budget for loaded members, @a budgetMB, is in MB with 0
+  /// meaning no limit; if negative, the LazyMemoryBudget config key is used.
+  /// @see LazyPDFs
+  LazyPDFs mkLazyPDFs(const std::string& setname, double budgetMB=-1);
+
   //@}
 
 
@@ -145,6 +156,16 @@ namespace LHAPDF {
   Extrapolator* mkExtrapolator(const std::string& name);
 
 
+  /// @brief Devirtualised grid evaluator factory
+  ///
+  /// Returns a 'new'ed GridEvaluator instantiation for the types of the
+  /// interpolator and extrapolator currently set on @a pdf, as chosen from
+  /// the Interpolator and Extrapolator metadata or by setInterpolator and
+  /// setExtrapolator. The caller is responsible for deletion of the created
+  /// object, which must not outlive the PDF.
+  GridEvaluatorBase* mkGridEvaluator(const GridPDF& pdf);
+
+
   /// @name Factory functions for making AlphaS objects
   //@{
 
@@ -157,6 +178,18 @@ namespace LHAPDF {
   /// the caller is responsible for deletion of the created object.
   AlphaS* mkAlphaS(const Info& info);
 
+  /// @brief Get a shared AlphaS object for an Info object
+  ///
+  /// As mkAlphaS(info), but with the AlphaS objects interned by their full
+  /// parameter set, i.e. the metadata values of the alpha_s type, QCD order,
+  /// quark masses and thresholds, flavor scheme, reference values and knots:
+  /// while an object made for the same parameters is alive, it is returned
+  /// again rather than a new one being made, so that e.g. all the members of
+  /// a set share one solver. The object is deleted with its last user. Being
+  /// shared, it is returned as const; its const methods may be called
+  /// concurrently.
+  std::shared_ptr<const AlphaS> mkSharedAlphaS(const Info& info);
+
   /// @brief Make an AlphaS object for the named PDF set
   ///
   /// The type and configuration of the returned AlphaS is chosen based on the
@@ -0,0 +1,84 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_FlavorLayout_H
+#define LHAPDF_FlavorLayout_H
+
+#include "LHAPDF/Utils.h"
+
+namespace LHAPDF {
+
+
+  /// @brief An ordered list of PIDs, defining the slots of an all-flavor PDF output buffer
+  ///
+  /// Built once, e.g. before an event loop, and passed to the PDF::xfxQ2
+  /// methods which write into caller-provided buffers, with the value for
+  /// PID pid(j) in slot j. Any PIDs may be used, including the photon and
+  /// other extended PIDs, with the value 0 for those not defined by the PDF
+  /// and PID 0 treated as the gluon. No heap allocation is done by the
+  /// queries themselves.
+  class FlavorLayout {
+  public:
+
+    /// Default constructor, for the LHAPDF5 layout of the 13 partons
+    FlavorLayout() {
+      for (int id = -6; id <= 6; ++id) _add(id);
+    }
+
+    /// Constructor from the list of PIDs, in slot order
+    FlavorLayout(const std::vector<int>& pids) {
+      for (int id : pids) _add(id);
+    }
+
+    /// @brief The LHAPDF5 layout, as used by the vector-filling PDF::xfxQ2
+    ///
+    /// 13 slots for PIDs -6 to 6, with the gluon as PID 0 in slot 6.
+    static FlavorLayout lhapdf5() {
+      return FlavorLayout();
+    }
+
+    /// The LHAPDF5 layout, with the photon (PID 22) appended in slot 13
+    static FlavorLayout lhapdf5Photon() {
+      FlavorLayout rtn;
+      rtn._add(22);
+      return rtn;
+    }
+
+    /// Number of slots
+    size_t size() const { return _pids.size(); }
+
+    /// The PIDs of the slots, as given
+    const std::vector<int>& pids() const { return _pids; }
+
+    /// The PID of slot @a j
+    int pid(size_t j) const { return _pids[j]; }
+
+    /// The slot of PID @a id, or -1 if not in the layout
+    int slot(int id) const {
+      const std::vector<int>::const_iterator it = std::find(_pids.begin(), _pids.end(), id);
+      return (it != _pids.end()) ? int(it - _pids.begin()) : -1;
+    }
+
+    /// The PIDs as queried, i.e. with the gluon as 21
+    const int* queryIDs() const { return _queryids.data(); }
+
+
+  private:
+
+    /// Append a slot for PID @a id
+    void _add(int id) {
+      _pids.push_back(id);
+      _queryids.push_back((id != 0) ? id : 21); //< @note Treat 0 as an alias for 21
+    }
+
+    /// The PIDs, and as queried
+    std::vector<int> _pids, _queryids;
+
+  };
+
+
+}
+#endif
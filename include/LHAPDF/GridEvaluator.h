@@ -0,0 +1,161 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_GridEvaluator_H
+#define LHAPDF_GridEvaluator_H
+
+#include "LHAPDF/GridPDF.h"
+#include "LHAPDF/BilinearInterpolator.h"
+#include "LHAPDF/BicubicInterpolator.h"
+#include "LHAPDF/LogBilinearInterpolator.h"
+#include "LHAPDF/LogBicubicInterpolator.h"
+#include "LHAPDF/LogBicubicPatchInterpolator.h"
+#include "LHAPDF/ErrExtrapolator.h"
+#include "LHAPDF/NearestPointExtrapolator.h"
+#include "LHAPDF/ContinuationExtrapolator.h"
+#include <typeinfo>
+
+namespace LHAPDF {
+
+
+  /// @brief Interface of the devirtualised GridPDF evaluators
+  ///
+  /// Made by mkGridEvaluator for the interpolator and extrapolator of a
+  /// GridPDF, so that a query costs at most one virtual call, or none for a
+  /// batch of points.
+  class GridEvaluatorBase {
+  public:
+
+    /// Constructor from the evaluated PDF
+    GridEvaluatorBase(const GridPDF& pdf) : _pdf(&pdf) { }
+
+    /// Destructor to allow inheritance
+    virtual ~GridEvaluatorBase() { }
+
+    /// The evaluated PDF
+    const GridPDF& pdf() const { return *_pdf; }
+
+    /// Get xf(x,Q2) for PID @a id, as for PDF::xfxQ2
+    virtual double xfxQ2(int id, double x, double q2) const = 0;
+
+    /// Get xf(x,Q) for PID @a id, as for PDF::xfxQ
+    double xfxQ(int id, double x, double q) const {
+      return xfxQ2(id, x, q*q);
+    }
+
+    /// Get xf(x,Q2) for PID @a id at @a npoints points, with the result for point i in rtn[i]
+    virtual void xfxQ2(int id, const double* xs, const double* q2s, size_t npoints, double* rtn) const = 0;
+
+  protected:
+
+    /// The evaluated PDF
+    const GridPDF* _pdf;
+
+  };
+
+
+  /// @brief GridPDF evaluator specialised at compile time on the interpolator and extrapolator types
+  ///
+  /// Gives the same values as PDF::xfxQ2, including the range checks and
+  /// positivity forcing, but with the interpolator and extrapolator methods
+  /// called non-virtually, and the grid range and ForcePositive setting cached
+  /// on construction. The instantiations for the LHAPDF interpolators and
+  /// extrapolators are compiled together with each interpolator, so that its
+  /// kernel is inlined into the hot path.
+  ///
+  /// The evaluator refers to the PDF's interpolator and extrapolator, so is
+  /// only valid while the PDF exists and they are not replaced.
+  template <typename IPOL, typename XPOL>
+  class GridEvaluator final : public GridEvaluatorBase {
+  public:
+
+    /// @brief Constructor from a loaded GridPDF
+    ///
+    /// Throws a UserError if the PDF's interpolator and extrapolator are not
+    /// exactly of types IPOL and XPOL.
+    GridEvaluator(const GridPDF& pdf)
+      : GridEvaluatorBase(pdf)
+    {
+      if (typeid(pdf.interpolator()) != typeid(IPOL) || typeid(pdf.extrapolator()) != typeid(XPOL))
+        throw UserError("GridEvaluator type does not match the interpolator and extrapolator of the PDF");
+      _ipol = static_cast<const IPOL*>(&pdf.interpolator());
+      _xpol = static_cast<const XPOL*>(&pdf.extrapolator());
+      _xmin = pdf.xKnots().front();
+      _xmax = pdf.xKnots().back();
+      _q2min = pdf.q2Knots().front();
+      _q2max = pdf.q2Knots().back();
+      _forcepos = pdf.forcePositive();
+      if (_forcepos < 0 || _forcepos > 2) throw LogicError("ForcePositive value not in expected range!");
+    }
+
+    /// Get xf(x,Q2) for PID @a id, as for PDF::xfxQ2
+    double xfxQ2(int id, double x, double q2) const {
+      return _xfxQ2(id, x, q2);
+    }
+
+    /// Get xf(x,Q2) for PID @a id at @a npoints points, with the result for point i in rtn[i]
+    void xfxQ2(int id, const double* xs, const double* q2s, size_t npoints, double* rtn) const {
+      for (size_t i = 0; i < npoints; ++i) rtn[i] = _xfxQ2(id, xs[i], q2s[i]);
+    }
+
+  private:
+
+    /// The evaluation, as in PDF::xfxQ2 and GridPDF::_xfxQ2
+    double _xfxQ2(int id, double x, double q2) const {
+      if (!_pdf->inPhysicalRangeX(x)) throw RangeError("Unphysical x given: " + to_str(x));
+      if (!_pdf->inPhysicalRangeQ2(q2)) throw RangeError("Unphysical Q2 given: " + to_str(q2));
+      // Treat PID = 0 as always equivalent to a gluon: query as PID = 21
+      const int id2 = (id != 0) ? id : 21;
+      // Undefined PIDs
+      if (!_pdf->hasFlavor(id2)) return 0.0;
+      double xfx;
+      if (x >= _xmin && x <= _xmax && q2 >= _q2min && q2 <= _q2max) {
+        const KnotArray1F& subgrid = _pdf->subgrid(id2, q2);
+        xfx = _ipol->IPOL::_interpolateXQ2(subgrid, x, subgrid.ixbelow(x), q2, subgrid.iq2below(q2));
+      } else {
+        xfx = _xpol->XPOL::extrapolateXQ2(id2, x, q2);
+      }
+      // Apply positivity forcing at the enabled level
+      if (_forcepos == 1 && xfx < 0) xfx = 0;
+      else if (_forcepos == 2 && xfx < 1e-10) xfx = 1e-10;
+      return xfx;
+    }
+
+    /// The PDF's interpolator and extrapolator
+    const IPOL* _ipol;
+    const XPOL* _xpol;
+
+    /// Grid range
+    double _xmin, _xmax, _q2min, _q2max;
+
+    /// Positivity forcing level
+    int _forcepos;
+
+  };
+
+
+  /// @name Instantiations compiled in the library
+  //@{
+  extern template class GridEvaluator<BilinearInterpolator, ErrExtrapolator>;
+  extern template class GridEvaluator<BilinearInterpolator, NearestPointExtrapolator>;
+  extern template class GridEvaluator<BilinearInterpolator, ContinuationExtrapolator>;
+  extern template class GridEvaluator<BicubicInterpolator, ErrExtrapolator>;
+  extern template class GridEvaluator<BicubicInterpolator, NearestPointExtrapolator>;
+  extern template class GridEvaluator<BicubicInterpolator, ContinuationExtrapolator>;
+  extern template class GridEvaluator<LogBilinearInterpolator, ErrExtrapolator>;
+  extern template class GridEvaluator<LogBilinearInterpolator, NearestPointExtrapolator>;
+  extern template class GridEvaluator<LogBilinearInterpolator, ContinuationExtrapolator>;
+  extern template class GridEvaluator<LogBicubicInterpolator, ErrExtrapolator>;
+  extern template class GridEvaluator<LogBicubicInterpolator, NearestPointExtrapolator>;
+  extern template class GridEvaluator<LogBicubicInterpolator, ContinuationExtrapolator>;
+  extern template class GridEvaluator<LogBicubicPatchInterpolator, ErrExtrapolator>;
+  extern template class GridEvaluator<LogBicubicPatchInterpolator, NearestPointExtrapolator>;
+  extern template class GridEvaluator<LogBicubicPatchInterpolator, ContinuationExtrapolator>;
+  //@}
+
+
+}
+#endif
@@ -11,6 +11,7 @@
 #include "LHAPDF/Interpolator.h"
 #include "LHAPDF/Extrapolator.h"
 #include "LHAPDF/KnotArray.h"
+#include "LHAPDF/PreparedPoint.h"
 
 namespace LHAPDF {
 
@@ -23,7 +24,7 @@ namespace LHAPDF {
     //@{
 
     /// Default constructor, making an empty PDF to be populated by hand.
-    GridPDF() {
+    GridPDF() : _q2knotsready(false) {
       _mempath = "";
       _info = PDFInfo();
       _forcePos = -1;
@@ -36,7 +37,7 @@ namespace LHAPDF {
     /// rather than acquiring it via a pointer/reference of PDF type, then you
     /// probably (hopefully) know what you're doing and aren't putting it into
     /// public production code!
-    GridPDF(const std::string& path) {
+    GridPDF(const std::string& path) : _q2knotsready(false) {
       _loadInfo(path); // Sets _mempath
       _loadPlugins();
       _loadData(_mempath);
@@ -44,7 +45,7 @@ namespace LHAPDF {
     }
 
     /// Constructor from a set name and member ID
-    GridPDF(const std::string& setname, int member) {
+    GridPDF(const std::string& setname, int member) : _q2knotsready(false) {
       _loadInfo(setname, member); // Sets _mempath
       _loadPlugins();
       _loadData(_mempath);
@@ -52,7 +53,7 @@ namespace LHAPDF {
     }
 
     /// Constructor from an LHAPDF ID
-    GridPDF(int lhaid) {
+    GridPDF(int lhaid) : _q2knotsready(false) {
       _loadInfo(lhaid); // Sets _mempath
       _loadPlugins();
       _loadData(_mempath);
@@ -80,9 +81,33 @@ namespace LHAPDF {
       _loadExtrapolator();
     }
 
-    /// Load the PDF grid data block (not the metadata) from the given PDF member file
+    /// @brief Load the PDF grid data block (not the metadata) from the given PDF member file
+    ///
+    /// An up-to-date binary .lhab companion of the file is used in preference,
+    /// if present, unless disabled via the BinaryGrids config key.
     void _loadData(const std::string& mempath);
 
+    /// Parse the PDF grid data block from the given text-format member file
+    void _loadAsciiData(const std::string& mempath);
+
+    /// @brief Map the PDF grid data block from the given binary .lhab file, made from the text file @a mempath
+    ///
+    /// The xf values are used in place from the memory-mapped file. Returns
+    /// false, loading nothing, if the file is not a valid binary grid file of
+    /// the supported format version and byte order, e.g. if it is truncated,
+    /// or if it records a different size or modification time of @a mempath
+    /// than the current ones, so that the text file can be read instead.
+    bool _loadBinaryData(const std::string& binpath, const std::string& mempath);
+
+    /// Let the interpolator prepare its extra data for each knot array
+    void _prepareInterpolator();
+
+    /// Let the extrapolator precompute its data from the grid and interpolator
+    void _prepareExtrapolator();
+
+    /// Get the size and modification time of a file, returning false if it does not exist
+    static bool _fileStamp(const std::string& path, uint64_t& size, int64_t& mtime);
+
 
   public:
 
@@ -153,19 +178,74 @@ namespace LHAPDF {
     //@}
 
 
+    /// @name Prepared points
+    //@{
+
+    /// @brief Precompute the grid location and interpolation weights of an (x,Q2) point
+    ///
+    /// The returned point can be evaluated with the xfxQ2 methods below on this
+    /// or any other GridPDF: see PreparedPoint for the conditions under which
+    /// the precomputation is used.
+    PreparedPoint prepare(double x, double q2) const;
+
+    // Keep the PDF xfxQ2 overloads visible
+    using PDF::xfxQ2;
+
+    /// @brief Get xf(x,Q2) for PID @a id at a prepared point
+    ///
+    /// As for xfxQ2(id, pt.x(), pt.q2()), including the range checks and
+    /// positivity forcing, but with only the weighted sum of the knot values
+    /// computed if the point's preparation applies to this PDF.
+    double xfxQ2(int id, const PreparedPoint& pt) const;
+
+    /// @brief Get xf(x,Q2) for the 13 partons at a prepared point
+    ///
+    /// As for xfxQ2(pt.x(), pt.q2(), rtn), with the PIDs -6 to 6 (gluon as 0)
+    /// in @a rtn, but sharing the precomputed weights between all the flavors.
+    void xfxQ2(const PreparedPoint& pt, std::vector<double>& rtn) const;
+
+    //@}
+
+
   protected:
 
     /// @brief Get PDF xf(x,Q2) value (via grid inter/extrapolators)
     double _xfxQ2(int id, double x, double q2) const;
 
+    /// @brief Get PDF xf(x,Q2) values at many points (via grid inter/extrapolators)
+    ///
+    /// Runs of in-range points are passed together to the interpolator.
+    void _xfxQ2Batch(int id, const double* xs, const double* q2s, size_t npoints, double* rtn, size_t stride) const;
+
+    /// Interpolate or extrapolate several PIDs at one point, sharing the interpolation weights between them
+    void _xfxQ2NF(const int* ids, size_t nids, double x, double q2, double* rtn) const;
+
+    /// The subgrid of this PDF to which a prepared point's precomputation applies, or null if none
+    const KnotArrayNF* _preparedSubgrid(const PreparedPoint& pt) const;
+
 
   public:
 
     /// @name Info about the grid, and access to the raw data points
     //@{
 
-    /// Directly access the knot arrays in non-const mode, for programmatic filling
+    /// @brief Directly access the knot arrays in non-const mode, for programmatic filling
+    ///
+    /// @note This drops the flat subgrid lookup tables, the cached Q2 knots,
+    /// the interpolator's cached queries and the extrapolator's edge tables,
+    /// since the subgrid structure may change: subsequent lookups use the map.
     std::map<double, KnotArrayNF>& knotarrays() {
+      _subgridedges.clear();
+      _subgrids.clear();
+      _q2knots.clear();
+      _q2knotsready = false;
+      if (_interpolator) _interpolator->resetQueryCache();
+      if (_extrapolator) _extrapolator->unprepare();
+      return _knotarrays;
+    }
+
+    /// Access the knot arrays in const mode
+    const std::map<double, KnotArrayNF>& knotarrays() const {
       return _knotarrays;
     }
 
@@ -177,11 +257,25 @@ namespace LHAPDF {
       return subgrid(q2).get_pid(id);
     }
 
+    /// @brief Write the grid data to a binary .lhab file at @a path
+    ///
+    /// The file is written atomically, via a temporary file which is then
+    /// renamed. All flavors in a subgrid must share the same knots. The size
+    /// and modification time of the text member file the grid was loaded from
+    /// are recorded, and the binary file is only used in its place while they
+    /// are unchanged.
+    void writeBinaryData(const std::string& path) const;
+
+    /// Path of the binary .lhab companion of a text-format member file
+    static std::string binaryDataPath(const std::string& mempath) {
+      return file_stem(mempath) + ".lhab";
+    }
+
     /// @brief Return a representative list of interpolation knots in x
     ///
     /// The x knot array for the first flavor grid of the lowest-Q2 subgrid is returned.
     const vector<double>& xKnots() const {
-      const KnotArrayNF& subgrid1 = _knotarrays.begin()->second;
+      const KnotArrayNF& subgrid1 = _subgrids.empty() ? _knotarrays.begin()->second : *_subgrids.front();
       const KnotArray1F& grid1 = subgrid1.get_first();
       return grid1.xs();
     }
@@ -217,12 +311,26 @@ namespace LHAPDF {
     /// Map of multi-flavour KnotArrays "binned" for lookup by low edge in Q2
     std::map<double, KnotArrayNF> _knotarrays;
 
+    /// @brief Build the flat subgrid lookup tables from the knot-array map
+    ///
+    /// Called once the grid data has been loaded.
+    void _syncSubgrids();
+
+    /// Sorted low Q2 edges of the subgrids, for contiguous lookup on the hot path
+    std::vector<double> _subgridedges;
+
+    /// Pointers to the subgrids in _knotarrays, parallel to _subgridedges
+    std::vector<const KnotArrayNF*> _subgrids;
+
     // /// Caching vector of x knot values
     // mutable std::vector<double> _xknots;
 
     /// Caching vector of Q2 knot values
     mutable std::vector<double> _q2knots;
 
+    /// Whether the Q2 knots have been cached
+    mutable std::atomic<bool> _q2knotsready;
+
     /// Typedef of smart pointer for ipol memory handling
     typedef unique_ptr<Interpolator> InterpolatorPtr;
 
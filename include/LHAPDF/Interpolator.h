@@ -9,6 +9,8 @@
 
 #include "LHAPDF/Utils.h"
 #include "LHAPDF/KnotArray.h"
+#include "LHAPDF/SIMDKernels.h"
+#include <cstdint>
 
 namespace LHAPDF {
 
@@ -17,10 +19,32 @@ namespace LHAPDF {
   class GridPDF;
 
 
+  /// @brief Hit and miss counts of the per-thread query cache of the interpolators
+  ///
+  /// See Interpolator::setQueryCache.
+  struct QueryCacheStats {
+    /// Number of single-point queries whose weights were found in the cache
+    unsigned long hits;
+    /// Number of single-point queries whose weights were computed
+    unsigned long misses;
+    /// Fraction of the queries found in the cache
+    double hitRate() const { return (hits + misses > 0) ? hits / double(hits + misses) : 0.0; }
+  };
+
+  /// The query cache counts of the calling thread, summed over all interpolators
+  QueryCacheStats queryCacheStats();
+
+  /// Reset the query cache counts of the calling thread to zero
+  void resetQueryCacheStats();
+
+
   /// The general interface for interpolating between grid points
   class Interpolator {
   public:
 
+    /// Default constructor, with the vectorised kernels and the query cache disabled
+    Interpolator() : _pdf(0), _simd(SIMD_NONE), _querycache(false) { resetQueryCache(); }
+
     /// Destructor to allow inheritance
     virtual ~Interpolator() { }
 
@@ -29,10 +53,10 @@ namespace LHAPDF {
     //@{
 
     /// Bind to a GridPDF
-    void bind(const GridPDF* pdf) { _pdf = pdf; }
+    void bind(const GridPDF* pdf) { _pdf = pdf; resetQueryCache(); }
 
     /// Unbind from GridPDF
-    void unbind() { _pdf = 0; }
+    void unbind() { _pdf = 0; resetQueryCache(); }
 
     /// Identify whether this Interpolator has an associated PDF
     bool hasPDF() { return _pdf != 0; }
@@ -40,9 +64,91 @@ namespace LHAPDF {
     /// Get the associated GridPDF
     const GridPDF& pdf() const { return *_pdf; }
 
+    /// @brief Prepare any extra per-array data used by this interpolator
+    ///
+    /// Called by the bound GridPDF on each of its knot arrays once the grid
+    /// data is available, e.g. to precompute derivative tables. Does nothing
+    /// by default.
+    virtual void prepare(KnotArray1F& subgrid) const { }
+
     //@}
 
 
+    /// @name Vectorised kernels
+    //@{
+
+    /// @brief Set the instruction set level of the vectorised kernels
+    ///
+    /// If not SIMD_NONE, the all-flavor and batched interpolation methods
+    /// evaluate the interpolation stencils with the SIMD kernels of this level,
+    /// capped at the level supported by the host CPU, for interpolators which
+    /// provide stencils. See SIMDKernels.h for the precision of the results.
+    void setSIMDLevel(SIMDLevel level) { _simd = min(level, simdLevelSupported()); }
+
+    /// The instruction set level of the vectorised kernels
+    SIMDLevel simdLevel() const { return _simd; }
+
+    /// @brief Are the vectorised kernels faster than the scalar evaluation for this interpolator?
+    ///
+    /// If not, the "auto" setting of the SIMD config key leaves them disabled.
+    virtual bool simdFaster() const { return true; }
+
+    //@}
+
+
+    /// @name Query cache
+    //@{
+
+    /// @brief Enable or disable the per-thread cache of recent single-point queries
+    ///
+    /// Each thread keeps a ring of its last few (x,Q2) queries, keyed on the
+    /// exact bit patterns of x and Q2, with the subgrid, knot indices, logs and
+    /// interpolation weights of each. A query repeating a recent point, e.g.
+    /// one flavor after another at the same (x,Q2), then skips straight to
+    /// the interpolation, with results identical to the uncached ones.
+    void setQueryCache(bool enable) { _querycache = enable; }
+
+    /// Is the query cache enabled?
+    bool queryCache() const { return _querycache; }
+
+    /// @brief Forget the cached queries of this interpolator, in all threads
+    ///
+    /// Must be called if the bound grid is modified.
+    void resetQueryCache();
+
+    //@}
+
+
+    /// @brief Position and interpolation weights of an (x,Q2) point in a subgrid, as stored by the query cache
+    ///
+    /// The weights are kept in each interpolator's own trivially copyable
+    /// type, in place in a fixed buffer.
+    struct CellWeights {
+      /// The point
+      double x, q2;
+      /// log(x) and log(Q2), if used by the interpolator
+      double logx, logq2;
+      /// Indices of the knots below the point
+      size_t ix, iq2;
+      /// The knots for which the weights were computed
+      const KnotAxes* axes;
+      /// Access the interpolator-specific weights of type T
+      template <typename T>
+      T* data() {
+        static_assert(sizeof(T) <= sizeof(_buf) && alignof(T) <= alignof(double), "Cell weights too large for the buffer");
+        return reinterpret_cast<T*>(_buf);
+      }
+      /// Access the interpolator-specific weights of type T in const mode
+      template <typename T>
+      const T* data() const {
+        static_assert(sizeof(T) <= sizeof(_buf) && alignof(T) <= alignof(double), "Cell weights too large for the buffer");
+        return reinterpret_cast<const T*>(_buf);
+      }
+      /// Storage of the weights
+      double _buf[18];
+    };
+
+
     /// @name Interpolation methods
     //@{
 
@@ -54,8 +160,28 @@ namespace LHAPDF {
     /// Interpolate a single-point in (x,Q2)
     double interpolateXQ2(int id, double x, double q2) const;
 
+    /// @brief Interpolate @a npoints points in (x,Q2), given as arrays, for a single PID
+    ///
+    /// All the points must be within the grid range. The result for point i is
+    /// written to rtn[i*stride]. Runs of consecutive points in the same subgrid
+    /// are passed together to the _interpolateXQ2Batch kernel.
+    void interpolateXQ2(int id, const double* xs, const double* q2s, size_t npoints,
+                        double* rtn, size_t stride=1) const;
+
+    /// @brief Interpolate a single point in (x,Q2) for @a nids PIDs at once
+    ///
+    /// The subgrid lookup, knot index searches and interpolation weights are
+    /// computed once and applied to all the flavors which share the same knots,
+    /// with the result for PID ids[j] written to rtn[j]. All the PIDs must be
+    /// defined in the grid.
+    void interpolateXQ2(const int* ids, size_t nids, double x, double q2, double* rtn) const;
 
-    /// @todo Make an all-PID version of interpolateQ and Q2?
+    /// @brief Get the separable interpolation stencils of an in-range (x,Q2) point on a subgrid
+    ///
+    /// Returns false if this interpolator does not provide stencils.
+    bool stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const {
+      return _stencils(subgrid, x, q2, sx, sq);
+    }
 
 
   protected:
@@ -68,16 +194,66 @@ namespace LHAPDF {
     /// flavour of interpolator.
     virtual double _interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const = 0;
 
-    /// @todo Implement this NF version, with a cached KnotArrayNF?
-    // virtual double _interpolateXQ2(const KnotArrayNF& subgrid, int id, double x, size_t ix, double q2, size_t iq2) const;
+    /// @brief Interpolate a block of points in (x,Q2), all in the same subgrid, given their x/Q2 values and indices
+    ///
+    /// The result for point i is written to rtn[i*stride]. The default
+    /// implementation calls the single-point _interpolateXQ2 for each point:
+    /// override to work on many points at once.
+    virtual void _interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                                      const double* xs, const size_t* ixs,
+                                      const double* q2s, const size_t* iq2s,
+                                      double* rtn, size_t stride) const;
+
+    /// @brief Interpolate a single point in (x,Q2) on several flavor arrays with the same knots
+    ///
+    /// The result for subgrids[j] is written to rtn[j]. The default
+    /// implementation calls the single-point _interpolateXQ2 for each flavor:
+    /// override to share the interpolation weights between them.
+    virtual void _interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                   double x, size_t ix, double q2, size_t iq2, double* rtn) const;
+
+    /// @brief Get the separable interpolation stencils of an (x,Q2) point
+    ///
+    /// Used by the vectorised kernels, and including the knot index look-ups,
+    /// so that they can share e.g. log(x) with the stencil construction.
+    /// Returns false, as by default, if this interpolator does not provide stencils.
+    virtual bool _stencils(const KnotArray1F& subgrid, double x, double q2,
+                           KnotStencil& sx, KnotStencil& sq) const { return false; }
+
+    /// @brief Compute the knot indices, and any logs and weights, of the point w.x, w.q2 for the query cache
+    ///
+    /// The default only looks up the indices: override together with
+    /// _interpolateWeighted to also cache the interpolation weights.
+    virtual void _cellWeights(const KnotArray1F& subgrid, CellWeights& w) const;
+
+    /// @brief Interpolate a single point from its cached weights, on a subgrid with the knots they were computed for
+    ///
+    /// Must give exactly the same result as _interpolateXQ2. The default calls
+    /// _interpolateXQ2 with the cached indices.
+    virtual double _interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const;
 
     //@}
 
 
   private:
 
+    /// @brief Get the cached weights of a point, computing them on a miss
+    ///
+    /// Also sets @a subgridnf to the point's subgrid. The reference is valid
+    /// until the next query from the calling thread.
+    const CellWeights& _cachedWeights(double x, double q2, const KnotArrayNF*& subgridnf) const;
+
     const GridPDF* _pdf;
 
+    /// SIMD level of the vectorised kernels
+    SIMDLevel _simd;
+
+    /// Use the per-thread query cache?
+    bool _querycache;
+
+    /// Identifier of this interpolator and its bound grid in the query cache, never reused
+    uint64_t _queryid;
+
   };
 
 
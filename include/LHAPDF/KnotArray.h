@@ -7,11 +7,141 @@
 #ifndef LHAPDF_KnotArray_H
 #define LHAPDF_KnotArray_H
 
+#include "LHAPDF/Utils.h"
 #include "LHAPDF/Exceptions.h"
+#include <cstdint>
 
 namespace LHAPDF {
 
 
+  /// @brief Bucket table for constant-time lookup of the knot interval containing a value
+  ///
+  /// The range of log(knot) values is divided into uniform buckets, each
+  /// recording the last knot at or below its lower edge, so a lookup is a
+  /// bucket index computation followed by a short linear correction. The
+  /// buckets are made no wider than the smallest log-knot spacing where
+  /// possible, in which case at most one correction step is needed. For
+  /// exactly log-uniform knots no table is needed at all. Short knot lists,
+  /// for which a binary search is cheaper than the log, are left empty.
+  class KnotLookup {
+  public:
+
+    /// Default constructor, for an empty lookup which always uses binary search
+    KnotLookup() : _tmin(0), _invdt(0), _uniform(false) { }
+
+    /// Constructor from a strictly increasing list of positive knots, and their logs
+    KnotLookup(const std::vector<double>& knots, const std::vector<double>& logknots);
+
+    /// @brief Get the index of the closest knot <= v, as for a binary search
+    ///
+    /// If the value is >= the last knot, return the last index-1 (for
+    /// polynomial spline construction). The value must be in the knot range.
+    size_t ibelow(const std::vector<double>& knots, double v) const {
+      return ibelow(knots, v, (_uniform || !_buckets.empty()) ? log(v) : 0);
+    }
+
+    /// As ibelow(knots, v), with log(v) precomputed
+    size_t ibelow(const std::vector<double>& knots, double v, double logv) const {
+      const size_t imax = knots.size() - 2;
+      size_t i;
+      if (_uniform) {
+        const double b = (logv - _tmin) * _invdt;
+        i = (b > 0) ? std::min(size_t(b), imax) : 0;
+      } else if (!_buckets.empty()) {
+        const double b = (logv - _tmin) * _invdt;
+        i = _buckets[(b > 0) ? std::min(size_t(b), _buckets.size()-1) : 0];
+      } else {
+        i = upper_bound(knots.begin(), knots.end(), v) - knots.begin();
+        if (i == knots.size()) i -= 1; // can't return the last knot index
+        return i - 1; // have to step back to get the knot <= v behaviour
+      }
+      // Correct for bucket granularity and rounding, comparing against the exact knot values
+      while (i < imax && knots[i+1] <= v) ++i;
+      while (i > 0 && knots[i] > v) --i;
+      return i;
+    }
+
+  private:
+
+    /// Lowest log(knot) value
+    double _tmin;
+    /// Inverse of the bucket width (or knot spacing, if uniform) in log(knot)
+    double _invdt;
+    /// Are the knots exactly uniform in log(knot)?
+    bool _uniform;
+    /// Index of the last knot at or below each bucket's lower edge
+    std::vector<uint32_t> _buckets;
+
+  };
+
+
+  /// @brief Immutable x and Q2 knot positions of a grid block, with their logs
+  ///
+  /// Knot axes are shared by reference-counted pointer between all the flavours
+  /// of a subgrid, and interned across the members of a PDFSet, so e.g. a
+  /// replica set stores each distinct knot layout only once.
+  class KnotAxes {
+  public:
+
+    /// Constructor from x and Q2 knot values
+    KnotAxes(const std::vector<double>& xknots=std::vector<double>(), const std::vector<double>& q2knots=std::vector<double>())
+      : _xs(xknots), _q2s(q2knots)
+    {
+      _logxs.resize(_xs.size());
+      _logq2s.resize(_q2s.size());
+      for (size_t i = 0; i < _xs.size(); ++i) _logxs[i] = log(_xs[i]);
+      for (size_t i = 0; i < _q2s.size(); ++i) _logq2s[i] = log(_q2s[i]);
+      _xlookup = KnotLookup(_xs, _logxs);
+      _q2lookup = KnotLookup(_q2s, _logq2s);
+    }
+
+    /// x knot accessor
+    const std::vector<double>& xs() const { return _xs; }
+    /// log(x) knot accessor
+    const std::vector<double>& logxs() const { return _logxs; }
+    /// Q2 knot accessor
+    const std::vector<double>& q2s() const { return _q2s; }
+    /// log(Q2) knot accessor
+    const std::vector<double>& logq2s() const { return _logq2s; }
+
+    /// Bucket lookup table for the x knots
+    const KnotLookup& xlookup() const { return _xlookup; }
+    /// Bucket lookup table for the Q2 knots
+    const KnotLookup& q2lookup() const { return _q2lookup; }
+
+    /// Are these axes made of exactly the given knots?
+    bool matches(const std::vector<double>& xknots, const std::vector<double>& q2knots) const {
+      return _xs == xknots && _q2s == q2knots;
+    }
+
+    /// Are these axes the same as, or made of the same knots as, @a other?
+    bool matches(const KnotAxes& other) const {
+      return this == &other || (_xs == other._xs && _q2s == other._q2s);
+    }
+
+    /// Approximate heap memory used by the knot and log-knot vectors, in bytes
+    size_t memsize() const {
+      return sizeof(double) * 2*(_xs.capacity() + _q2s.capacity());
+    }
+
+  private:
+
+    /// List of x knots
+    std::vector<double> _xs;
+    /// List of Q2 knots
+    std::vector<double> _q2s;
+    /// List of log(x) knots
+    std::vector<double> _logxs;
+    /// List of log(Q2) knots
+    std::vector<double> _logq2s;
+    /// Bucket lookup for the x knots
+    KnotLookup _xlookup;
+    /// Bucket lookup for the Q2 knots
+    KnotLookup _q2lookup;
+
+  };
+
+
   /// @brief Internal storage class for PDF data point grids
   ///
   /// We use "array" to refer to the "raw" knot grid, while "grid" means a grid-based PDF.
@@ -23,47 +153,74 @@ namespace LHAPDF {
     //@{
 
     /// Default constructor just for std::map insertability
-    KnotArray1F() {}
+    KnotArray1F() : _axes(std::make_shared<KnotAxes>()), _xfstride(1) {}
 
     /// Constructor from x and Q2 knot values, and an xf value grid as strided list
     KnotArray1F(const std::vector<double>& xknots, const std::vector<double>& q2knots, const std::vector<double>& xfs)
-      : _xs(xknots), _q2s(q2knots), _xfs(xfs)
+      : _axes(std::make_shared<KnotAxes>(xknots, q2knots))
     {
-      assert(_xfs.size() == size());
-      _synclogs();
+      setxfs(xfs);
+      assert(_xfvec->size() == size());
     }
 
     /// Constructor of a zero-valued array from x and Q2 knot values
     KnotArray1F(const std::vector<double>& xknots, const std::vector<double>& q2knots)
-      : _xs(xknots), _q2s(q2knots),
-        _xfs(size(), 0.0)
+      : _axes(std::make_shared<KnotAxes>(xknots, q2knots))
     {
-      assert(_xfs.size() == size());
-      _synclogs();
+      setxfs(std::vector<double>(size(), 0.0));
+    }
+
+    /// Constructor from shared knot axes, and an xf value grid as strided list
+    KnotArray1F(const std::shared_ptr<const KnotAxes>& axes, const std::vector<double>& xfs)
+      : _axes(axes)
+    {
+      setxfs(xfs);
+      assert(_xfvec->size() == size());
+    }
+
+    /// Constructor from shared knot axes, taking ownership of an xf value grid
+    KnotArray1F(const std::shared_ptr<const KnotAxes>& axes, std::vector<double>&& xfs)
+      : _axes(axes)
+    {
+      setxfs(std::move(xfs));
+      assert(_xfvec->size() == size());
     }
 
+    /// @brief Constructor of a view onto an externally owned xf value grid
+    ///
+    /// The @a xfdata pointer addresses the value at (ix, iQ2) = (0, 0), and
+    /// successive knots in the [ix][iQ2] ordering are @a stride doubles apart,
+    /// e.g. for a flavour-interleaved multi-flavour block. The data block is
+    /// kept alive by shared ownership, so views can be copied freely.
+    KnotArray1F(const std::shared_ptr<const KnotAxes>& axes,
+                const std::shared_ptr<const double>& xfdata, size_t stride)
+      : _axes(axes), _xfdata(xfdata), _xfstride(stride)
+    {    }
+
     //@}
 
 
     /// @name x stuff
     //@{
 
+    /// Shared knot axes accessor
+    const std::shared_ptr<const KnotAxes>& axes() const { return _axes; }
+
     /// x knot setter
     /// @note Also zeros the xfs array, which is invalidated by resetting the x knots
     void setxs(const std::vector<double>& xs) {
-      _xs = xs;
-      _synclogs();
-      _xfs = std::vector<double>(size(), 0.0);
+      _axes = std::make_shared<KnotAxes>(xs, q2s());
+      setxfs(std::vector<double>(size(), 0.0));
     }
 
     /// Number of x knots
-    const size_t xsize() const { return _xs.size(); }
+    const size_t xsize() const { return _axes->xs().size(); }
 
     /// x knot accessor
-    const std::vector<double>& xs() const { return _xs; }
+    const std::vector<double>& xs() const { return _axes->xs(); }
 
     /// log(x) knot accessor
-    const std::vector<double>& logxs() const { return _logxs; }
+    const std::vector<double>& logxs() const { return _axes->logxs(); }
 
     /// @brief Get the index of the closest x knot row <= x
     ///
@@ -73,10 +230,14 @@ namespace LHAPDF {
       if (x < xs().front()) throw GridError("x value " + to_str(x) + " is lower than lowest-x grid point at " + to_str(xs().front()));
       if (x > xs().back()) throw GridError("x value " + to_str(x) + " is higher than highest-x grid point at " + to_str(xs().back()));
       // Find the closest knot below the requested value
-      size_t i = upper_bound(xs().begin(), xs().end(), x) - xs().begin();
-      if (i == xs().size()) i -= 1; // can't return the last knot index
-      i -= 1; // have to step back to get the knot <= x behaviour
-      return i;
+      return _axes->xlookup().ibelow(xs(), x);
+    }
+
+    /// As ixbelow(x), with log(x) precomputed
+    size_t ixbelow(double x, double logx) const {
+      if (x < xs().front()) throw GridError("x value " + to_str(x) + " is lower than lowest-x grid point at " + to_str(xs().front()));
+      if (x > xs().back()) throw GridError("x value " + to_str(x) + " is higher than highest-x grid point at " + to_str(xs().back()));
+      return _axes->xlookup().ibelow(xs(), x, logx);
     }
 
     //@}
@@ -88,19 +249,18 @@ namespace LHAPDF {
     /// Q2 knot setter
     /// @note Also zeros the xfs array, which is invalidated by resetting the Q2 knots
     void setq2s(const std::vector<double>& q2s) {
-      _q2s = q2s;
-      _synclogs();
-      _xfs = std::vector<double>(size(), 0.0);
+      _axes = std::make_shared<KnotAxes>(xs(), q2s);
+      setxfs(std::vector<double>(size(), 0.0));
     }
 
     /// Number of Q2 knots
-    const size_t q2size() const { return _q2s.size(); }
+    const size_t q2size() const { return _axes->q2s().size(); }
 
     /// Q2 knot accessor
-    const std::vector<double>& q2s() const { return _q2s; }
+    const std::vector<double>& q2s() const { return _axes->q2s(); }
 
     /// log(Q2) knot accessor
-    const std::vector<double>& logq2s() const { return _logq2s; }
+    const std::vector<double>& logq2s() const { return _axes->logq2s(); }
 
     /// Get the index of the closest Q2 knot row <= q2
     ///
@@ -110,10 +270,14 @@ namespace LHAPDF {
       if (q2 < q2s().front()) throw GridError("Q2 value " + to_str(q2) + " is lower than lowest-Q2 grid point at " + to_str(q2s().front()));
       if (q2 > q2s().back()) throw GridError("Q2 value " + to_str(q2) + " is higher than highest-Q2 grid point at " + to_str(q2s().back()));
       /// Find the closest knot below the requested value
-      size_t i = upper_bound(q2s().begin(), q2s().end(), q2) - q2s().begin();
-      if (i == q2s().size()) i -= 1; // can't return the last knot index
-      i -= 1; // have to step back to get the knot <= q2 behaviour
-      return i;
+      return _axes->q2lookup().ibelow(q2s(), q2);
+    }
+
+    /// As iq2below(q2), with log(Q2) precomputed
+    size_t iq2below(double q2, double logq2) const {
+      if (q2 < q2s().front()) throw GridError("Q2 value " + to_str(q2) + " is lower than lowest-Q2 grid point at " + to_str(q2s().front()));
+      if (q2 > q2s().back()) throw GridError("Q2 value " + to_str(q2) + " is higher than highest-Q2 grid point at " + to_str(q2s().back()));
+      return _axes->q2lookup().ibelow(q2s(), q2, logq2);
     }
 
     //@}
@@ -125,39 +289,154 @@ namespace LHAPDF {
     /// Number of x knots
     const size_t size() const { return xsize()*q2size(); }
 
-    /// xf value accessor (const)
-    const std::vector<double>& xfs() const { return _xfs; }
-    /// xf value accessor (non-const)
-    std::vector<double>& xfs() { return _xfs; }
+    /// @brief xf value accessor (const)
+    ///
+    /// Only available if this array owns its xf values, rather than being a
+    /// view on a shared multi-flavour block: use xf(ix, iq2) for generic access.
+    const std::vector<double>& xfs() const {
+      if (!ownsxfs()) throw GridError("xf values are stored in a shared multi-flavour block: use xf(ix, iq2) to access them");
+      return *_xfvec;
+    }
+
+    /// @brief xf value accessor (non-const)
+    ///
+    /// If the values are shared with other arrays, e.g. as a view on a
+    /// flavour-interleaved block, they are first copied into a private vector.
+    ///
+    /// @note Resizing the returned vector is not supported: use setxfs() instead.
+    /// Any precomputed derivative and patch tables are discarded, since the values may change.
+    std::vector<double>& xfs() {
+      _grads.reset();
+      _patches.reset();
+      if (!ownsxfs()) {
+        std::vector<double> tmp(size());
+        for (size_t ix = 0; ix < xsize(); ++ix)
+          for (size_t iq2 = 0; iq2 < q2size(); ++iq2)
+            tmp[ix*q2size() + iq2] = xf(ix, iq2);
+        setxfs(tmp);
+      } else if (_xfvec.use_count() > 1) {
+        setxfs(std::vector<double>(*_xfvec));
+      }
+      return *_xfvec;
+    }
+
     /// xf value setter
-    void setxfs(const std::vector<double>& xfs) { _xfs = xfs; }
+    void setxfs(const std::vector<double>& xfs) {
+      _grads.reset();
+      _patches.reset();
+      _xfvec = std::make_shared< std::vector<double> >(xfs);
+      _xfdata = std::shared_ptr<const double>(_xfvec, _xfvec->data());
+      _xfstride = 1;
+    }
+
+    /// xf value setter, taking ownership of the values without a copy
+    void setxfs(std::vector<double>&& xfs) {
+      _grads.reset();
+      _patches.reset();
+      _xfvec = std::make_shared< std::vector<double> >(std::move(xfs));
+      _xfdata = std::shared_ptr<const double>(_xfvec, _xfvec->data());
+      _xfstride = 1;
+    }
+
+    /// Does this array own a private, contiguous vector of xf values?
+    bool ownsxfs() const { return bool(_xfvec); }
+
+    /// Separation of consecutive knots in the xf data block, in units of doubles
+    size_t xfstride() const { return _xfstride; }
 
     /// Get the xf value at a particular indexed x,Q2 knot
-    const double& xf(size_t ix, size_t iq2) const { return _xfs[ix*q2size() + iq2]; }
+    const double& xf(size_t ix, size_t iq2) const { return _xfdata.get()[(ix*q2size() + iq2)*_xfstride]; }
 
     //@}
 
 
-  private:
+    /// @name Precomputed derivatives at the knots
+    ///
+    /// Optional tables of d(xf)/dx, d(xf)/dQ2 and d2(xf)/dxdQ2 at every knot,
+    /// or of the equivalent derivatives w.r.t. log(x) and log(Q2), for use by
+    /// the cubic interpolators. As in the on-the-fly cubic interpolation, the
+    /// derivatives are the average of the adjacent finite differences, with
+    /// one-sided differences at the subgrid edges.
+    //@{
 
-    /// Synchronise log(x) and log(Q2) arrays from the x and Q2 ones
-    void _synclogs() {
-      _logxs.resize(_xs.size());
-      _logq2s.resize(_q2s.size());
-      for (size_t i = 0; i < _xs.size(); ++i) _logxs[i] = log(_xs[i]);
-      for (size_t i = 0; i < _q2s.size(); ++i) _logq2s[i] = log(_q2s[i]);
+    /// Compute the derivative tables, in log(x), log(Q2) space if @a logspace is true
+    void computeGradients(bool logspace);
+
+    /// Have the derivative tables been computed, in the given space?
+    bool hasGradients(bool logspace) const {
+      return bool(_grads) && _gradslog == logspace;
     }
 
-    /// List of x knots
-    std::vector<double> _xs;
-    /// List of Q2 knots
-    std::vector<double> _q2s;
-    /// List of log(x) knots
-    std::vector<double> _logxs;
-    /// List of log(Q2) knots
-    std::vector<double> _logq2s;
-    /// List of xf values across the 2D knot array, stored as a strided [ix][iQ2] 1D array
-    std::vector<double> _xfs;
+    /// Discard any derivative tables
+    void clearGradients() { _grads.reset(); }
+
+    /// Heap memory used by the derivative tables, in bytes
+    size_t gradientsMemSize() const {
+      return _grads ? 3*size()*sizeof(double) : 0;
+    }
+
+    /// Precomputed d(xf)/dx, or d(xf)/dlog(x), at a particular indexed x,Q2 knot
+    double dxf_dx(size_t ix, size_t iq2) const { return _grads.get()[3*(ix*q2size() + iq2)]; }
+
+    /// Precomputed d(xf)/dQ2, or d(xf)/dlog(Q2), at a particular indexed x,Q2 knot
+    double dxf_dq2(size_t ix, size_t iq2) const { return _grads.get()[3*(ix*q2size() + iq2) + 1]; }
+
+    /// Precomputed d2(xf)/dxdQ2, or d2(xf)/dlog(x)dlog(Q2), at a particular indexed x,Q2 knot
+    double d2xf_dxdq2(size_t ix, size_t iq2) const { return _grads.get()[3*(ix*q2size() + iq2) + 2]; }
+
+    //@}
+
+
+    /// @name Precomputed interpolation patches
+    ///
+    /// Optional per-cell polynomial coefficients, e.g. the 16 bicubic
+    /// coefficients of each (ix, iQ2) -> (ix+1, iQ2+1) cell, as computed and
+    /// used by a specific interpolator.
+    //@{
+
+    /// Set the patch coefficient table, with @a ncoeffs coefficients per (ix, iQ2) cell
+    void setPatches(const std::shared_ptr<const double>& patches, size_t ncoeffs) {
+      _patches = patches;
+      _npatchcoeffs = ncoeffs;
+    }
+
+    /// Have patch coefficients been set, with @a ncoeffs coefficients per cell?
+    bool hasPatches(size_t ncoeffs) const {
+      return bool(_patches) && _npatchcoeffs == ncoeffs;
+    }
+
+    /// Discard any patch coefficients
+    void clearPatches() { _patches.reset(); }
+
+    /// Heap memory used by the patch coefficients, in bytes
+    size_t patchesMemSize() const {
+      return _patches ? _npatchcoeffs*size()*sizeof(double) : 0;
+    }
+
+    /// Get the coefficients of the cell with lower corner at (ix, iq2)
+    const double* patch(size_t ix, size_t iq2) const { return _patches.get() + _npatchcoeffs*(ix*q2size() + iq2); }
+
+    //@}
+
+
+  private:
+
+    /// Shared x, Q2, log(x) and log(Q2) knot lists
+    std::shared_ptr<const KnotAxes> _axes;
+    /// List of xf values across the 2D knot array, stored as a strided [ix][iQ2] 1D array (null for views)
+    std::shared_ptr< std::vector<double> > _xfvec;
+    /// Pointer to the first xf value, sharing ownership with its storage block
+    std::shared_ptr<const double> _xfdata;
+    /// Separation of consecutive knots in the xf data block
+    size_t _xfstride;
+    /// Derivative tables, stored as [ix][iQ2][d/dx, d/dQ2, d2/dxdQ2] (null if not computed)
+    std::shared_ptr<const double> _grads;
+    /// Are the derivatives w.r.t. log(x) and log(Q2)?
+    bool _gradslog = false;
+    /// Per-cell patch coefficients, stored as [ix][iQ2][icoeff] (null if not set)
+    std::shared_ptr<const double> _patches;
+    /// Number of coefficients per patch
+    size_t _npatchcoeffs = 0;
 
   };
 
@@ -169,35 +448,82 @@ namespace LHAPDF {
   public:
 
     /// How many {KnotArray1F}s are stored in this container?
-    size_t size() const { return _map.size(); }
+    size_t size() const { return _arrays.size(); }
 
     /// Is this container empty?
-    bool empty() const { return _map.empty(); }
+    bool empty() const { return _arrays.empty(); }
 
     /// Does this contain a KnotArray1F for PID code @a id?
     bool has_pid(int id) const {
-      return _map.find(id) != _map.end();
+      return _slot(id) >= 0;
     }
 
     /// Get the KnotArray1F for PID code @a id
     const KnotArray1F& get_pid(int id) const {
-      if (!has_pid(id)) throw FlavorError("Undefined particle ID requested: " + to_str(id));
-      return _map.find(id)->second;
+      const int islot = _slot(id);
+      if (islot < 0) throw FlavorError("Undefined particle ID requested: " + to_str(id));
+      return _arrays[islot];
     }
 
     /// Convenience accessor for any valid subgrid, to get access to the x/Q2/etc. arrays
     const KnotArray1F& get_first() const {
       if (empty()) throw GridError("Tried to access grid indices when no flavour grids were loaded");
-      return _map.begin()->second;
+      return _arrays.front();
     }
 
     /// Get the KnotArray1F for PID code @a id
     void set_pid(int id, const KnotArray1F& ka) {
-      _map[id] = ka;
+      (*this)[id] = ka;
     }
 
-    /// Indexing operator (non-const)
-    KnotArray1F& operator[](int id) { return _map[id]; }
+    /// The contained PID codes, in increasing order
+    const std::vector<int>& pids() const { return _pids; }
+
+    /// @brief Repack the xf values of all flavours into one flavour-interleaved block
+    ///
+    /// The block is ordered as [ix][iQ2][flavour], with flavours in increasing
+    /// PID order, so the interpolation anchor points of every flavour around an
+    /// (x,Q2) point lie next to each other in memory. The contained {KnotArray1F}s
+    /// become strided views on the shared block. All flavours must share the same
+    /// x and Q2 knots.
+    void interleave() {
+      if (empty()) return;
+      const KnotArray1F& first = get_first();
+      const size_t nflav = size(), npts = first.size();
+      std::shared_ptr< std::vector<double> > block = std::make_shared< std::vector<double> >(npts*nflav);
+      for (size_t iflav = 0; iflav < nflav; ++iflav) {
+        const KnotArray1F& ka = _arrays[iflav];
+        if (ka.axes() != first.axes() && !ka.axes()->matches(first.xs(), first.q2s()))
+          throw GridError("Flavor-interleaved storage requires all flavors in a subgrid to share the same knots");
+        for (size_t ix = 0; ix < ka.xsize(); ++ix)
+          for (size_t iq2 = 0; iq2 < ka.q2size(); ++iq2)
+            (*block)[(ix*ka.q2size() + iq2)*nflav + iflav] = ka.xf(ix, iq2);
+      }
+      for (size_t iflav = 0; iflav < nflav; ++iflav) {
+        const std::shared_ptr<const double> xfdata(block, block->data() + iflav);
+        _arrays[iflav] = KnotArray1F(first.axes(), xfdata, nflav);
+      }
+    }
+
+    /// Are the contained flavours stored as views on a single flavour-interleaved block?
+    bool interleaved() const {
+      return !empty() && size() > 1 && get_first().xfstride() == size();
+    }
+
+    /// @brief Indexing operator (non-const)
+    ///
+    /// As for std::map, a default-constructed KnotArray1F is inserted if @a id
+    /// is not yet present. Inserting a new PID invalidates previously returned
+    /// references.
+    KnotArray1F& operator[](int id) {
+      const int islot = _slot(id);
+      if (islot >= 0) return _arrays[islot];
+      const size_t inew = std::lower_bound(_pids.begin(), _pids.end(), id) - _pids.begin();
+      _pids.insert(_pids.begin() + inew, id);
+      _arrays.insert(_arrays.begin() + inew, KnotArray1F());
+      _syncslots();
+      return _arrays[inew];
+    }
 
     /// Access the xs array
     const std::vector<double>& xs() const { return get_first().xs(); }
@@ -215,8 +541,45 @@ namespace LHAPDF {
 
   private:
 
-    /// Storage
-    std::map<int, KnotArray1F> _map;
+    /// Number of entries in the dense PID lookup table: quarks -6..6, gluon (21) and photon (22)
+    static const int NDENSE = 15;
+
+    /// Position of a standard parton ID in the dense lookup table, or -1 for other PIDs
+    static int _denseindex(int id) {
+      if (id >= -6 && id <= 6) return id + 6;
+      if (id == 21) return 13;
+      if (id == 22) return 14;
+      return -1;
+    }
+
+    /// @brief Storage slot of PID code @a id, or -1 if not present
+    ///
+    /// Standard partons are resolved by a single table load; any other PIDs by
+    /// a binary search of the (short, contiguous) sorted PID list.
+    int _slot(int id) const {
+      const int idense = _denseindex(id);
+      if (idense >= 0) return _dense[idense];
+      const std::vector<int>::const_iterator it = std::lower_bound(_pids.begin(), _pids.end(), id);
+      return (it != _pids.end() && *it == id) ? int(it - _pids.begin()) : -1;
+    }
+
+    /// Rebuild the dense lookup table after an insertion
+    void _syncslots() {
+      std::fill(_dense, _dense + NDENSE, -1);
+      for (size_t i = 0; i < _pids.size(); ++i) {
+        const int idense = _denseindex(_pids[i]);
+        if (idense >= 0) _dense[idense] = int(i);
+      }
+    }
+
+    /// Sorted PID codes, parallel to _arrays
+    std::vector<int> _pids;
+
+    /// Storage, in increasing PID order
+    std::vector<KnotArray1F> _arrays;
+
+    /// Dense PID -> storage slot table for the standard partons (-1 = absent)
+    int _dense[NDENSE] = {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
 
   };
 
@@ -259,10 +622,7 @@ namespace LHAPDF {
       if (q2 < q2s().front()) throw AlphaSError("Q2 value " + to_str(q2) + " is lower than lowest-Q2 grid point at " + to_str(q2s().front()));
       if (q2 > q2s().back()) throw AlphaSError("Q2 value " + to_str(q2) + " is higher than highest-Q2 grid point at " + to_str(q2s().back()));
       /// Find the closest knot below the requested value
-      size_t i = upper_bound(q2s().begin(), q2s().end(), q2) - q2s().begin();
-      if (i == q2s().size()) i -= 1; // can't return the last knot index
-      i -= 1; // have to step back to get the knot <= q2 behaviour
-      return i;
+      return _q2lookup.ibelow(q2s(), q2);
     }
 
     /// Get the index of the closest logQ2 knot row <= logq2
@@ -322,12 +682,15 @@ namespace LHAPDF {
     void _synclogs() {
       _logq2s.resize(_q2s.size());
       for (size_t i = 0; i < _q2s.size(); ++i) _logq2s[i] = log(_q2s[i]);
+      _q2lookup = KnotLookup(_q2s, _logq2s);
     }
 
     /// List of Q2 knots
     std::vector<double> _q2s;
     /// List of log(Q2) knots
     std::vector<double> _logq2s;
+    /// Bucket lookup for the Q2 knots
+    KnotLookup _q2lookup;
     /// List of alpha_s values across the knot array
     std::vector<double> _as;
 
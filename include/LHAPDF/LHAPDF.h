@@ -13,6 +13,9 @@
 #include "LHAPDF/Version.h"
 #include "LHAPDF/PDF.h"
 #include "LHAPDF/PDFSet.h"
+#include "LHAPDF/UncertaintyAccumulator.h"
+#include "LHAPDF/LazyPDFs.h"
+#include "LHAPDF/SetGrid.h"
 #include "LHAPDF/PDFInfo.h"
 #include "LHAPDF/Factories.h"
 #include "LHAPDF/PDFIndex.h"
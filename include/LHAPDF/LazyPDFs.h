@@ -0,0 +1,167 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_LazyPDFs_H
+#define LHAPDF_LazyPDFs_H
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <iterator>
+#include <cstdint>
+#include <cstddef>
+
+namespace LHAPDF {
+
+
+  // Forward declarations
+  class PDF;
+  class PDFSet;
+
+
+  /// @brief Container of the members of a PDF set, loaded on first access
+  ///
+  /// Behaves like the vector of PDF pointers returned by PDFSet::mkPDFs, but
+  /// each member's grid data is only read when that member is first requested,
+  /// which is much cheaper when only a few members of a large replica set are
+  /// used. Members are returned as shared pointers which stay valid for as long
+  /// as they are held, independently of the container.
+  ///
+  /// If a memory budget is set, the least recently used members are dropped
+  /// from the container when the total in-memory size of its loaded members
+  /// exceeds it, to be reloaded if they are requested again. The most recently
+  /// loaded member is always kept, even if it alone exceeds the budget.
+  ///
+  /// All the access methods may be called concurrently from several threads:
+  /// each member is loaded at most once while it is resident, with other
+  /// threads requesting the same member waiting for that load to finish.
+  class LazyPDFs {
+  public:
+
+    /// @name Creation
+    //@{
+
+    /// @brief Constructor for the members of @a set, which must outlive this container
+    ///
+    /// The memory budget @a budgetMB is in MB, with 0 meaning no limit. If it
+    /// is negative, the LazyMemoryBudget config key is used.
+    LazyPDFs(const PDFSet& set, double budgetMB=-1);
+
+    //@}
+
+
+    /// @name Vector-like member access
+    //@{
+
+    /// Number of members in the set
+    size_t size() const { return _slots.size(); }
+
+    /// Is the set empty?
+    bool empty() const { return _slots.empty(); }
+
+    /// Get member @a imem, loading it if necessary
+    std::shared_ptr<PDF> operator[](size_t imem) const { return _get(imem); }
+
+    /// Get member @a imem, loading it if necessary, with bounds checking
+    std::shared_ptr<PDF> at(size_t imem) const;
+
+    /// Forward iterator over the members, loading each as it is dereferenced
+    class const_iterator {
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef std::shared_ptr<PDF> value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const std::shared_ptr<PDF>* pointer;
+      typedef std::shared_ptr<PDF> reference;
+      const_iterator(const LazyPDFs* pdfs=0, size_t imem=0) : _pdfs(pdfs), _imem(imem) {  }
+      std::shared_ptr<PDF> operator*() const { return (*_pdfs)[_imem]; }
+      const_iterator& operator++() { ++_imem; return *this; }
+      const_iterator operator++(int) { const_iterator tmp(*this); ++_imem; return tmp; }
+      bool operator==(const const_iterator& other) const { return _pdfs == other._pdfs && _imem == other._imem; }
+      bool operator!=(const const_iterator& other) const { return !(*this == other); }
+    private:
+      const LazyPDFs* _pdfs;
+      size_t _imem;
+    };
+
+    /// Iterator to the first member
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    /// Iterator past the last member
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    //@}
+
+
+    /// @name Residency and memory management
+    //@{
+
+    /// The PDF set whose members are contained
+    const PDFSet& set() const { return *_set; }
+
+    /// Is member @a imem currently loaded in the container?
+    bool loaded(size_t imem) const;
+
+    /// Number of members currently loaded in the container
+    size_t numLoaded() const;
+
+    /// Total in-memory size of the loaded members' grid data, in MB
+    double memoryMB() const;
+
+    /// The memory budget, in MB, with 0 meaning no limit
+    double memoryBudgetMB() const { return _budget / 1e6; }
+
+    /// Drop member @a imem from the container, if it is loaded
+    void evict(size_t imem);
+
+    /// Drop all members from the container
+    void clear();
+
+    //@}
+
+
+  private:
+
+    /// Load state of a single member
+    struct _Slot {
+      std::mutex loadmutex; //< Serialises the loading of this member
+      std::shared_ptr<PDF> pdf; //< Only accessed via the atomic shared_ptr functions
+      std::atomic<uint64_t> lastuse; //< Access tick of the last request
+      size_t bytes; //< Accounted size, only accessed with the container mutex held
+      bool resident; //< Whether the size is accounted, only accessed with the container mutex held
+      _Slot() : lastuse(0), bytes(0), resident(false) {  }
+    };
+
+    /// Get a member, loading it and evicting others as needed
+    std::shared_ptr<PDF> _get(size_t imem) const;
+
+    /// Drop a resident member, with the container mutex held
+    void _evict(_Slot& slot) const;
+
+    /// The PDF set
+    const PDFSet* _set;
+
+    /// Memory budget in bytes, with 0 meaning no limit
+    double _budget;
+
+    /// Member slots, individually allocated since they are not movable
+    std::vector< std::unique_ptr<_Slot> > _slots;
+
+    /// Container-wide lock for the memory accounting and eviction
+    std::unique_ptr<std::mutex> _mutex;
+
+    /// Total accounted size of the resident members, in bytes
+    mutable size_t _bytes;
+
+    /// Access counter, for the least-recently-used eviction order
+    std::unique_ptr< std::atomic<uint64_t> > _tick;
+
+  };
+
+
+}
+#endif
@@ -17,7 +17,54 @@ namespace LHAPDF {
   /// This class will interpolate in 2D using a bicubic hermite spline.
   class LogBicubicInterpolator : public Interpolator {
   public:
+
+    /// @brief Constructor
+    ///
+    /// If @a precomputed is true, the d(xf)/dlog(x) and d(xf)/dlog(Q2) derivatives at
+    /// the knots are computed once for each knot array when the grid is loaded,
+    /// rather than by finite differences in every call.
+    LogBicubicInterpolator(bool precomputed=false) : _precomputed(precomputed) { }
+
+    /// Compute the knot derivative tables, if in precomputed mode
+    void prepare(KnotArray1F& subgrid) const;
+
     double _interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const;
+
+    /// Interpolate a block of points in one subgrid, checking the knot counts once
+    void _interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                              const double* xs, const size_t* ixs,
+                              const double* q2s, const size_t* iq2s,
+                              double* rtn, size_t stride) const;
+
+    /// Interpolate several flavors with the same knots, sharing the logs and interpolation weights
+    void _interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                           double x, size_t ix, double q2, size_t iq2, double* rtn) const;
+
+    /// Cubic interpolation stencils in log(x) and log(Q2), or linear ones for fewer than 4 Q2 knots, for the vectorised kernels
+    bool _stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const;
+
+    /// Indices, logs and Hermite weights of a point, for the query cache
+    void _cellWeights(const KnotArray1F& subgrid, CellWeights& w) const;
+
+    /// Interpolate a single flavor from cached Hermite weights
+    double _interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const;
+
+  protected:
+
+    /// Check that the subgrid has enough knots for this interpolator
+    void _checkKnots(const KnotArray1F& subgrid) const;
+
+    /// Check that the (ix, iq2) cell is within the subgrid
+    void _checkIndices(const KnotArray1F& subgrid, size_t ix, size_t iq2) const;
+
+    /// Interpolate a single point given log(x) and log(Q2), once the knots and indices are checked
+    double _interpolateLogXQ2(const KnotArray1F& subgrid, double logx, size_t ix, double logq2, size_t iq2) const;
+
+  private:
+
+    /// Use precomputed knot derivatives?
+    bool _precomputed;
+
   };
 
 
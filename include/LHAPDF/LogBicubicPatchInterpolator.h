@@ -0,0 +1,55 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_LogBicubicPatchInterpolator_H
+#define LHAPDF_LogBicubicPatchInterpolator_H
+
+#include "LHAPDF/LogBicubicInterpolator.h"
+
+namespace LHAPDF {
+
+
+  /// @brief Implementation of log-space bicubic interpolation via cached cell polynomials
+  ///
+  /// This gives the same bicubic Hermite spline as LogBicubicInterpolator, up
+  /// to floating-point rounding, but the 16 polynomial coefficients of every
+  /// grid cell are computed once when the grid is loaded, so each query is a
+  /// single polynomial evaluation in the cell's local (log(x), log(Q2))
+  /// coordinates. The coefficient tables take 16 times the memory of the xf
+  /// values themselves.
+  ///
+  /// Subgrids with fewer than 4 Q2 knots, and knot arrays without coefficients,
+  /// fall back to the LogBicubicInterpolator behaviour. The vectorised
+  /// stencil kernels are not used.
+  class LogBicubicPatchInterpolator : public LogBicubicInterpolator {
+  public:
+
+    /// Compute the cell coefficients of a knot array
+    void prepare(KnotArray1F& subgrid) const;
+
+    double _interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const;
+
+    /// Interpolate a block of points in one subgrid from the cell coefficients
+    void _interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                              const double* xs, const size_t* ixs,
+                              const double* q2s, const size_t* iq2s,
+                              double* rtn, size_t stride) const;
+
+    /// Interpolate several flavors with the same knots from their cell coefficients
+    void _interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                           double x, size_t ix, double q2, size_t iq2, double* rtn) const;
+
+    /// No stencils: the cell polynomials are already the cheapest evaluation
+    bool _stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const { return false; }
+
+    /// Interpolate a single flavor from the cached logs and indices, using its cell coefficients
+    double _interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const;
+
+  };
+
+
+}
+#endif
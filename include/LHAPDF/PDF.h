@@ -11,11 +11,14 @@
 #include "LHAPDF/PDFIndex.h"
 #include "LHAPDF/Factories.h"
 #include "LHAPDF/AlphaS.h"
+#include "LHAPDF/FlavorLayout.h"
 #include "LHAPDF/Utils.h"
 #include "LHAPDF/Paths.h"
 #include "LHAPDF/Exceptions.h"
 #include "LHAPDF/Version.h"
 #include "LHAPDF/Config.h"
+#include <atomic>
+#include <mutex>
 
 namespace LHAPDF {
 
@@ -23,26 +26,27 @@ namespace LHAPDF {
   /// @brief PDF is the general interface for access to parton density information.
   ///
   /// The PDF interface declares the general form of all PDF types, such as Grid based or analytic.
+  ///
+  /// @note Once a PDF is constructed, all its const methods, including the
+  /// xfxQ2 and alphasQ2 queries, may be called concurrently from several
+  /// threads on the same object. Data cached from the metadata is filled on
+  /// loading, or else once only on first use. Non-const methods, such as the
+  /// setters and the non-const info() and knotarrays() accessors, must not be
+  /// called concurrently with any other method.
   class PDF {
   protected: //< These constructors should only be called by subclasses
 
-    /// Internal convenience typedef for the AlphaS object handle
-    /// @todo Reinstate this unique_ptr when C++98 header compatibility is no longer an issue
-    // typedef unique_ptr<AlphaS> AlphaSPtr;
-    typedef AlphaS* AlphaSPtr;
+    /// Internal convenience typedef for the AlphaS object handle, which may be shared between PDFs
+    typedef std::shared_ptr<const AlphaS> AlphaSPtr;
 
-    /// Force initialization of the only non-class member.
-    /// @todo Remove _alphas initialisation when it can be a smart ptr again
-    PDF() : _alphas(0), _forcePos(0) { }
+    /// Force initialization of the non-class members.
+    PDF() : _flavorsready(false), _forcePos(0) { }
 
 
   public:
 
     /// Virtual destructor, to allow unfettered inheritance
-    virtual ~PDF() {
-      /// @todo Remove this delete when C++98 is gone, and unique_ptr can be reinstated
-      delete _alphas;
-    }
+    virtual ~PDF() { }
 
     //@}
 
@@ -104,10 +108,40 @@ namespace LHAPDF {
     }
 
 
+    /// @brief Get the PDF xf(x) values at many (x,q2) points for the given PID.
+    ///
+    /// The batch equivalent of xfxQ2(id, x, q2), for the @a npoints points
+    /// given by the @a xs and @a q2s arrays, with the xf(x,q2) values written
+    /// to the @a rtn array. The range and flavor checks, positivity setting
+    /// and dispatch to the concrete PDF type are done once for the whole
+    /// batch, so this is much faster than repeated single-point calls.
+    ///
+    /// @param id PDG parton ID
+    /// @param xs Array of momentum fractions
+    /// @param q2s Array of squared energy (renormalization) scales
+    /// @param npoints Number of points
+    /// @param rtn Array of at least @a npoints PDF xf(x,q2) values, to be filled
+    void xfxQ2(int id, const double* xs, const double* q2s, size_t npoints, double* rtn) const;
+
+    /// @brief Get the PDF xf(x) values at many (x,q2) points for the given PID.
+    ///
+    /// This version takes the points as vectors, which must be the same size,
+    /// and resizes the user-supplied return vector to match.
+    void xfxQ2(int id, const std::vector<double>& xs, const std::vector<double>& q2s, std::vector<double>& rtn) const;
+
+    /// @brief Get the PDF xf(x) values at many (x,q2) points for a list of PIDs.
+    ///
+    /// As for the single-PID batch xfxQ2, with the value for PID @a ids[j] at
+    /// point i written to rtn[i*ids.size() + j], i.e. all the requested
+    /// flavors for the first point, then for the second, and so on.
+    void xfxQ2(const std::vector<int>& ids, const double* xs, const double* q2s, size_t npoints, double* rtn) const;
+
+
     /// @brief Get the PDF xf(x) value at (x,q2) for all supported PIDs.
     ///
     /// This version fills a user-supplied map to avoid container construction
-    /// costs on every call.
+    /// costs on every call: a map reused from a previous call on this PDF is
+    /// updated in place, without allocation.
     ///
     /// @param x Momentum fraction
     /// @param q2 Squared energy (renormalization) scale
@@ -159,6 +193,46 @@ namespace LHAPDF {
     }
 
 
+    /// @brief Get the PDF xf(x) values at (x,q2) for the PIDs of a flavor layout.
+    ///
+    /// The value for PID layout.pid(j) is written to rtn[j], which must have
+    /// at least layout.size() entries, with 0 for PIDs not defined by this
+    /// PDF. No heap memory is allocated, so with a layout built once this is
+    /// the cheapest all-flavor query, e.g. in event loops.
+    ///
+    /// @param x Momentum fraction
+    /// @param q2 Squared energy (renormalization) scale
+    /// @param layout PIDs of the output slots
+    /// @param rtn Array of PDF xf(x,q2) values, to be filled
+    void xfxQ2(double x, double q2, const FlavorLayout& layout, double* rtn) const {
+      _xfxQ2Flavors(layout.queryIDs(), layout.size(), &x, &q2, 1, rtn);
+    }
+
+    /// @brief Get the PDF xf(x) values at (x,q) for the PIDs of a flavor layout.
+    ///
+    /// As for the (x,q2) version, with rtn[j] the value for PID layout.pid(j).
+    void xfxQ(double x, double q, const FlavorLayout& layout, double* rtn) const {
+      xfxQ2(x, q*q, layout, rtn);
+    }
+
+    /// @brief Get the PDF xf(x) values at (x,q2) for the PIDs of a flavor layout.
+    ///
+    /// This version resizes the user-supplied vector to layout.size(), which
+    /// only allocates the first time it is used.
+    void xfxQ2(double x, double q2, const FlavorLayout& layout, std::vector<double>& rtn) const {
+      rtn.resize(layout.size());
+      xfxQ2(x, q2, layout, rtn.data());
+    }
+
+    /// @brief Get the PDF xf(x) values at many (x,q2) points for the PIDs of a flavor layout.
+    ///
+    /// As for the PID-list batch xfxQ2, with the value for PID layout.pid(j)
+    /// at point i written to rtn[i*layout.size() + j].
+    void xfxQ2(const FlavorLayout& layout, const double* xs, const double* q2s, size_t npoints, double* rtn) const {
+      _xfxQ2Flavors(layout.queryIDs(), layout.size(), xs, q2s, npoints, rtn);
+    }
+
+
     /// @brief Get the PDF xf(x) value at (x,q2) for all supported PIDs.
     ///
     /// This version creates a new map on every call: prefer to use the
@@ -202,9 +276,32 @@ namespace LHAPDF {
     /// @return the value of xf(x,q2)
     virtual double _xfxQ2(int id, double x, double q2) const = 0;
 
+    /// @brief Calculate the PDF xf(x) values at many (x,q2) points for the given PID.
+    ///
+    /// The batch counterpart of _xfxQ2, called by the public batch xfxQ2 methods
+    /// after the range and PID checks, with the value for point i written to
+    /// rtn[i*stride]. The default implementation calls _xfxQ2 for each point:
+    /// override to evaluate many points at once.
+    virtual void _xfxQ2Batch(int id, const double* xs, const double* q2s, size_t npoints,
+                             double* rtn, size_t stride) const;
+
+    /// @brief Calculate the PDF xf(x) values at a single (x,q2) point for several PIDs.
+    ///
+    /// The multi-flavor counterpart of _xfxQ2, called by the public
+    /// all-flavor xfxQ2 methods after the range and PID checks, with the value
+    /// for PID ids[j] written to rtn[j]. The default implementation calls
+    /// _xfxQ2 for each PID: override to share work between the flavors.
+    virtual void _xfxQ2NF(const int* ids, size_t nids, double x, double q2, double* rtn) const;
+
     //@}
 
 
+  private:
+
+    /// Batch xfxQ2 for @a nids PIDs, with the checks and positivity forcing, writing rtn[i*nids + j]
+    void _xfxQ2Flavors(const int* ids, size_t nids, const double* xs, const double* q2s, size_t npoints, double* rtn) const;
+
+
   public:
 
     /// @name Ranges of validity
@@ -253,9 +350,21 @@ namespace LHAPDF {
     /// interpolating/extrapolating PDFs that sharply decrease towards zero.
     /// 0 = unforced, 1 = forced positive, 2 = forced positive definite (>= 1e-10)
     int forcePositive() const {
-      if (_forcePos < 0) //< Caching
-        _forcePos = info().get_entry_as<unsigned int>("ForcePositive", 0);
-      return _forcePos;
+      int forcepos = _forcePos.load(std::memory_order_relaxed);
+      if (forcepos < 0) { //< Caching, for PDFs not loaded from file: concurrent callers store the same value
+        forcepos = info().get_entry_as<unsigned int>("ForcePositive", 0);
+        _forcePos.store(forcepos, std::memory_order_relaxed);
+      }
+      return forcepos;
+    }
+
+    /// @brief Set whether the PDF returns only positive (definite) values
+    ///
+    /// As the ForcePositive metadata, which is otherwise read on first use:
+    /// 0 = unforced, 1 = forced positive, 2 = forced positive definite.
+    void setForcePositive(int forcepos) {
+      _info.set_entry("ForcePositive", forcepos);
+      _forcePos = forcepos;
     }
 
     /// @brief Check whether the given x is physically valid
@@ -401,13 +510,21 @@ namespace LHAPDF {
     ///
     /// @todo Make virtual for AnalyticPDF? Or allow manual setting of the Info?
     virtual const std::vector<int>& flavors() const {
-      if (_flavors.empty()) {
-        _flavors = info().get_entry_as< vector<int> >("Flavors");
-        sort(_flavors.begin(), _flavors.end());
-      }
+      if (!_flavorsready.load(std::memory_order_acquire)) _loadFlavors();
       return _flavors;
     }
 
+    /// @brief Set the list of flavours defined by this PDF
+    ///
+    /// As the Flavors metadata, which is otherwise read on first use.
+    void setFlavors(const std::vector<int>& pids) {
+      _info.set_entry("Flavors", pids);
+      std::lock_guard<std::mutex> lock(_lazymutex);
+      _flavors = pids;
+      sort(_flavors.begin(), _flavors.end());
+      _flavorsready = true;
+    }
+
     /// Checks whether @a id is a valid parton for this PDF.
     bool hasFlavor(int id) const;
 
@@ -445,17 +562,29 @@ namespace LHAPDF {
     /// and ownership passes to this GridPDF: delete will be called on this ptr
     /// when this PDF goes out of scope or another setAlphaS call is made.
     void setAlphaS(AlphaS* alphas) {
-      // _alphas.reset(alphas);
+      _alphas.reset(alphas);
+    }
+
+    /// @brief Set an AlphaS calculator shared with other users, e.g. from mkSharedAlphaS
+    void setAlphaS(const AlphaSPtr& alphas) {
+      _alphas = alphas;
     }
 
     /// @brief Check if an AlphaS calculator is set
     bool hasAlphaS() const {
-      return _alphas;
+      return bool(_alphas);
     }
 
     /// @brief Retrieve the AlphaS object for this PDF
+    ///
+    /// @note The object is returned as it is, and may be shared with other
+    /// PDFs: as when it was made from the metadata, unless disabled via the
+    /// ShareAlphaS config key, or set with setAlphaS from a shared pointer.
+    /// A shared object is read-only: to change the alpha_s of this PDF alone,
+    /// give it an object of its own with setAlphaS.
     AlphaS& alphaS() {
-      return *_alphas;
+      // Every AlphaS is created non-const, by mkAlphaS or the caller
+      return const_cast<AlphaS&>(*_alphas);
     }
 
     /// @brief Retrieve the AlphaS object for this PDF (const)
@@ -480,17 +609,32 @@ namespace LHAPDF {
       return _alphas->alphasQ2(q2);
     }
 
+    /// @brief Values of alpha_s(Q2) used by this PDF, at @a n scales
+    ///
+    /// The batch equivalent of alphasQ2(q2), writing the value for
+    /// @a q2s[i] to @a out[i]. See AlphaS::alphasQ2(const double*, double*, size_t).
+    void alphasQ2(const double* q2s, double* out, size_t n) const {
+      if (!hasAlphaS()) throw Exception("No AlphaS pointer has been set");
+      _alphas->alphasQ2(q2s, out, n);
+    }
+
     //@}
 
 
   protected:
 
+    /// @brief Load the AlphaS object from the metadata
+    ///
+    /// Shared with all other PDFs with the same alpha_s parameters, unless
+    /// disabled via the ShareAlphaS config key.
     void _loadAlphaS() {
-      // _alphas.reset( mkAlphaS(info()) );
-      if (hasAlphaS()) delete _alphas;
-      _alphas = mkAlphaS(info());
+      if (info().get_entry_as<bool>("ShareAlphaS", true)) setAlphaS(mkSharedAlphaS(info()));
+      else setAlphaS(mkAlphaS(info()));
     }
 
+    /// Read the flavor list from the info into the cache, once only
+    void _loadFlavors() const;
+
     /// Get the set name from the member data file path (for internal use only)
     std::string _setname() const {
       return basename(dirname(_mempath));
@@ -505,15 +649,21 @@ namespace LHAPDF {
     /// Locally cached list of supported PIDs
     mutable vector<int> _flavors;
 
+    /// Whether the flavor list has been cached
+    mutable std::atomic<bool> _flavorsready;
+
     /// Optionally loaded AlphaS object
-    mutable AlphaSPtr _alphas;
+    AlphaSPtr _alphas;
 
     /// @brief Cached flag for whether to return only positive (or postive definite) PDF values
     ///
     /// A negative value indicates that the flag has not been set. 0 = no
     /// forcing, 1 = force positive (i.e. 0 is permitted, negative values are
     /// not), 2 = force positive definite (i.e. no values less than 1e-10).
-    mutable int _forcePos;
+    mutable std::atomic<int> _forcePos;
+
+    /// Lock for the once-only initialisation of cached data on first use
+    mutable std::mutex _lazymutex;
 
   };
 
@@ -12,6 +12,9 @@
 #include "LHAPDF/Version.h"
 #include "LHAPDF/Config.h"
 #include "LHAPDF/Utils.h"
+#include "LHAPDF/KnotArray.h"
+#include "LHAPDF/LazyPDFs.h"
+#include "LHAPDF/SetGrid.h"
 
 namespace LHAPDF {
 
@@ -137,10 +140,15 @@ namespace LHAPDF {
     /// pointers?), but they also need to be compatible with storage in STL
     /// containers, e.g. std::unique_ptr or std::shared_ptr but *not* the
     /// deprecated std::auto_ptr.
+    ///
+    /// The members are loaded concurrently on @a nthreads threads, and returned
+    /// in member order. If @a nthreads is negative, the LoadThreads config key
+    /// is used (default = 1, i.e. serial loading), and a value of 0 means one
+    /// thread per hardware core.
     //
     /// @todo Needs to be implemented in the header since the arg type is templated.
     template <typename PTR>
-    void mkPDFs(std::vector<PTR>& pdfs) const {
+    void mkPDFs(std::vector<PTR>& pdfs, int nthreads=-1) const {
       const int v = verbosity();
       if (v > 0) {
         std::cout << "LHAPDF " << version() << " loading all " << size() << " PDFs in set " << name() << std::endl;
@@ -150,9 +158,16 @@ namespace LHAPDF {
       pdfs.clear();
       pdfs.reserve(size());
       if (v < 2) setVerbosity(0); //< Disable every-member printout unless verbosity level is high
-      for (size_t i = 0; i < size(); ++i) {
+      std::vector<PDF*> rawptrs;
+      try {
+        _mkPDFs(rawptrs, nthreads);
+      } catch (...) {
+        setVerbosity(v);
+        throw;
+      }
+      for (size_t i = 0; i < rawptrs.size(); ++i) {
         /// @todo Need to use an std::move here, or write differently, for unique_ptr to work?
-        pdfs.push_back( PTR(mkPDF(i)) );
+        pdfs.push_back( PTR(rawptrs[i]) );
       }
       setVerbosity(v);
     }
@@ -162,21 +177,48 @@ namespace LHAPDF {
     /// @note As with the mkPDF method and factory function, the PDF pointers
     /// returned by this method are heap allocated and their memory management
     /// is now the responsibility of the caller.
-    std::vector<PDF*> mkPDFs() const {
+    std::vector<PDF*> mkPDFs(int nthreads=-1) const {
       std::vector<PDF*> rtn;
-      mkPDFs(rtn);
+      mkPDFs(rtn, nthreads);
       return rtn;
     }
 
     /// @todo Use the following with default function template args if C++11 is being used
     // template <typename PTR=PDF*>
     template <typename PTR>
-    std::vector<PTR> mkPDFs() const {
+    std::vector<PTR> mkPDFs(int nthreads=-1) const {
       std::vector<PTR> rtn;
-      mkPDFs(rtn);
+      mkPDFs(rtn, nthreads);
       return rtn;
     }
 
+    /// @brief Make all the PDFs in this set as raw pointers, on @a nthreads threads
+    ///
+    /// The worker behind mkPDFs. If any member fails to load, all the loaded
+    /// members are deleted and the first failure, in member order, is rethrown.
+    void _mkPDFs(std::vector<PDF*>& pdfs, int nthreads) const;
+
+    /// @brief Make a container of all the PDFs in this set, each loaded on first access
+    ///
+    /// Unlike mkPDFs, no member grid data is read until a member is requested,
+    /// and members are owned by shared pointers. The memory budget for loaded
+    /// members, @a budgetMB, is in MB with 0 meaning no limit; if negative, the
+    /// LazyMemoryBudget config key is used.
+    /// @see LazyPDFs
+    LazyPDFs mkLazyPDFs(double budgetMB=-1) const {
+      return LazyPDFs(*this, budgetMB);
+    }
+
+    /// @brief Make all the PDFs in this set as one set-level grid, for evaluating all members at once
+    ///
+    /// The members are loaded as by mkPDFs, on @a nthreads threads. The
+    /// member vectors returned by the SetGrid xfxQ2 methods can be passed
+    /// directly to uncertainty.
+    /// @see SetGrid
+    SetGrid mkSetGrid(int nthreads=-1) const {
+      return SetGrid(*this, nthreads);
+    }
+
     //@}
 
 
@@ -233,6 +275,9 @@ namespace LHAPDF {
     /// variation uncertainties is available.  The parameter variation
     /// uncertainties are computed from the last 2*n members of the set, with n
     /// the number of parameters.
+    ///
+    /// For many observables filled incrementally, e.g. histogram bins filled
+    /// event by event, use an UncertaintyAccumulator instead.
     PDFUncertainty uncertainty(const std::vector<double>& values,
                                double cl=100*erf(1/sqrt(2)), bool alternative=false) const;
 
@@ -286,11 +331,28 @@ namespace LHAPDF {
     //@}
 
 
+    /// @name Shared member data
+    //@{
+
+    /// @brief Get a shared, immutable copy of the knot axes (x, Q2) = (@a xs, @a q2s)
+    ///
+    /// Members of the set loading grids with identical knots, e.g. all the
+    /// replicas of a Monte Carlo set, receive the same KnotAxes object. The set
+    /// does not keep the axes alive itself, so they are freed along with the
+    /// last PDF member which uses them.
+    std::shared_ptr<const KnotAxes> knotAxes(const std::vector<double>& xs, const std::vector<double>& q2s);
+
+    //@}
+
+
   private:
 
     /// Name of this set
     std::string _setname;
 
+    /// Interned knot axes, weakly referenced
+    std::vector< std::weak_ptr<const KnotAxes> > _knotaxes;
+
   };
 
 
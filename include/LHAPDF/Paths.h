@@ -49,6 +49,16 @@ namespace LHAPDF {
   ///
   /// If no matching file is found, return an empty path.
   std::string findFile(const std::string& target);
+
+
+  /// @brief Get the directory for cached derived data, from $LHAPDF_CACHE
+  ///
+  /// Caching is opt-in: an empty path, the default, means that nothing is
+  /// cached. Currently used to store the solved alpha_s ODE tables.
+  std::string cachePath();
+
+  /// Set the cache directory, or disable caching with an empty path
+  void setCachePath(const std::string& path);
   //@}
 
 
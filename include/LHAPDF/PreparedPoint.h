@@ -0,0 +1,83 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_PreparedPoint_H
+#define LHAPDF_PreparedPoint_H
+
+#include "LHAPDF/KnotArray.h"
+#include "LHAPDF/SIMDKernels.h"
+#include <typeinfo>
+
+namespace LHAPDF {
+
+
+  // Forward declaration
+  class GridPDF;
+
+
+  /// @brief An (x,Q2) point with its grid location and interpolation weights precomputed
+  ///
+  /// Made by GridPDF::prepare, which does the subgrid lookup, the knot index
+  /// searches, the log(x) and log(Q2) evaluations and the interpolation weight
+  /// construction once. GridPDF::xfxQ2 then evaluates the point with only the
+  /// final weighted sum of the knot values, on the preparing PDF or on any
+  /// other grid PDF with the same knots and interpolator, such as the other
+  /// members of a set or other sets on the same grid.
+  ///
+  /// PDFs with different knots or a different interpolator, points outside the
+  /// grid, and interpolators which do not provide weight stencils (e.g.
+  /// logcubic-patch) are evaluated by the normal xfxQ2 route instead, so a
+  /// prepared point can safely be used with any PDF. The prepared results agree
+  /// with the normal ones up to rounding.
+  class PreparedPoint {
+  public:
+
+    /// Default constructor, for an unprepared point at x = Q2 = 0
+    PreparedPoint() : _x(0), _q2(0), _isubgrid(0), _ipoltype(0) { }
+
+    /// x value of the point
+    double x() const { return _x; }
+
+    /// Q2 value of the point
+    double q2() const { return _q2; }
+
+    /// Were the grid location and interpolation weights precomputed?
+    bool prepared() const { return bool(_axes); }
+
+    /// Index of the subgrid, in increasing Q2 order, of a prepared point
+    size_t subgridIndex() const { return _isubgrid; }
+
+    /// Interpolation stencil in x of a prepared point
+    const KnotStencil& xStencil() const { return _sx; }
+
+    /// Interpolation stencil in Q2 of a prepared point
+    const KnotStencil& q2Stencil() const { return _sq; }
+
+
+  private:
+
+    friend class GridPDF;
+
+    /// The x and Q2 values
+    double _x, _q2;
+
+    /// Index of the subgrid in the preparing PDF
+    size_t _isubgrid;
+
+    /// Knots of the subgrid, or null if the point is not prepared
+    std::shared_ptr<const KnotAxes> _axes;
+
+    /// Type of the preparing interpolator
+    const std::type_info* _ipoltype;
+
+    /// Interpolation stencils in x and Q2
+    KnotStencil _sx, _sq;
+
+  };
+
+
+}
+#endif
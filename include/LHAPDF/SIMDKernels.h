@@ -0,0 +1,88 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_SIMDKernels_H
+#define LHAPDF_SIMDKernels_H
+
+#include "LHAPDF/Utils.h"
+#include "LHAPDF/KnotArray.h"
+
+namespace LHAPDF {
+
+
+  /// @name Vectorised interpolation kernels
+  ///
+  /// The linear and cubic grid interpolations are linear in the xf values at
+  /// the knots, and separable in x and Q2: the interpolated value is
+  ///   xf(x, Q2) = sum_{a,b} wx[a] wq[b] xf(ix0+a, iq0+b)
+  /// where the stencil weights wx and wq depend only on the point and the
+  /// knots. The kernels here compute the stencil once per point and apply it
+  /// with SIMD instructions, either across the flavors of an all-parton query
+  /// or across the points of a batched single-flavor query.
+  ///
+  /// The SSE2 kernels give the same results as the scalar stencil kernels. The
+  /// AVX2 and AVX-512 kernels use fused multiply-adds, so differ from them by
+  /// rounding. The stencil evaluation as a whole agrees with the scalar
+  /// interpolators to a relative precision of 1e-12 (in units of the larger of
+  /// |xf| and 1), rather than bit-for-bit.
+  //@{
+
+  /// Instruction set levels of the vectorised kernels, in increasing order
+  enum SIMDLevel { SIMD_NONE = 0, SIMD_SSE2 = 1, SIMD_AVX2 = 2, SIMD_AVX512 = 3 };
+
+  /// Highest SIMD level supported by both this build and the host CPU
+  SIMDLevel simdLevelSupported();
+
+  /// Name of a SIMD level: "none", "sse2", "avx2" or "avx512"
+  std::string simdLevelName(SIMDLevel level);
+
+  /// @brief SIMD level from its name
+  ///
+  /// "auto" gives the highest supported level, and other levels are capped at
+  /// it, so a setting can be shared between machines.
+  SIMDLevel simdLevelFromName(const std::string& name);
+
+
+  /// @brief Interpolation stencil along one knot axis
+  ///
+  /// The interpolated value along the axis is the weighted sum of the values
+  /// at knots i0 to i0+n-1, with weights w[0] to w[n-1].
+  struct KnotStencil {
+    size_t i0, n;
+    double w[4];
+  };
+
+  /// Linear interpolation stencil at @a v, between knots i and i+1
+  void linearStencil(const std::vector<double>& knots, size_t i, double v, KnotStencil& s);
+
+  /// @brief Cubic Hermite interpolation stencil at @a v, between knots i and i+1
+  ///
+  /// The knot derivatives are the averages of the adjacent finite differences,
+  /// or one-sided differences at the edges, as in the cubic interpolators.
+  /// There must be at least 4 knots.
+  void cubicStencil(const std::vector<double>& knots, size_t i, double v, KnotStencil& s);
+
+
+  /// @brief Apply the stencils @a sx and @a sq to several flavor arrays with the same knots
+  ///
+  /// The result for subgrids[j] is written to rtn[j]. The vectorisation is
+  /// across the flavors, of which there may be at most 32.
+  void applyStencilNF(SIMDLevel level, const KnotStencil& sx, const KnotStencil& sq,
+                      const KnotArray1F* const* subgrids, size_t nflavs, double* rtn);
+
+  /// @brief Apply a stencil pair per point to the flavor array of that point
+  ///
+  /// The result of applying the stencils sxs[i] and sqs[i] to subgrids[i] is
+  /// written to rtn[i*stride]. The points may be in different subgrids and
+  /// have stencils of different sizes. The vectorisation is across the points.
+  void applyStencils(SIMDLevel level, const KnotArray1F* const* subgrids, size_t npoints,
+                     const KnotStencil* sxs, const KnotStencil* sqs, double* rtn, size_t stride);
+
+  //@}
+
+
+}
+#endif
@@ -0,0 +1,136 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_SetGrid_H
+#define LHAPDF_SetGrid_H
+
+#include "LHAPDF/LazyPDFs.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace LHAPDF {
+
+
+  // Forward declarations
+  class PDF;
+  class PDFSet;
+  class PreparedPoint;
+
+
+  /// @brief All the members of a grid PDF set, stored as one tensor for set-wide evaluation
+  ///
+  /// When all the members share the same knots, flavors and interpolator, as
+  /// is usual within a set, their grid values are stored together in one
+  /// [subgrid][ix][iQ2][flavor][member] tensor. The interpolation weights of a
+  /// point are then computed once, and applied to contiguous runs over the
+  /// members, so a single call gives the values of every member, ready to pass
+  /// to PDFSet::uncertainty.
+  ///
+  /// Points outside the grid, and sets whose members do not share a grid
+  /// layout or whose interpolator does not provide weight stencils, are
+  /// evaluated member by member instead, so the results always agree with the
+  /// member xfxQ2 values, up to rounding. With a tensor, only member 0 is
+  /// kept alongside it, and the other members are loaded again on demand, as
+  /// by LazyPDFs, for the first point outside the grid, so the grid data of a
+  /// set is only held twice if such points are queried.
+  ///
+  /// All the evaluation methods may be called concurrently from several threads.
+  class SetGrid {
+  public:
+
+    /// @brief Constructor for the members of @a set, which must outlive this object
+    ///
+    /// The members are loaded as by PDFSet::mkPDFs, on @a nthreads threads.
+    SetGrid(const PDFSet& set, int nthreads=-1);
+
+
+    /// @name Set information
+    //@{
+
+    /// The PDF set
+    const PDFSet& set() const { return *_set; }
+
+    /// Number of members
+    size_t size() const { return _lazypdfs.size(); }
+
+    /// Member @a imem, loaded again if only the tensor is held
+    std::shared_ptr<const PDF> member(size_t imem) const { return _member(imem); }
+
+    /// Are the members stored as one tensor, rather than evaluated one by one?
+    bool tensor() const { return !_blocks.empty(); }
+
+    //@}
+
+
+    /// @name Set-wide PDF values
+    //@{
+
+    /// @brief Get xf(x,Q2) for PID @a id for all the members
+    ///
+    /// The value for member imem is written to rtn[imem].
+    void xfxQ2(int id, double x, double q2, std::vector<double>& rtn) const;
+
+    /// @brief Get xf(x,Q2) for the 13 partons for all the members
+    ///
+    /// The values for the PIDs -6 to 6 (gluon as 0) are in rtn[0] to rtn[12],
+    /// each a vector over the members.
+    void xfxQ2(double x, double q2, std::vector< std::vector<double> >& rtn) const;
+
+    /// Get xf(x,Q) for PID @a id for all the members
+    void xfxQ(int id, double x, double q, std::vector<double>& rtn) const {
+      xfxQ2(id, x, q*q, rtn);
+    }
+
+    //@}
+
+
+  private:
+
+    /// Grid values of one subgrid, for all the members
+    struct _Block {
+      std::vector<int> pids; //< The flavors in increasing order
+      size_t nq2; //< Number of Q2 knots
+      std::vector<double> xfs; //< Values, ordered as [ix][iQ2][flavor][member]
+    };
+
+    /// Build the tensor from the members @a pdfs, if they share a grid layout
+    void _build(const std::vector< std::shared_ptr<PDF> >& pdfs);
+
+    /// Member @a imem, from those held or else loaded on demand
+    std::shared_ptr<PDF> _member(size_t imem) const {
+      return _pdfs.empty() ? _lazypdfs[imem] : _pdfs[imem];
+    }
+
+    /// Apply the stencils of a point prepared on member 0 to flavor slot @a iflav of a block
+    void _contract(const _Block& block, size_t iflav, const PreparedPoint& pt, double* rtn) const;
+
+    /// Apply the positivity forcing of each member to the values rtn[imem]
+    void _forcePositive(double* rtn) const;
+
+    /// The PDF set
+    const PDFSet* _set;
+
+    /// Member 0, whose interpolator prepares the points for the tensor
+    std::shared_ptr<PDF> _pdf0;
+
+    /// All the members if there is no tensor, else empty
+    std::vector< std::shared_ptr<PDF> > _pdfs;
+
+    /// The members loaded on demand, for points outside the tensor
+    LazyPDFs _lazypdfs;
+
+    /// Positivity forcing level of each member
+    std::vector<int> _forcepos;
+
+    /// Tensor blocks, in the subgrid order of the members, or empty if not used
+    std::vector<_Block> _blocks;
+
+  };
+
+
+}
+#endif
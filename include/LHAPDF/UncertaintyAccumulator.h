@@ -0,0 +1,143 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#pragma once
+#ifndef LHAPDF_UncertaintyAccumulator_H
+#define LHAPDF_UncertaintyAccumulator_H
+
+#include "LHAPDF/PDFSet.h"
+
+namespace LHAPDF {
+
+
+  /// @brief Running per-member sums of observables, for PDF uncertainties without storing every value
+  ///
+  /// Made for a PDFSet, with its error type, parameter-variation layout and
+  /// confidence level scaling resolved once, and holding one sum per member
+  /// for each of a fixed number of observables, e.g. histogram bins. Event by
+  /// event, the member values of each filled observable are added to its
+  /// sums; the uncertainty of an observable is then calculated from its sums,
+  /// with the same formulae as PDFSet::uncertainty, for replica, Hessian and
+  /// symmetric Hessian sets.
+  ///
+  /// Accumulators for the same set and observables can be merged, e.g. one
+  /// per thread, and the raw sums read and merged back to combine separate
+  /// jobs. Filling and merging are not thread-safe: give each thread its own.
+  class UncertaintyAccumulator {
+  public:
+
+    /// @brief Constructor for @a nobs observables of the members of @a set
+    ///
+    /// Uncertainties are rescaled to the confidence level @a cl, in percent,
+    /// or given at the set's own confidence level if @a cl is negative, as for
+    /// PDFSet::uncertainty.
+    UncertaintyAccumulator(const PDFSet& set, size_t nobs=1, double cl=100*erf(1/sqrt(2)));
+
+
+    /// @name Layout
+    //@{
+
+    /// Number of members, including any parameter variations
+    size_t size() const { return _size; }
+
+    /// Number of observables
+    size_t nobs() const { return _nobs; }
+
+    //@}
+
+
+    /// @name Filling
+    //@{
+
+    /// @brief Add the values of all the members, times @a weight, to observable @a iobs
+    ///
+    /// The value for member imem is @a values[imem].
+    void fill(size_t iobs, const double* values, double weight=1) {
+      double* sums = &_sums[iobs*_size];
+      for (size_t imem = 0; imem < _size; ++imem) sums[imem] += weight * values[imem];
+    }
+
+    /// Add the values of all the members, times @a weight, to observable @a iobs
+    void fill(size_t iobs, const std::vector<double>& values, double weight=1) {
+      if (values.size() != _size)
+        throw UserError("Error in LHAPDF::UncertaintyAccumulator::fill. Input vector must contain values for all PDF members.");
+      fill(iobs, values.data(), weight);
+    }
+
+    /// Add @a value, times @a weight, to member @a imem of observable @a iobs
+    void fillMember(size_t iobs, size_t imem, double value, double weight=1) {
+      _sums[iobs*_size + imem] += weight * value;
+    }
+
+    /// Add the sums of @a other, made for the same set layout and number of observables
+    void merge(const UncertaintyAccumulator& other);
+
+    /// @brief Add raw sums, as from sums() of an accumulator in another job
+    ///
+    /// The vector must contain the sums for all the observables and members.
+    void merge(const std::vector<double>& sums);
+
+    /// Reset all the sums to zero
+    void reset();
+
+    /// @brief The raw sums, for observable iobs and member imem at [iobs*size() + imem]
+    ///
+    /// For storage and merging across jobs.
+    const std::vector<double>& sums() const { return _sums; }
+
+    /// The sums of the members for observable @a iobs
+    const double* sums(size_t iobs) const { return &_sums[iobs*_size]; }
+
+    //@}
+
+
+    /// @name Uncertainties
+    //@{
+
+    /// @brief Calculate the central value and uncertainties of observable @a iobs from its sums
+    ///
+    /// If the set is given in the form of replicas, @a alternative equal to
+    /// true gives the median and a confidence interval from the distribution
+    /// of replicas, as for PDFSet::uncertainty.
+    PDFUncertainty uncertainty(size_t iobs=0, bool alternative=false) const {
+      return uncertainty(sums(iobs), alternative);
+    }
+
+    /// @brief Calculate the central value and uncertainties from the @a values of all the members
+    ///
+    /// As PDFSet::uncertainty, but with the set layout already resolved.
+    PDFUncertainty uncertainty(const double* values, bool alternative=false) const;
+
+    //@}
+
+
+  private:
+
+    /// Uncertainty formulae, from the set's error type
+    enum ErrorType { REPLICAS, SYMMHESSIAN, HESSIAN, UNSUPPORTED };
+
+    /// The error type
+    ErrorType _errtype;
+    /// The error type string, for error messages
+    std::string _errtypestr;
+    /// Number of members, and of PDF error members excluding the central one and parameter variations
+    size_t _size, _nmem;
+    /// Number of varied parameters, each with two members at the end of the set
+    size_t _npar;
+    /// Should the uncertainties be rescaled, from the set confidence level to the requested one?
+    bool _rescale;
+    /// Requested confidence level (as a fraction), and scale factor from the set confidence level
+    double _reqCL, _scale;
+
+    /// Number of observables
+    size_t _nobs;
+    /// Sums for each observable and member
+    std::vector<double> _sums;
+
+  };
+
+
+}
+#endif
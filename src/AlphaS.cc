@@ -20,6 +20,12 @@ namespace LHAPDF {
   }
 
 
+  // Calculate alpha_s at many scales, one by one unless overridden
+  void AlphaS::alphasQ2(const double* q2s, double* out, size_t n) const {
+    for (size_t i = 0; i < n; ++i) out[i] = alphasQ2(q2s[i]);
+  }
+
+
   // Calculate the number of active quark flavours at energy scale Q2
   int AlphaS::numFlavorsQ2(double q2) const {
     if ( _flavorscheme == FIXED ) return _fixflav;
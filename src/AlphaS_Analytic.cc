@@ -85,10 +85,58 @@ namespace LHAPDF {
     const int nf = this->numFlavorsQ2(q2);
     const double lambdaQCD = _lambdaQCD(nf);
 
+    // Get beta coeffs for the number of active (above threshold) quark flavours at energy Q
+    double beta[4];
+    for (int i = 0; i < 4; ++i) beta[i] = _beta(i, nf);
+    return _alphasQ2(q2, lambdaQCD, beta);
+  }
+
+
+  // Calculate alpha_s(Q2) at many scales, with the nf-dependent inputs tabulated once
+  void AlphaS_Analytic::alphasQ2(const double* q2s, double* out, size_t n) const {
+    if (n == 0) return;
+    if ( _lambdas.empty() ) throw Exception("You need to set at least one lambda value to calculate alpha_s by analytic means!");
+
+    // Squared flavor thresholds by nf, as used by numFlavorsQ2, with unset ones never crossed
+    const map<int, double>& thresholds = _flavorthresholds.empty() ? _quarkmasses : _flavorthresholds;
+    double thresholds2[7];
+    for (int it = 0; it <= 6; ++it) {
+      map<int, double>::const_iterator element = thresholds.find(it);
+      thresholds2[it] = (element != thresholds.end()) ? sqr(element->second) : numeric_limits<double>::infinity();
+    }
+    const int itmin = max(_nfmin, 0), itmax = min(_nfmax, 6);
+
+    // LambdaQCD and beta coefficients by nf, filled on first use since _lambdaQCD may throw
+    double lambdas[7], betas[7][4];
+    bool filled[7] = { false, false, false, false, false, false, false };
+
+    for (size_t i = 0; i < n; ++i) {
+      const double q2 = q2s[i];
+      int nf = _fixflav;
+      if ( _flavorscheme != FIXED ) {
+        nf = _nfmin;
+        for (int it = itmin; it <= itmax; ++it)
+          if ( thresholds2[it] < q2 ) nf = it;
+        if ( _fixflav != -1 && nf > _fixflav ) nf = _fixflav;
+      }
+      if ( nf < 0 || nf > 6 ) { //< Not tabulated: the single-value method reports the problem
+        out[i] = AlphaS_Analytic::alphasQ2(q2);
+        continue;
+      }
+      if (!filled[nf]) {
+        lambdas[nf] = _lambdaQCD(nf);
+        for (int j = 0; j < 4; ++j) betas[nf][j] = _beta(j, nf);
+        filled[nf] = true;
+      }
+      out[i] = _alphasQ2(q2, lambdas[nf], betas[nf]);
+    }
+  }
+
+
+  // The analytic approximation itself, for fixed nf
+  double AlphaS_Analytic::_alphasQ2(double q2, double lambdaQCD, const double* beta) const {
     if (q2 <= lambdaQCD * lambdaQCD) return std::numeric_limits<double>::max();
 
-    // Get beta coeffs for the number of active (above threshold) quark flavours at energy Q
-    const std::vector<double> beta = _betas(nf);
     const double beta02 = sqr(beta[0]);
     const double beta12 = sqr(beta[1]);
 
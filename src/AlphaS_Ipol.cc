@@ -16,42 +16,71 @@ namespace LHAPDF {
   }
 
 
-  /// @note This is const so it can be called silently from a const method
-  void AlphaS_Ipol::_setup_grids() const {
-    if (!_knotarrays.empty())
-      throw LogicError("AlphaS interpolation subgrids being initialized a second time!");
-
-    if (_q2s.size() != _as.size())
-      throw MetadataError("AlphaS value and Q interpolation arrays are differently sized");
+  void AlphaS_Ipol::_setup_grids() {
+    // Inconsistent arrays, e.g. between setting the knots and the values, leave no tables: queries then throw
+    _logq2s.clear();
+    _dasdlogq2s.clear();
+    _lookupq2s.clear();
+    _iknots.clear();
+    _lookup = KnotLookup();
+    const size_t n = _q2s.size();
+    if (n < 2 || n != _as.size()) return;
+
+    // Walk along the Q2 vector, splitting it into increasing subgrids where a value is repeated.
+    // The inner copies of a knot repeated more than once are ignored.
+    vector< pair<size_t, size_t> > subgrids; //< first and last knot indices
+    size_t first = 0;
+    for (size_t i = 1; i < n; ++i) {
+      if (abs(_q2s[i] - _q2s[i-1]) < numeric_limits<double>::epsilon()) {
+        if (i-1 > first) subgrids.push_back(make_pair(first, i-1));
+        first = i;
+      } else if (!(_q2s[i] > _q2s[i-1])) {
+        return;
+      }
+    }
+    if (n-1 > first) subgrids.push_back(make_pair(first, n-1));
+    if (subgrids.empty()) return;
+
+    // Knot logs, and the derivatives at the knots: forward and backward at the subgrid edges, central inside
+    vector<double> logq2s(n), dasdlogq2s(n, 0.0);
+    for (size_t i = 0; i < n; ++i) logq2s[i] = log(_q2s[i]);
+    for (const pair<size_t, size_t>& sg : subgrids) {
+      for (size_t i = sg.first; i <= sg.second; ++i) {
+        const double forward = (i < sg.second) ? (_as[i+1] - _as[i]) / (logq2s[i+1] - logq2s[i]) : 0;
+        const double backward = (i > sg.first) ? (_as[i] - _as[i-1]) / (logq2s[i] - logq2s[i-1]) : 0;
+        dasdlogq2s[i] = (i == sg.first) ? forward : (i == sg.second) ? backward : 0.5 * (forward + backward);
+      }
+    }
 
-    // Walk along the Q2 vector, making subgrids at each boundary
-    double prevQ2 = _q2s.front();
-    vector<double> q2s, as;
-    size_t combined_lenq2s = 0; //< For consistency checking
-    for (size_t i = 0; i <= _q2s.size(); ++i) { //< The iteration to len+1 is intentional
-      // Get current Q2 and alpha_s points, faked if i > vector to force syncing
-      const double currQ2 = (i != _q2s.size()) ? _q2s[i] : _q2s.back();
-      const double currAS = (i != _q2s.size()) ? _as[i] : -1;
-      // If the Q2 value is repeated, sync the current subgrid and start a new one.
-      // Note special treatment for the first and last points in q2s.
-      if (abs(currQ2 - prevQ2) < numeric_limits<double>::epsilon()) {
-        // Sync current subgrid as as AlphaSArray
-        if (i != 0) {
-          _knotarrays[q2s.front()] = AlphaSArray(q2s, as);
-          combined_lenq2s += q2s.size();
+    // The distinct knots, each starting its interval in the higher subgrid at a boundary
+    vector<double> lookupq2s, lookuplogq2s;
+    vector<size_t> iknots;
+    for (const pair<size_t, size_t>& sg : subgrids) {
+      for (size_t i = sg.first; i <= sg.second; ++i) {
+        if (i == sg.first && !iknots.empty()) {
+          iknots.back() = i;
+          continue;
         }
-        // Reset temporary vectors
-        q2s.clear(); q2s.reserve(_q2s.size() - i);
-        as.clear(); as.reserve(_q2s.size() - i);
+        lookupq2s.push_back(_q2s[i]);
+        lookuplogq2s.push_back(logq2s[i]);
+        iknots.push_back(i);
       }
-      // Append current value to temporary vectors
-      q2s.push_back(currQ2);
-      as.push_back(currAS);
-      prevQ2 = currQ2;
     }
-    if (combined_lenq2s != _q2s.size())
-      throw AlphaSError("Sum of alpha_s subgrid sizes does not match input knot array ("
-                        + to_str(combined_lenq2s) + " vs. " + to_str(_q2s.size()) + ")");
+
+    // Log-log gradient for the extrapolation below the grid, using base 10 for
+    // logs to get constant gradient extrapolation in a log 10 - log 10 plot.
+    // Remember to take situations where the first knot also is a flavor threshold into account.
+    size_t next_point = 1;
+    while ( _q2s[0] == _q2s[next_point] ) next_point++;
+    const double dlogq2 = log10( _q2s[next_point] / _q2s[0] );
+    const double dlogas = log10( _as[next_point] / _as[0] );
+    _lowloggrad = dlogas / dlogq2;
+
+    _logq2s.swap(logq2s);
+    _dasdlogq2s.swap(dasdlogq2s);
+    _lookupq2s.swap(lookupq2s);
+    _iknots.swap(iknots);
+    _lookup = KnotLookup(_lookupq2s, lookuplogq2s);
   }
 
 
@@ -72,55 +101,46 @@ namespace LHAPDF {
   }
 
 
-  // Interpolate alpha_s from tabulated points in Q2 via metadata
-  double AlphaS_Ipol::alphasQ2(double q2) const {
-    assert(q2 >= 0);
-
-    // Using base 10 for logs to get constant gradient extrapolation in
-    // a log 10 - log 10 plot
-    if (q2 < _q2s.front()) {
-      // Remember to take situations where the first knot also is a
-      // flavor threshold into account
-      double dlogq2, dlogas;
-      unsigned int next_point = 1;
-      while ( _q2s[0] == _q2s[next_point] ) next_point++;
-      dlogq2  = log10( _q2s[next_point] / _q2s[0] );
-      dlogas  = log10( _as[next_point]  / _as[0]  );
-      const double loggrad = dlogas / dlogq2;
-      return _as[0] * pow( q2/_q2s[0] , loggrad );
-    }
-
+  // Interpolate alpha_s from the tables, which must be set up
+  inline double AlphaS_Ipol::_alphasQ2(double q2) const {
+    // Extrapolate below the grid with the log-log gradient of the first interval, and as constant above it
+    if (q2 < _q2s.front()) return _as.front() * pow( q2/_q2s.front() , _lowloggrad );
     if (q2 > _q2s.back()) return _as.back();
 
-    // If this is the first valid query, set up the ipol grids
-    if (_knotarrays.empty()) _setup_grids();
-
-    // Retrieve the appropriate subgrid
-    map<double, AlphaSArray>::const_iterator it = --(_knotarrays.upper_bound(q2));
-    const AlphaSArray& arr = it->second;
-
-    // Get the Q/alpha_s index on this array which is *below* this Q point
-    const size_t i = arr.iq2below(q2);
-
-    // Calculate derivatives
-    double didlogq2, di1dlogq2;
-    if ( i == 0 ) {
-      didlogq2 = arr.ddlogq_forward(i);
-      di1dlogq2 = arr.ddlogq_central(i+1);
-    } else if ( i == arr.logq2s().size()-2 ) {
-      didlogq2 = arr.ddlogq_central(i);
-      di1dlogq2 = arr.ddlogq_backward(i+1);
-    } else {
-      didlogq2 = arr.ddlogq_central(i);
-      di1dlogq2 = arr.ddlogq_central(i+1);
-    }
+    // Find the interval, with the flat Q/alpha_s index *below* this Q point
+    const double logq2 = log(q2);
+    const size_t i = _iknots[_lookup.ibelow(_lookupq2s, q2, logq2)];
 
     // Calculate alpha_s
-    const double dlogq2 = arr.logq2s()[i+1] - arr.logq2s()[i];
-    const double tlogq2 = (log(q2) - arr.logq2s()[i]) / dlogq2;
+    const double dlogq2 = _logq2s[i+1] - _logq2s[i];
+    const double tlogq2 = (logq2 - _logq2s[i]) / dlogq2;
     return _interpolateCubic( tlogq2,
-                              arr.alphas()[i], didlogq2*dlogq2,
-                              arr.alphas()[i+1], di1dlogq2*dlogq2 );
+                              _as[i], _dasdlogq2s[i]*dlogq2,
+                              _as[i+1], _dasdlogq2s[i+1]*dlogq2 );
+  }
+
+
+  void AlphaS_Ipol::_throwNoGrids() const {
+    if (_q2s.size() != _as.size())
+      throw MetadataError("AlphaS value and Q interpolation arrays are differently sized");
+    throw AlphaSError("AlphaS interpolation subgrids could not be set up from the knot array");
+  }
+
+
+  // Interpolate alpha_s from tabulated points in Q2 via metadata
+  double AlphaS_Ipol::alphasQ2(double q2) const {
+    assert(q2 >= 0);
+    // The tables are set up with the arrays, so are only missing if those are inconsistent
+    if (_iknots.empty()) _throwNoGrids();
+    return _alphasQ2(q2);
+  }
+
+
+  // Interpolate alpha_s at many scales
+  void AlphaS_Ipol::alphasQ2(const double* q2s, double* out, size_t n) const {
+    if (n == 0) return;
+    if (_iknots.empty()) _throwNoGrids();
+    for (size_t i = 0; i < n; ++i) out[i] = _alphasQ2(q2s[i]);
   }
 
 
@@ -5,10 +5,129 @@
 //
 #include "LHAPDF/AlphaS.h"
 #include "LHAPDF/Utils.h"
+#include "LHAPDF/Paths.h"
+#include "LHAPDF/Config.h"
+#include "LHAPDF/Version.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace LHAPDF {
 
 
+  namespace { // Unnamed namespace
+
+    // Dormand-Prince 5(4) coefficients, with the error estimate and dense
+    // output coefficients as in DOPRI5 by Hairer, Norsett and Wanner
+    const double A21 = 1/5.;
+    const double A31 = 3/40., A32 = 9/40.;
+    const double A41 = 44/45., A42 = -56/15., A43 = 32/9.;
+    const double A51 = 19372/6561., A52 = -25360/2187., A53 = 64448/6561., A54 = -212/729.;
+    const double A61 = 9017/3168., A62 = -355/33., A63 = 46732/5247., A64 = 49/176., A65 = -5103/18656.;
+    const double B1 = 35/384., B3 = 500/1113., B4 = 125/192., B5 = -2187/6784., B6 = 11/84.;
+    const double E1 = 71/57600., E3 = -71/16695., E4 = 71/1920., E5 = -17253/339200., E6 = 22/525., E7 = -1/40.;
+    const double D1 = -12715105075/11282082432., D3 = 87487479700/32700410799., D4 = -10690763975/1880347072.;
+    const double D5 = 701980252875/199316789632., D6 = -1453857185/822651844., D7 = 69997945/29380423.;
+
+    // Derivative d(alpha_s)/dlog(Q2) for the given beta coefficients, zero beyond the QCD order
+    inline double _dydu(double y, const double* bs) {
+      return -y*y*(bs[0] + y*(bs[1] + y*(bs[2] + y*(bs[3] + y*bs[4]))));
+    }
+
+
+    // Identifier and byte order tag of the cached alpha_s table files
+    const char ASCACHE_MAGIC[4] = { 'L', 'H', 'A', 'S' };
+    const uint32_t ASCACHE_ENDIANTAG = 0x01020304;
+
+    // 64-bit FNV-1a hash of @a n bytes, continuing from @a h
+    inline uint64_t _fnv1a(const void* data, size_t n, uint64_t h=14695981039346656037ULL) {
+      const unsigned char* c = (const unsigned char*) data;
+      for (size_t i = 0; i < n; ++i) h = (h ^ c[i]) * 1099511628211ULL;
+      return h;
+    }
+
+    // Path of the cache file for the given parameters and Q2 knots
+    string _cacheFilePath(const string& cachedir, const string& params, const vector<double>& q2s) {
+      const uint64_t h = _fnv1a(q2s.data(), 8*q2s.size(), _fnv1a(params.data(), params.size()));
+      char hex[17];
+      snprintf(hex, sizeof(hex), "%016llx", (unsigned long long) h);
+      return cachedir / "alphas-" + string(hex) + ".lhas";
+    }
+
+    // Read the alpha_s values cached at @a path, if written for exactly these parameters and Q2 knots
+    bool _readCache(const string& path, const string& params, const vector<double>& q2s, vector<double>& alphas) {
+      ifstream file(path.c_str(), ios::binary);
+      if (!file) return false;
+      char magic[4];
+      uint32_t endiantag = 0;
+      uint64_t nparams = 0, nknots = 0;
+      file.read(magic, 4);
+      file.read((char*) &endiantag, 4);
+      file.read((char*) &nparams, 8);
+      if (!file || memcmp(magic, ASCACHE_MAGIC, 4) != 0 || endiantag != ASCACHE_ENDIANTAG) return false;
+      if (nparams != params.size()) return false;
+      string fileparams(nparams, ' ');
+      file.read(&fileparams[0], nparams);
+      file.read((char*) &nknots, 8);
+      if (!file || fileparams != params || nknots != q2s.size()) return false;
+      vector<double> fileq2s(nknots), fileas(nknots);
+      file.read((char*) fileq2s.data(), 8*nknots);
+      file.read((char*) fileas.data(), 8*nknots);
+      if (!file || fileq2s != q2s) return false;
+      alphas.swap(fileas);
+      return true;
+    }
+
+    // Write the alpha_s values to the cache at @a path
+    //
+    // The table is written to a uniquely-named temporary file in the same
+    // directory and renamed into place, so that concurrent readers, in this or
+    // other processes, see either no file or a complete one. The cache is an
+    // optimisation only: failures are ignored, with a warning if verbose.
+    void _writeCache(const string& path, const string& params, const vector<double>& q2s, const vector<double>& alphas) {
+      const string dir = dirname(path);
+      if (!dir_exists(dir) && mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+        if (verbosity() > 0) cerr << "WARNING: Could not create the alpha_s cache directory " << dir << endl;
+        return;
+      }
+      string tmppath = path + ".XXXXXX";
+      const int fd = mkstemp(&tmppath[0]);
+      if (fd < 0) {
+        if (verbosity() > 0) cerr << "WARNING: Could not write to the alpha_s cache directory " << dir << endl;
+        return;
+      }
+      fchmod(fd, 0644); //< mkstemp makes the file private, but a cache directory may be shared
+      const uint64_t nparams = params.size(), nknots = q2s.size();
+      bool ok = true;
+      FILE* file = fdopen(fd, "wb");
+      if (file) {
+        ok &= fwrite(ASCACHE_MAGIC, 4, 1, file) == 1;
+        ok &= fwrite(&ASCACHE_ENDIANTAG, 4, 1, file) == 1;
+        ok &= fwrite(&nparams, 8, 1, file) == 1;
+        ok &= fwrite(params.data(), 1, nparams, file) == nparams;
+        ok &= fwrite(&nknots, 8, 1, file) == 1;
+        ok &= fwrite(q2s.data(), 8, nknots, file) == nknots;
+        ok &= fwrite(alphas.data(), 8, nknots, file) == nknots;
+        ok &= fflush(file) == 0 && fsync(fd) == 0;
+        ok &= fclose(file) == 0;
+      } else {
+        close(fd);
+        ok = false;
+      }
+      if (!ok || rename(tmppath.c_str(), path.c_str()) != 0) {
+        remove(tmppath.c_str());
+        if (verbosity() > 0) cerr << "WARNING: Could not write the alpha_s cache file " << path << endl;
+      }
+    }
+
+  }
+
+
   void AlphaS_ODE::setQValues(const std::vector<double>& qs) {
     vector<double> q2s;
     for (double q : qs) q2s.push_back(q*q);
@@ -133,8 +252,11 @@ namespace LHAPDF {
   /// Interpolate to get Alpha_S if the ODE has been solved,
   /// otherwise solve ODE from scratch
   double AlphaS_ODE::alphasQ2(double q2) const {
-    // Tabulate ODE solutions for interpolation and return interpolated value
-    _interpolate();
+    // Tabulate ODE solutions for interpolation, once only, and return interpolated value
+    if (!_calculated.load(memory_order_acquire)) {
+      lock_guard<mutex> lock(_calcmutex);
+      if (!_calculated.load(memory_order_relaxed)) _interpolate();
+    }
     return _ipol.alphasQ2(q2);
     // // Or directly return the ODE result (for testing)
     // double h = 2;
@@ -148,30 +270,18 @@ namespace LHAPDF {
   }
 
 
-  // Solve the differential equation in alphaS using an implementation of RK4
-  void AlphaS_ODE::_interpolate() const {
-    if ( _calculated ) return;
-
-    // Initial step size
-    double h = 2.0;
-    /// This the the relative error allowed for the adaptive step size.
-    const double allowed_relative = 0.01;
-
-    /// Accuracy of Q2 (error in Q2 within this / 2)
-    double accuracy = 0.001;
-
-    // Run in Q2 using RK4 algorithm until we are within our defined accuracy
-    double t;
-    double y;
-
-    if (_customref) {
-      t = sqr(_mreference); // starting point
-      y = _alphas_reference; // starting value
-    } else {
-      t = sqr(_mz); // starting point
-      y = _alphas_mz; // starting value
+  // Interpolate many values, solving the ODE first if needed
+  void AlphaS_ODE::alphasQ2(const double* q2s, double* out, size_t n) const {
+    if (!_calculated.load(memory_order_acquire)) {
+      lock_guard<mutex> lock(_calcmutex);
+      if (!_calculated.load(memory_order_relaxed)) _interpolate();
     }
+    _ipol.alphasQ2(q2s, out, n);
+  }
+
 
+  // Solve the differential equation in alphaS and tabulate it for interpolation
+  void AlphaS_ODE::_interpolate() const {
     // If a vector of knots in q2 has been given, solve for those.
     // This creates a default grid which should be overkill for most
     // purposes
@@ -209,6 +319,69 @@ namespace LHAPDF {
     // use it)
     if ( _q2s[_q2s.size()-1] < sqr(_mz) ) _q2s.push_back(sqr(_mz));
 
+    // Load the solution from the cache directory if enabled and already there, or solve and store it
+    vector<double> alphas;
+    const string cachedir = cachePath();
+    if (cachedir.empty()) {
+      alphas = (_solver == DOPRI5) ? _tabulateDoPri5() : _tabulateRK4();
+    } else {
+      const string params = _cacheParams();
+      const string cachefile = _cacheFilePath(cachedir, params, _q2s);
+      if (!_readCache(cachefile, params, _q2s, alphas)) {
+        alphas = (_solver == DOPRI5) ? _tabulateDoPri5() : _tabulateRK4();
+        _writeCache(cachefile, params, _q2s, alphas);
+      }
+    }
+    _ipol.setQ2Values(_q2s);
+    _ipol.setAlphaSValues(alphas);
+
+    _calculated.store(true, memory_order_release);
+  }
+
+
+  // All the parameters which determine the tabulated solution, apart from the
+  // Q2 knots, written exactly, for the identification of cached tables
+  string AlphaS_ODE::_cacheParams() const {
+    ostringstream ss;
+    ss.precision(17);
+    ss << "LHAPDF " << version() << "\n"
+       << "Solver " << ((_solver == DOPRI5) ? "dopri5" : "rk4") << "\n"
+       << "OrderQCD " << _qcdorder << "\n"
+       << "MZ " << _mz << "\n"
+       << "AlphaS_MZ " << _alphas_mz << "\n";
+    if (_customref) ss << "Reference " << _mreference << " " << _alphas_reference << "\n";
+    ss << "FlavorScheme " << ((_flavorscheme == FIXED) ? "fixed " : "variable ") << _fixflav << "\n";
+    ss << "Masses";
+    for (const pair<const int, double>& id_m : _quarkmasses) ss << " " << id_m.first << ":" << id_m.second;
+    ss << "\nThresholds";
+    for (const pair<const int, double>& id_m : _flavorthresholds) ss << " " << id_m.first << ":" << id_m.second;
+    ss << "\n";
+    return ss.str();
+  }
+
+
+  // Solve the differential equation in alphaS using an implementation of RK4
+  vector<double> AlphaS_ODE::_tabulateRK4() const {
+    // Initial step size
+    double h = 2.0;
+    /// This the the relative error allowed for the adaptive step size.
+    const double allowed_relative = 0.01;
+
+    /// Accuracy of Q2 (error in Q2 within this / 2)
+    double accuracy = 0.001;
+
+    // Run in Q2 using RK4 algorithm until we are within our defined accuracy
+    double t;
+    double y;
+
+    if (_customref) {
+      t = sqr(_mreference); // starting point
+      y = _alphas_reference; // starting value
+    } else {
+      t = sqr(_mz); // starting point
+      y = _alphas_mz; // starting value
+    }
+
     // Find the index of the knot right below m_{Z}
     unsigned int index_of_mz_lower = 0;
 
@@ -312,10 +485,106 @@ namespace LHAPDF {
        alphas.push_back(grid.at(x).second);
     }
 
-    _ipol.setQ2Values(_q2s);
-    _ipol.setAlphaSValues(alphas);
+    return alphas;
+  }
+
+
+  // Solve the differential equation in alphaS with an adaptive Dormand-Prince integration
+  vector<double> AlphaS_ODE::_tabulateDoPri5() const {
+    const double t = _customref ? sqr(_mreference) : sqr(_mz); // starting point
+    const double y = _customref ? _alphas_reference : _alphas_mz; // starting value
+    vector<double> alphas(_q2s.size());
+    // Sweep down through the knots below the starting point, then up through the others
+    const int nbelow = lower_bound(_q2s.begin(), _q2s.end(), t) - _q2s.begin();
+    _sweepDoPri5(nbelow - 1, -1, -1, t, y, alphas);
+    _sweepDoPri5(nbelow, _q2s.size(), 1, t, y, alphas);
+    return alphas;
+  }
+
 
-    _calculated = true;
+  void AlphaS_ODE::_sweepDoPri5(int first, int end, int dir, double t, double y, vector<double>& alphas) const {
+    // Tolerances on alpha_s, and maximum step in log(Q2)
+    const double RTOL = 1e-10, ATOL = 1e-12, HMAX = 1.0;
+
+    // Integrate in u = log(Q2), in which the ODE is autonomous: d(alpha_s)/du = -sum_i beta_i alpha_s^(i+2)
+    double u = log(t), h = dir*0.1;
+    int nf = -1;
+    double bs[5] = { 0, 0, 0, 0, 0 };
+    int i = first;
+    while (i != end) {
+      // The segment of knots up to the next flavor threshold, i.e. the first of a pair of equal knots, or to the last one
+      int j = i;
+      while (j + dir != end && _q2s[j+dir] != _q2s[j]) j += dir;
+      const double tend = _q2s[j], uend = log(tend);
+
+      // Beta coefficients for the number of flavors inside the segment, precomputed once per flavor number
+      const int nfseg = numFlavorsQ2(t != tend ? sqrt(t*tend) : t);
+      if (nfseg != nf) {
+        nf = nfseg;
+        for (int ib = 0; ib < 5; ++ib) bs[ib] = (ib < _qcdorder) ? _beta(ib, nf) : 0;
+      }
+
+      // Adaptive steps to the end of the segment, filling the knots passed from the dense output
+      double k1 = _dydu(y, bs);
+      int k = i;
+      bool diverged = false;
+      while (dir*(uend - u) > 0) {
+        const bool last = dir*(u + h - uend) >= 0;
+        const double hs = last ? uend - u : h;
+        const double k2 = _dydu(y + hs*A21*k1, bs);
+        const double k3 = _dydu(y + hs*(A31*k1 + A32*k2), bs);
+        const double k4 = _dydu(y + hs*(A41*k1 + A42*k2 + A43*k3), bs);
+        const double k5 = _dydu(y + hs*(A51*k1 + A52*k2 + A53*k3 + A54*k4), bs);
+        const double k6 = _dydu(y + hs*(A61*k1 + A62*k2 + A63*k3 + A64*k4 + A65*k5), bs);
+        const double ynew = y + hs*(B1*k1 + B3*k3 + B4*k4 + B5*k5 + B6*k6);
+        const double k7 = _dydu(ynew, bs);
+        const double err = fabs(hs*(E1*k1 + E3*k3 + E4*k4 + E5*k5 + E6*k6 + E7*k7)) / (ATOL + RTOL*max(fabs(y), fabs(ynew)));
+        const double fac = (err > 0) ? min(5.0, max(0.2, 0.9*pow(err, -0.2))) : 5.0;
+
+        // Retry a rejected step with a smaller size, giving up if the solution blows up
+        if (!(err <= 1)) {
+          h = hs * ((err > 1) ? fac : 0.2);
+          if (fabs(h) < 1e-8) { diverged = true; break; }
+          continue;
+        }
+
+        // Dense output at the knots passed by the accepted step
+        const double unew = last ? uend : u + hs;
+        if (k != j && dir*(log(_q2s[k]) - unew) <= 0) {
+          const double ydiff = ynew - y, bspl = hs*k1 - ydiff;
+          const double r4 = ydiff - hs*k7 - bspl, r5 = hs*(D1*k1 + D3*k3 + D4*k4 + D5*k5 + D6*k6 + D7*k7);
+          for (; k != j && dir*(log(_q2s[k]) - unew) <= 0; k += dir) {
+            const double th = (log(_q2s[k]) - u)/hs, th1 = 1 - th;
+            alphas[k] = y + th*(ydiff + th1*(bspl + th*(r4 + th1*r5)));
+          }
+        }
+        u = unew;
+        y = ynew;
+        k1 = k7;
+        if (!last) h = dir*min(HMAX, fabs(hs)*fac);
+        // Define divergence after y > 2. -- we have no accuracy after that any way
+        if (y > 2.) { diverged = true; break; }
+      }
+      if (diverged) {
+        for (; k != end; k += dir) alphas[k] = std::numeric_limits<double>::max();
+        return;
+      }
+      alphas[j] = y;
+      t = tend;
+      if (j + dir == end) break;
+
+      // At a flavor threshold the second knot of the pair takes the value decoupled to the next segment's flavors
+      if (j + 2*dir != end) {
+        const int nfnext = numFlavorsQ2(sqrt(tend*_q2s[j+2*dir]));
+        y *= _decouple(y, tend, nf, nfnext);
+      }
+      alphas[j+dir] = y;
+      i = j + 2*dir;
+      if (y > 2.) {
+        for (; i != end; i += dir) alphas[i] = std::numeric_limits<double>::max();
+        return;
+      }
+    }
   }
 
 
@@ -4,7 +4,9 @@
 // Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
 //
 #include "LHAPDF/BicubicInterpolator.h"
+#include "LHAPDF/GridEvaluator.h"
 #include <iostream>
+#include <new>
 
 namespace LHAPDF {
 
@@ -18,19 +20,29 @@ namespace LHAPDF {
       return yl + (x - xl) / (xh - xl) * (yh - yl);
     }
 
-    // One-dimensional cubic interpolation
-    inline double _interpolateCubic(double T, double VL, double VDL, double VH, double VDH) {
-      // Pre-calculate powers of T
-      const double t2 = T*T;
-      const double t3 = t2*T;
+    // Cubic Hermite basis function values at T, shared by all the flavors interpolated at a point
+    struct _HermiteWeights {
+      _HermiteWeights(double T=0) {
+        // Pre-calculate powers of T
+        const double t2 = T*T;
+        const double t3 = t2*T;
+        h00 = 2*t3 - 3*t2 + 1;
+        h10 = t3 - 2*t2 + T;
+        h01 = -2*t3 + 3*t2;
+        h11 = t3 - t2;
+      }
+      double h00, h10, h01, h11;
+    };
 
+    // One-dimensional cubic interpolation
+    inline double _interpolateCubic(const _HermiteWeights& w, double VL, double VDL, double VH, double VDH) {
       // Calculate left point
-      const double p0 = (2*t3 - 3*t2 + 1)*VL;
-      const double m0 = (t3 - 2*t2 + T)*VDL;
+      const double p0 = w.h00*VL;
+      const double m0 = w.h10*VDL;
 
       // Calculate right point
-      const double p1 = (-2*t3 + 3*t2)*VH;
-      const double m1 = (t3 - t2)*VDH;
+      const double p1 = w.h01*VH;
+      const double m1 = w.h11*VDH;
 
       return p0 + m0 + p1 + m1;
     }
@@ -50,77 +62,173 @@ namespace LHAPDF {
       }
     }
 
+
+
+    /// Check that the subgrid has enough knots for bicubic interpolation, or its bilinear fallback
+    void _checkKnots(const KnotArray1F& subgrid) {
+      if (subgrid.xsize() < 4)
+        throw GridError("PDF subgrids are required to have at least 4 x-knots for use with BicubicInterpolator");
+      if (subgrid.q2size() < 2)
+        throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with BicubicInterpolator");
+    }
+
+
+    /// Position of a point in its (ix, iq2) cell and the interpolation weights, shared by all flavors with the same knots
+    struct _CellWeights {
+      _CellWeights(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2)
+        : x(x), q2(q2), ix(ix), iq2(iq2), cubic(subgrid.q2size() >= 4)
+      {
+        if (!cubic) return; //< the bilinear fallback uses x and Q2 directly
+
+        /// @todo Allow interpolation right up to the borders of the grid in Q2 and x... the last inter-knot range is currently broken
+
+        /// @todo Also treat the x top/bottom edges carefully, cf. the Q2 ones
+
+        // Distance parameters
+        const vector<double>& xs = subgrid.xs();
+        const vector<double>& q2s = subgrid.q2s();
+        dx = xs[ix+1] - xs[ix];
+        hx = _HermiteWeights((x - xs[ix]) / dx);
+        dq_0 = (iq2 != 0) ? q2s[iq2] - q2s[iq2-1] : -1; //< Don't evaluate (or use) if iq2-1 < 0
+        dq_1 = q2s[iq2+1] - q2s[iq2];
+        dq_2 = (iq2+2 < q2s.size()) ? q2s[iq2+2] - q2s[iq2+1] : -1; //< Don't evaluate (or use) if iq2+2 is off the end
+        hq = _HermiteWeights((q2 - q2s[iq2]) / dq_1);
+      }
+      double x, q2;
+      size_t ix, iq2;
+      bool cubic;
+      double dx, dq_0, dq_1, dq_2;
+      _HermiteWeights hx, hq;
+    };
+
+
+    /// Interpolate a single flavor at a point with precalculated cell weights
+    double _interpolateCell(const KnotArray1F& subgrid, const _CellWeights& w, bool precomputed) {
+      const size_t ix = w.ix, iq2 = w.iq2;
+      if (!w.cubic) {
+        // Fallback to BilinearInterpolator if either 2 or 3 Q2-knots
+        // First interpolate in x
+        const double f_ql = _interpolateLinear(w.x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
+        const double f_qh = _interpolateLinear(w.x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
+        // Then interpolate in Q2, using the x-ipol results as anchor points
+        return _interpolateLinear(w.q2, subgrid.q2s()[iq2], subgrid.q2s()[iq2+1], f_ql, f_qh);
+      }
+
+      const double dx = w.dx;
+
+      // With precomputed knot derivatives, interpolate the values and the Q2 derivatives in x, then in Q2
+      if (precomputed && subgrid.hasGradients(false)) {
+        const double dq = w.dq_1;
+        const double vl = _interpolateCubic(w.hx, subgrid.xf(ix, iq2), subgrid.dxf_dx(ix, iq2) * dx,
+                                                  subgrid.xf(ix+1, iq2), subgrid.dxf_dx(ix+1, iq2) * dx);
+        const double vh = _interpolateCubic(w.hx, subgrid.xf(ix, iq2+1), subgrid.dxf_dx(ix, iq2+1) * dx,
+                                                  subgrid.xf(ix+1, iq2+1), subgrid.dxf_dx(ix+1, iq2+1) * dx);
+        const double vdl = _interpolateCubic(w.hx, subgrid.dxf_dq2(ix, iq2), subgrid.d2xf_dxdq2(ix, iq2) * dx,
+                                                   subgrid.dxf_dq2(ix+1, iq2), subgrid.d2xf_dxdq2(ix+1, iq2) * dx);
+        const double vdh = _interpolateCubic(w.hx, subgrid.dxf_dq2(ix, iq2+1), subgrid.d2xf_dxdq2(ix, iq2+1) * dx,
+                                                   subgrid.dxf_dq2(ix+1, iq2+1), subgrid.d2xf_dxdq2(ix+1, iq2+1) * dx);
+        return _interpolateCubic(w.hq, vl, vdl * dq, vh, vdh * dq);
+      }
+      const double dq_0 = w.dq_0, dq_1 = w.dq_1, dq_2 = w.dq_2;
+      const double dq = dq_1;
+
+      // Points in Q2
+      double vl = _interpolateCubic(w.hx, subgrid.xf(ix, iq2), _ddx(subgrid, ix, iq2) * dx,
+                                          subgrid.xf(ix+1, iq2), _ddx(subgrid, ix+1, iq2) * dx);
+      double vh = _interpolateCubic(w.hx, subgrid.xf(ix, iq2+1), _ddx(subgrid, ix, iq2+1) * dx,
+                                          subgrid.xf(ix+1, iq2+1), _ddx(subgrid, ix+1, iq2+1) * dx);
+
+      // Derivatives in Q2
+      double vdl, vdh;
+      if (iq2 == 0) {
+        // Forward difference for lower q
+        vdl = (vh - vl) / dq_1;
+        // Central difference for higher q
+        double vhh = _interpolateCubic(w.hx, subgrid.xf(ix, iq2+2), _ddx(subgrid, ix, iq2+2) * dx,
+                                             subgrid.xf(ix+1, iq2+2), _ddx(subgrid, ix+1, iq2+2) * dx);
+        vdh = (vdl + (vhh - vh)/dq_2) / 2.0;
+      }
+      else if (iq2+1 == subgrid.q2s().size()-1) {
+        // Backward difference for higher q
+        vdh = (vh - vl) / dq_1;
+        // Central difference for lower q
+        double vll = _interpolateCubic(w.hx, subgrid.xf(ix, iq2-1), _ddx(subgrid, ix, iq2-1) * dx,
+                                             subgrid.xf(ix+1, iq2-1), _ddx(subgrid, ix+1, iq2-1) * dx);
+        vdl = (vdh + (vl - vll)/dq_0) / 2.0;
+      }
+      else {
+        // Central difference for both q
+        double vll = _interpolateCubic(w.hx, subgrid.xf(ix, iq2-1), _ddx(subgrid, ix, iq2-1) * dx,
+                                             subgrid.xf(ix+1, iq2-1), _ddx(subgrid, ix+1, iq2-1) * dx);
+        vdl = ( (vh - vl)/dq_1 + (vl - vll)/dq_0 ) / 2.0;
+        double vhh = _interpolateCubic(w.hx, subgrid.xf(ix, iq2+2), _ddx(subgrid, ix, iq2+2) * dx,
+                                             subgrid.xf(ix+1, iq2+2), _ddx(subgrid, ix+1, iq2+2) * dx);
+        vdh = ( (vh - vl)/dq_1 + (vhh - vh)/dq_2 ) / 2.0;
+      }
+
+      vdl *= dq;
+      vdh *= dq;
+
+      return _interpolateCubic(w.hq, vl, vdl, vh, vdh);
+    }
   }
 
 
 
+  void BicubicInterpolator::prepare(KnotArray1F& subgrid) const {
+    if (_precomputed && subgrid.xsize() > 1 && subgrid.q2size() > 1)
+      subgrid.computeGradients(false);
+  }
+
+
   double BicubicInterpolator::_interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const {
-    if (subgrid.logxs().size() < 4)
-      throw GridError("PDF subgrids are required to have at least 4 x-knots for use with BicubicInterpolator");
-    if (subgrid.logq2s().size() < 4) {
-      if (subgrid.logq2s().size() > 1) {
-	// Fallback to BilinearInterpolator if either 2 or 3 Q2-knots
-	// First interpolate in x
-	const double f_ql = _interpolateLinear(x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
-	const double f_qh = _interpolateLinear(x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
-	// Then interpolate in Q2, using the x-ipol results as anchor points
-	return _interpolateLinear(q2, subgrid.q2s()[iq2], subgrid.q2s()[iq2+1], f_ql, f_qh);
-      } else throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with BicubicInterpolator");
-    }
+    _checkKnots(subgrid);
+    return _interpolateCell(subgrid, _CellWeights(subgrid, x, ix, q2, iq2), _precomputed);
+  }
 
-    /// @todo Allow interpolation right up to the borders of the grid in Q2 and x... the last inter-knot range is currently broken
-
-    /// @todo Also treat the x top/bottom edges carefully, cf. the Q2 ones
-
-    // Distance parameters
-    const double dx = subgrid.xs()[ix+1] - subgrid.xs()[ix];
-    const double tx = (x - subgrid.xs()[ix]) / dx;
-    /// @todo Only compute these if the +1 and +2 indices are guaranteed to be valid
-    const double dq_0 = subgrid.q2s()[iq2] - subgrid.q2s()[iq2-1];
-    const double dq_1 = subgrid.q2s()[iq2+1] - subgrid.q2s()[iq2];
-    const double dq_2 = subgrid.q2s()[iq2+2] - subgrid.q2s()[iq2+1];
-    const double dq = dq_1;
-    const double tq = (q2 - subgrid.q2s()[iq2]) / dq;
-
-    // Points in Q2
-    double vl = _interpolateCubic(tx, subgrid.xf(ix, iq2), _ddx(subgrid, ix, iq2) * dx,
-                                      subgrid.xf(ix+1, iq2), _ddx(subgrid, ix+1, iq2) * dx);
-    double vh = _interpolateCubic(tx, subgrid.xf(ix, iq2+1), _ddx(subgrid, ix, iq2+1) * dx,
-                                      subgrid.xf(ix+1, iq2+1), _ddx(subgrid, ix+1, iq2+1) * dx);
-
-    // Derivatives in Q2
-    double vdl, vdh;
-    if (iq2 == 0) {
-      // Forward difference for lower q
-      vdl = (vh - vl) / dq_1;
-      // Central difference for higher q
-      double vhh = _interpolateCubic(tx, subgrid.xf(ix, iq2+2), _ddx(subgrid, ix, iq2+2) * dx,
-                                         subgrid.xf(ix+1, iq2+2), _ddx(subgrid, ix+1, iq2+2) * dx);
-      vdh = (vdl + (vhh - vh)/dq_2) / 2.0;
-    }
-    else if (iq2+1 == subgrid.q2s().size()-1) {
-      // Backward difference for higher q
-      vdh = (vh - vl) / dq_1;
-      // Central difference for lower q
-      double vll = _interpolateCubic(tx, subgrid.xf(ix, iq2-1), _ddx(subgrid, ix, iq2-1) * dx,
-                                         subgrid.xf(ix+1, iq2-1), _ddx(subgrid, ix+1, iq2-1) * dx);
-      vdl = (vdh + (vl - vll)/dq_0) / 2.0;
-    }
-    else {
-      // Central difference for both q
-      double vll = _interpolateCubic(tx, subgrid.xf(ix, iq2-1), _ddx(subgrid, ix, iq2-1) * dx,
-                                         subgrid.xf(ix+1, iq2-1), _ddx(subgrid, ix+1, iq2-1) * dx);
-      vdl = ( (vh - vl)/dq_1 + (vl - vll)/dq_0 ) / 2.0;
-      double vhh = _interpolateCubic(tx, subgrid.xf(ix, iq2+2), _ddx(subgrid, ix, iq2+2) * dx,
-                                         subgrid.xf(ix+1, iq2+2), _ddx(subgrid, ix+1, iq2+2) * dx);
-      vdh = ( (vh - vl)/dq_1 + (vhh - vh)/dq_2 ) / 2.0;
+
+  void BicubicInterpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                              double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    // The flavors share the knots, so the checks and weights are computed once
+    _checkKnots(*subgrids[0]);
+    const _CellWeights w(*subgrids[0], x, ix, q2, iq2);
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _interpolateCell(*subgrids[j], w, _precomputed);
+  }
+
+
+  bool BicubicInterpolator::_stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const {
+    _checkKnots(subgrid);
+    const size_t ix = subgrid.ixbelow(x), iq2 = subgrid.iq2below(q2);
+    if (subgrid.q2size() < 4) {
+      // Fallback to bilinear interpolation if either 2 or 3 Q2-knots
+      linearStencil(subgrid.xs(), ix, x, sx);
+      linearStencil(subgrid.q2s(), iq2, q2, sq);
+    } else {
+      cubicStencil(subgrid.xs(), ix, x, sx);
+      cubicStencil(subgrid.q2s(), iq2, q2, sq);
     }
+    return true;
+  }
 
-    vdl *= dq;
-    vdh *= dq;
 
-    return _interpolateCubic(tq, vl, vdl, vh, vdh);
+  void BicubicInterpolator::_cellWeights(const KnotArray1F& subgrid, CellWeights& w) const {
+    _checkKnots(subgrid);
+    w.ix = subgrid.ixbelow(w.x);
+    w.iq2 = subgrid.iq2below(w.q2);
+    new (w.data<_CellWeights>()) _CellWeights(subgrid, w.x, w.ix, w.q2, w.iq2);
   }
 
 
+  double BicubicInterpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    return _interpolateCell(subgrid, *w.data<_CellWeights>(), _precomputed);
+  }
+
+
+  // Compile the devirtualised evaluators for this interpolator here, so that its kernel can be inlined into them
+  template class GridEvaluator<BicubicInterpolator, ErrExtrapolator>;
+  template class GridEvaluator<BicubicInterpolator, NearestPointExtrapolator>;
+  template class GridEvaluator<BicubicInterpolator, ContinuationExtrapolator>;
+
+
 }
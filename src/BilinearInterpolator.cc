@@ -4,33 +4,98 @@
 // Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
 //
 #include "LHAPDF/BilinearInterpolator.h"
+#include "LHAPDF/GridEvaluator.h"
 
 namespace LHAPDF {
 
 
   namespace { // Unnamed namespace
 
-    // One-dimensional linear interpolation for y(x)
-    inline double _interpolateLinear(double x, double xl, double xh, double yl, double yh)	{
+    /// The x and Q2 weights of a point in its cell, as stored by the query cache
+    struct _LinearWeights {
+      double tx, tq;
+    };
+
+    // Weight of the upper point in one-dimensional linear interpolation for y(x)
+    inline double _linearWeight(double x, double xl, double xh) {
       assert(x >= xl);
       assert(xh >= x);
-      return yl + (x - xl) / (xh - xl) * (yh - yl);
+      return (x - xl) / (xh - xl);
+    }
+
+    // One-dimensional linear interpolation for y(x), given the upper-point weight
+    inline double _interpolateLinear(double t, double yl, double yh) {
+      return yl + t * (yh - yl);
+    }
+
+    /// Check that the subgrid has enough knots for bilinear interpolation
+    void _checkKnots(const KnotArray1F& subgrid) {
+      if (subgrid.logxs().size() < 2)
+        throw GridError("PDF subgrids are required to have at least 2 x-knots for use with BilinearInterpolator");
+      if (subgrid.logq2s().size() < 2)
+        throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with BilinearInterpolator");
+    }
+
+    /// Interpolate a single flavor, given the x and Q2 weights in the (ix, iq2) cell
+    inline double _interpolateCell(const KnotArray1F& subgrid, size_t ix, size_t iq2, double tx, double tq) {
+      // First interpolate in x
+      const double f_ql = _interpolateLinear(tx, subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
+      const double f_qh = _interpolateLinear(tx, subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
+      // Then interpolate in Q2, using the x-ipol results as anchor points
+      return _interpolateLinear(tq, f_ql, f_qh);
     }
 
   }
 
 
   double BilinearInterpolator::_interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const {
-    if (subgrid.logxs().size() < 2)
-      throw GridError("PDF subgrids are required to have at least 2 x-knots for use with BilinearInterpolator");
-    if (subgrid.logq2s().size() < 2)
-      throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with BilinearInterpolator");
-    // First interpolate in x
-    const double f_ql = _interpolateLinear(x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
-    const double f_qh = _interpolateLinear(x, subgrid.xs()[ix], subgrid.xs()[ix+1], subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
-    // Then interpolate in Q2, using the x-ipol results as anchor points
-    return _interpolateLinear(q2, subgrid.q2s()[iq2], subgrid.q2s()[iq2+1], f_ql, f_qh);
+    _checkKnots(subgrid);
+    const double tx = _linearWeight(x, subgrid.xs()[ix], subgrid.xs()[ix+1]);
+    const double tq = _linearWeight(q2, subgrid.q2s()[iq2], subgrid.q2s()[iq2+1]);
+    return _interpolateCell(subgrid, ix, iq2, tx, tq);
   }
 
 
+  void BilinearInterpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                               double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    // The flavors share the knots, so the checks and weights are computed once
+    const KnotArray1F& subgrid = *subgrids[0];
+    _checkKnots(subgrid);
+    const double tx = _linearWeight(x, subgrid.xs()[ix], subgrid.xs()[ix+1]);
+    const double tq = _linearWeight(q2, subgrid.q2s()[iq2], subgrid.q2s()[iq2+1]);
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _interpolateCell(*subgrids[j], ix, iq2, tx, tq);
+  }
+
+
+  bool BilinearInterpolator::_stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const {
+    _checkKnots(subgrid);
+    linearStencil(subgrid.xs(), subgrid.ixbelow(x), x, sx);
+    linearStencil(subgrid.q2s(), subgrid.iq2below(q2), q2, sq);
+    return true;
+  }
+
+
+  void BilinearInterpolator::_cellWeights(const KnotArray1F& subgrid, CellWeights& w) const {
+    _checkKnots(subgrid);
+    w.ix = subgrid.ixbelow(w.x);
+    w.iq2 = subgrid.iq2below(w.q2);
+    _LinearWeights& t = *w.data<_LinearWeights>();
+    t.tx = _linearWeight(w.x, subgrid.xs()[w.ix], subgrid.xs()[w.ix+1]);
+    t.tq = _linearWeight(w.q2, subgrid.q2s()[w.iq2], subgrid.q2s()[w.iq2+1]);
+  }
+
+
+  double BilinearInterpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    const _LinearWeights& t = *w.data<_LinearWeights>();
+    return _interpolateCell(subgrid, w.ix, w.iq2, t.tx, t.tq);
+  }
+
+
+  // Compile the devirtualised evaluators for this interpolator here, so that its kernel can be inlined into them
+  template class GridEvaluator<BilinearInterpolator, ErrExtrapolator>;
+  template class GridEvaluator<BilinearInterpolator, NearestPointExtrapolator>;
+  template class GridEvaluator<BilinearInterpolator, ContinuationExtrapolator>;
+
+
 }
@@ -12,84 +12,144 @@ namespace LHAPDF {
   namespace { // Unnamed namespace
 
     // One-dimensional linear extrapolation for y(x).
-    // Extrapolate in log(x) rather than just in x.
-    inline double _extrapolateLinear(double x, double xl, double xh, double yl, double yh) {
+    // Extrapolate in log(x) rather than just in x, with the logs of x and the edge knots given.
+    inline double _extrapolateLinear(double logx, double logxl, double logxh, double yl, double yh) {
       if (yl > 1e-3 && yh > 1e-3) {
 	// If yl and yh are sufficiently positive, keep y positive by extrapolating log(y).
-	return exp(log(yl) + (log(x) - log(xl)) / (log(xh) - log(xl)) * (log(yh) - log(yl)));
+	return exp(log(yl) + (logx - logxl) / (logxh - logxl) * (log(yh) - log(yl)));
       } else {
 	// Otherwise just extrapolate y itself.
-	return yl + (log(x) - log(xl)) / (log(xh) - log(xl)) * (yh - yl);
+	return yl + (logx - logxl) / (logxh - logxl) * (yh - yl);
       }
     }
 
   }
-  
-  
+
+
+  void ContinuationExtrapolator::prepare() {
+    unprepare();
+    _findEdges(_edges);
+    vector<int> ids = pdf().flavors();
+    sort(ids.begin(), ids.end());
+    for (int id : ids) {
+      // Flavors missing from the grid are left to fail at query time, as without the tables
+      double corners[8];
+      try {
+        _interpolateCorners(id, true, _edges, corners);
+        _interpolateCorners(id, false, _edges, corners + 4);
+      } catch (const Exception&) {
+        continue;
+      }
+      _cornerids.push_back(id);
+      _corners.insert(_corners.end(), corners, corners + 8);
+    }
+    _prepared = true;
+  }
+
+
+  void ContinuationExtrapolator::unprepare() {
+    _prepared = false;
+    _cornerids.clear();
+    _corners.clear();
+  }
+
+
+  void ContinuationExtrapolator::_findEdges(Edges& edges) const {
+    const vector<double>& xknots = pdf().xKnots(); // x knots (all subgrids)
+    const vector<double>& q2knots = pdf().q2Knots(); // q2 knots (all subgrids)
+    edges.xmin = xknots[0]; // first x knot
+    edges.xmin1 = xknots[1]; // second x knot
+    edges.xmax = xknots[xknots.size()-1]; // last x knot
+    edges.q2min = q2knots[0]; // first q2 knot
+    edges.q2max1 = q2knots[q2knots.size()-2]; // second-last q2 knot
+    edges.q2max = q2knots[q2knots.size()-1]; // last q2 knot
+    edges.logxmin = log(edges.xmin);
+    edges.logxmin1 = log(edges.xmin1);
+    edges.logq2max = log(edges.q2max);
+    edges.logq2max1 = log(edges.q2max1);
+  }
+
+
+  void ContinuationExtrapolator::_interpolateCorners(int id, bool high, const Edges& edges, double* rtn) const {
+    const Interpolator& ipol = pdf().interpolator();
+    if (high) {
+      rtn[0] = ipol.interpolateXQ2(id, edges.xmin, edges.q2max); // PDF at (xMin,q2Max)
+      rtn[1] = ipol.interpolateXQ2(id, edges.xmin, edges.q2max1); // PDF at (xMin,q2Max1)
+      rtn[2] = ipol.interpolateXQ2(id, edges.xmin1, edges.q2max); // PDF at (xMin1,q2Max)
+      rtn[3] = ipol.interpolateXQ2(id, edges.xmin1, edges.q2max1); // PDF at (xMin1,q2Max1)
+    } else {
+      rtn[0] = ipol.interpolateXQ2(id, edges.xmin, edges.q2min); // PDF at (xMin,q2Min)
+      rtn[1] = ipol.interpolateXQ2(id, edges.xmin1, edges.q2min); // PDF at (xMin1,q2Min)
+      rtn[2] = ipol.interpolateXQ2(id, edges.xmin, 1.01*edges.q2min); // PDF at (xMin,1.01*q2Min)
+      rtn[3] = ipol.interpolateXQ2(id, edges.xmin1, 1.01*edges.q2min); // PDF at (xMin1,1.01*q2Min)
+    }
+  }
+
+
+  const double* ContinuationExtrapolator::_cornerValues(int id, bool high, const Edges& edges, double* tmp) const {
+    if (_prepared) {
+      const vector<int>::const_iterator it = lower_bound(_cornerids.begin(), _cornerids.end(), id);
+      if (it != _cornerids.end() && *it == id) return &_corners[8*(it - _cornerids.begin()) + (high ? 0 : 4)];
+    }
+    _interpolateCorners(id, high, edges, tmp);
+    return tmp;
+  }
+
+
   double ContinuationExtrapolator::extrapolateXQ2(int id, double x, double q2) const {
     // The ContinuationExtrapolator provides an implementation of the extrapolation used in
     // the MSTW standalone code (and LHAPDFv5 when using MSTW sets), G. Watt, October 2014.
 
-    const size_t nxknots = pdf().xKnots().size(); // total number of x knots (all subgrids)
-    const size_t nq2knots = pdf().q2Knots().size(); // total number of q2 knots (all subgrids)
+    // Grid edges, tabulated by prepare() or else read from the PDF
+    Edges unprepared;
+    if (!_prepared) _findEdges(unprepared);
+    const Edges& e = _prepared ? _edges : unprepared;
+    const Interpolator& ipol = pdf().interpolator();
 
-    const double xMin = pdf().xKnots()[0]; // first x knot
-    const double xMin1 = pdf().xKnots()[1]; // second x knot
-    const double xMax = pdf().xKnots()[nxknots-1]; // last x knot
-
-    const double q2Min = pdf().q2Knots()[0]; // first q2 knot
-    const double q2Max1 = pdf().q2Knots()[nq2knots-2]; // second-last q2 knot
-    const double q2Max = pdf().q2Knots()[nq2knots-1]; // last q2 knot
-    
     double fxMin, fxMin1, fq2Max, fq2Max1, fq2Min, fq2Min1, xpdf, anom;
+    double tmp[4];
 
-    if (x < xMin && (q2 >= q2Min && q2 <= q2Max)) {
+    if (x < e.xmin && (q2 >= e.q2min && q2 <= e.q2max)) {
 
       // Extrapolation in small x only.
-      fxMin = pdf().interpolator().interpolateXQ2(id, xMin, q2); // PDF at (xMin,q2)
-      fxMin1 = pdf().interpolator().interpolateXQ2(id, xMin1, q2); // PDF at (xMin1,q2)
-      xpdf = _extrapolateLinear(x, xMin, xMin1, fxMin, fxMin1); // PDF at (x,q2)
+      fxMin = ipol.interpolateXQ2(id, e.xmin, q2); // PDF at (xMin,q2)
+      fxMin1 = ipol.interpolateXQ2(id, e.xmin1, q2); // PDF at (xMin1,q2)
+      xpdf = _extrapolateLinear(log(x), e.logxmin, e.logxmin1, fxMin, fxMin1); // PDF at (x,q2)
 
-    } else if ((x >= xMin && x <= xMax) && q2 > q2Max) {
+    } else if ((x >= e.xmin && x <= e.xmax) && q2 > e.q2max) {
 
       // Extrapolation in large q2 only.
-      fq2Max = pdf().interpolator().interpolateXQ2(id, x, q2Max); // PDF at (x,q2Max)
-      fq2Max1 = pdf().interpolator().interpolateXQ2(id, x, q2Max1); // PDF at (x,q2Max1)
-      xpdf = _extrapolateLinear(q2, q2Max, q2Max1, fq2Max, fq2Max1); // PDF at (x,q2)
+      fq2Max = ipol.interpolateXQ2(id, x, e.q2max); // PDF at (x,q2Max)
+      fq2Max1 = ipol.interpolateXQ2(id, x, e.q2max1); // PDF at (x,q2Max1)
+      xpdf = _extrapolateLinear(log(q2), e.logq2max, e.logq2max1, fq2Max, fq2Max1); // PDF at (x,q2)
 
-    } else if (x < xMin && q2 > q2Max) {
+    } else if (x < e.xmin && q2 > e.q2max) {
 
-      // Extrapolation in large q2 AND small x.
-      fq2Max = pdf().interpolator().interpolateXQ2(id, xMin, q2Max); // PDF at (xMin,q2Max)
-      fq2Max1 = pdf().interpolator().interpolateXQ2(id, xMin, q2Max1); // PDF at (xMin,q2Max1)
-      fxMin = _extrapolateLinear(q2, q2Max, q2Max1, fq2Max, fq2Max1); // PDF at (xMin,q2)
-      fq2Max = pdf().interpolator().interpolateXQ2(id, xMin1, q2Max); // PDF at (xMin1,q2Max)
-      fq2Max1 = pdf().interpolator().interpolateXQ2(id, xMin1, q2Max1); // PDF at (xMin1,q2Max1)
-      fxMin1 = _extrapolateLinear(q2, q2Max, q2Max1, fq2Max, fq2Max1); // PDF at (xMin1,q2)
-      xpdf = _extrapolateLinear(x, xMin, xMin1, fxMin, fxMin1); // PDF at (x,q2)
+      // Extrapolation in large q2 AND small x, from the corner values.
+      const double* f = _cornerValues(id, true, e, tmp);
+      const double logq2 = log(q2);
+      fxMin = _extrapolateLinear(logq2, e.logq2max, e.logq2max1, f[0], f[1]); // PDF at (xMin,q2)
+      fxMin1 = _extrapolateLinear(logq2, e.logq2max, e.logq2max1, f[2], f[3]); // PDF at (xMin1,q2)
+      xpdf = _extrapolateLinear(log(x), e.logxmin, e.logxmin1, fxMin, fxMin1); // PDF at (x,q2)
 
-    } else if (q2 < q2Min && x <= xMax) {
+    } else if (q2 < e.q2min && x <= e.xmax) {
 
       // Extrapolation in small q2.
 
-      if (x < xMin) {
+      if (x < e.xmin) {
 
-	// Extrapolation also in small x.
+	// Extrapolation also in small x, from the corner values.
 
-	fxMin = pdf().interpolator().interpolateXQ2(id, xMin, q2Min); // PDF at (xMin,q2Min)
-	fxMin1 = pdf().interpolator().interpolateXQ2(id, xMin1, q2Min); // PDF at (xMin1,q2Min)
-	fq2Min = _extrapolateLinear(x, xMin, xMin1, fxMin, fxMin1); // PDF at (x,q2Min)
-	fxMin = pdf().interpolator().interpolateXQ2(id, xMin, 1.01*q2Min); // PDF at (xMin,1.01*q2Min)
-	fxMin1 = pdf().interpolator().interpolateXQ2(id, xMin1, 1.01*q2Min); // PDF at (xMin1,1.01*q2Min)
-	fq2Min1 = _extrapolateLinear(x, xMin, xMin1, fxMin, fxMin1); // PDF at (x,1.01*q2Min)
+	const double* f = _cornerValues(id, false, e, tmp);
+	const double logx = log(x);
+	fq2Min = _extrapolateLinear(logx, e.logxmin, e.logxmin1, f[0], f[1]); // PDF at (x,q2Min)
+	fq2Min1 = _extrapolateLinear(logx, e.logxmin, e.logxmin1, f[2], f[3]); // PDF at (x,1.01*q2Min)
 
       } else {
 
 	// Usual interpolation in x.
-
-	fq2Min = pdf().interpolator().interpolateXQ2(id, x, q2Min); // PDF at (x,q2Min)
-	fq2Min1 = pdf().interpolator().interpolateXQ2(id, x, 1.01*q2Min); // PDF at (x,1.01*q2Min)
-
+	fq2Min = ipol.interpolateXQ2(id, x, e.q2min); // PDF at (x,q2Min)
+	fq2Min1 = ipol.interpolateXQ2(id, x, 1.01*e.q2min); // PDF at (x,1.01*q2Min)
       }
 
       // Calculate the anomalous dimension, dlog(f)/dlog(q2),
@@ -110,7 +170,7 @@ namespace LHAPDF {
 
       // Interpolates between f(q2Min)*(q2/q2Min)^anom for q2 ~ q2Min and
       // f(q2Min)*(q2/q2Min) for q2 << q2Min, i.e. PDFs vanish as q2 --> 0.
-      xpdf = fq2Min * pow( q2/q2Min, anom*q2/q2Min + 1.0 - q2/q2Min );
+      xpdf = fq2Min * pow( q2/e.q2min, anom*q2/e.q2min + 1.0 - q2/e.q2min );
 
     }
 
@@ -13,14 +13,60 @@
 #include "LHAPDF/BicubicInterpolator.h"
 #include "LHAPDF/LogBilinearInterpolator.h"
 #include "LHAPDF/LogBicubicInterpolator.h"
+#include "LHAPDF/LogBicubicPatchInterpolator.h"
 #include "LHAPDF/ErrExtrapolator.h"
 #include "LHAPDF/NearestPointExtrapolator.h"
 #include "LHAPDF/ContinuationExtrapolator.h"
+#include "LHAPDF/GridEvaluator.h"
 #include "LHAPDF/AlphaS.h"
+#include <mutex>
+#include <typeinfo>
 
 namespace LHAPDF {
 
 
+  namespace {
+
+    /// Make the GridEvaluator for interpolator type IPOL and the PDF's extrapolator type
+    template <typename IPOL>
+    GridEvaluatorBase* _mkGridEvaluator(const GridPDF& pdf) {
+      const type_info& xtype = typeid(pdf.extrapolator());
+      if (xtype == typeid(ContinuationExtrapolator))
+        return new GridEvaluator<IPOL, ContinuationExtrapolator>(pdf);
+      else if (xtype == typeid(NearestPointExtrapolator))
+        return new GridEvaluator<IPOL, NearestPointExtrapolator>(pdf);
+      else if (xtype == typeid(ErrExtrapolator))
+        return new GridEvaluator<IPOL, ErrExtrapolator>(pdf);
+      else
+        throw FactoryError("No grid evaluator available for extrapolator type " + string(xtype.name()));
+    }
+
+    /// Canonical key of the alpha_s parameters in an Info, from the raw values of all the keys read by mkAlphaS
+    string _alphasKey(const Info& info) {
+      static const char* KEYS[] = {
+        "AlphaS_Type", "AlphaS_OrderQCD",
+        "AlphaS_ThresholdDown", "AlphaS_ThresholdUp", "AlphaS_ThresholdStrange",
+        "AlphaS_ThresholdCharm", "AlphaS_ThresholdBottom", "AlphaS_ThresholdTop",
+        "ThresholdDown", "ThresholdUp", "ThresholdStrange", "ThresholdCharm", "ThresholdBottom", "ThresholdTop",
+        "AlphaS_MDown", "AlphaS_MUp", "AlphaS_MStrange", "AlphaS_MCharm", "AlphaS_MBottom", "AlphaS_MTop",
+        "MDown", "MUp", "MStrange", "MCharm", "MBottom", "MTop",
+        "AlphaS_FlavorScheme", "FlavorScheme", "AlphaS_NumFlavors", "NumFlavors",
+        "AlphaS_MZ", "MZ", "AlphaS_Reference", "AlphaS_MassReference",
+        "AlphaS_Lambda3", "AlphaS_Lambda4", "AlphaS_Lambda5", "AlphaS_Qs", "AlphaS_Vals", "AlphaS_Solver" };
+      string key;
+      for (const char* k : KEYS) {
+        if (!info.has_key(k)) continue;
+        key += k;
+        key += '=';
+        key += info.get_entry(k);
+        key += '\n';
+      }
+      return key;
+    }
+
+  }
+
+
   Info& getConfig() {
     return Config::get();
   }
@@ -28,6 +74,8 @@ namespace LHAPDF {
 
   PDFSet& getPDFSet(const string& setname) {
     static map<string, PDFSet> _sets;
+    static mutex _sets_mutex; //< Sets may be requested concurrently, e.g. by parallel mkPDFs
+    lock_guard<mutex> lock(_sets_mutex);
     map<string, PDFSet>::iterator it = _sets.find(setname);
     if (it != _sets.end()) return it->second;
     _sets[setname] = PDFSet(setname);
@@ -87,6 +135,11 @@ namespace LHAPDF {
   }
 
 
+  LazyPDFs mkLazyPDFs(const string& setname, double budgetMB) {
+    return getPDFSet(setname).mkLazyPDFs(budgetMB);
+  }
+
+
   Interpolator* mkInterpolator(const string& name) {
     // Convert name to lower case for comparisons
     const string iname = to_lower(name);
@@ -98,6 +151,12 @@ namespace LHAPDF {
       return new LogBilinearInterpolator();
     else if (iname == "logcubic")
       return new LogBicubicInterpolator();
+    else if (iname == "cubic-precomputed")
+      return new BicubicInterpolator(true);
+    else if (iname == "logcubic-precomputed")
+      return new LogBicubicInterpolator(true);
+    else if (iname == "logcubic-patch")
+      return new LogBicubicPatchInterpolator();
     else
       throw FactoryError("Undeclared interpolator requested: " + name);
   }
@@ -118,6 +177,24 @@ namespace LHAPDF {
   }
 
 
+  GridEvaluatorBase* mkGridEvaluator(const GridPDF& pdf) {
+    // Dispatch on the exact interpolator type, since e.g. the patch interpolator derives from the log-bicubic one
+    const type_info& itype = typeid(pdf.interpolator());
+    if (itype == typeid(BilinearInterpolator))
+      return _mkGridEvaluator<BilinearInterpolator>(pdf);
+    else if (itype == typeid(BicubicInterpolator))
+      return _mkGridEvaluator<BicubicInterpolator>(pdf);
+    else if (itype == typeid(LogBilinearInterpolator))
+      return _mkGridEvaluator<LogBilinearInterpolator>(pdf);
+    else if (itype == typeid(LogBicubicInterpolator))
+      return _mkGridEvaluator<LogBicubicInterpolator>(pdf);
+    else if (itype == typeid(LogBicubicPatchInterpolator))
+      return _mkGridEvaluator<LogBicubicPatchInterpolator>(pdf);
+    else
+      throw FactoryError("No grid evaluator available for interpolator type " + string(itype.name()));
+  }
+
+
   AlphaS* mkAlphaS(const Info& info) {
     AlphaS* as = 0;
 
@@ -192,10 +269,11 @@ namespace LHAPDF {
       if (info.has_key("MZ"))as->setMZ(info.get_entry_as<double>("MZ"));
       if (info.has_key("AlphaS_Reference"))as->setAlphaSReference(info.get_entry_as<double>("AlphaS_Reference"));
       if (info.has_key("AlphaS_MassReference"))as->setMassReference(info.get_entry_as<double>("AlphaS_MassReference"));
-      if (info.has_key("AlphaS_Qs")) {
-        AlphaS_ODE* as_o = dynamic_cast<AlphaS_ODE*>(as);
-        if (info.has_key("AlphaS_Qs")) as_o->setQValues( info.get_entry_as< vector<double> >("AlphaS_Qs"));
-      }
+      AlphaS_ODE* as_o = dynamic_cast<AlphaS_ODE*>(as);
+      if (info.has_key("AlphaS_Qs")) as_o->setQValues( info.get_entry_as< vector<double> >("AlphaS_Qs"));
+      const string solver = to_lower(info.get_entry("AlphaS_Solver", "rk4"));
+      if (solver == "dopri5") as_o->setSolver(AlphaS_ODE::DOPRI5);
+      else if (solver != "rk4") throw MetadataError("Unknown AlphaS_Solver '" + solver + "': valid values are 'rk4' and 'dopri5'");
     }
     else if (as->type() == "analytic") {
       /// @todo Handle FFNS / VFNS
@@ -217,6 +295,24 @@ namespace LHAPDF {
   }
 
 
+  shared_ptr<const AlphaS> mkSharedAlphaS(const Info& info) {
+    static map< string, weak_ptr<const AlphaS> > _alphases;
+    static mutex _alphases_mutex; //< PDFs may be loaded concurrently
+    const string key = _alphasKey(info);
+    lock_guard<mutex> lock(_alphases_mutex);
+    shared_ptr<const AlphaS> rtn = _alphases[key].lock();
+    if (rtn) return rtn;
+    rtn.reset(mkAlphaS(info));
+    // Drop the entries of objects no longer in use, before registering the new one
+    for (map< string, weak_ptr<const AlphaS> >::iterator it = _alphases.begin(); it != _alphases.end(); ) {
+      if (it->second.expired()) _alphases.erase(it++);
+      else ++it;
+    }
+    _alphases[key] = rtn;
+    return rtn;
+  }
+
+
   AlphaS* mkAlphaS(const std::string& setname) {
     return mkAlphaS(getPDFSet(setname));
   }
@@ -6,12 +6,23 @@
 #include "LHAPDF/GridPDF.h"
 #include "LHAPDF/Interpolator.h"
 #include "LHAPDF/Factories.h"
+#include "LHAPDF/PDFSet.h"
+#include "LHAPDF/Config.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <stdexcept>
 #include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <limits>
+#include <locale>
+#include <typeinfo>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -21,6 +32,22 @@ namespace LHAPDF {
   void GridPDF::setInterpolator(Interpolator* ipol) {
     _interpolator.reset(ipol);
     _interpolator->bind(this);
+    // With "auto", only use the vectorised kernels where they beat the scalar evaluation
+    const string simd = info().get_entry("SIMD", "none");
+    const bool autoscalar = (to_lower(simd) == "auto" && !_interpolator->simdFaster());
+    _interpolator->setSIMDLevel(autoscalar ? SIMD_NONE : simdLevelFromName(simd));
+    _interpolator->setQueryCache(info().get_entry_as<bool>("QueryCache", false));
+    _prepareInterpolator();
+    _prepareExtrapolator();
+  }
+
+  void GridPDF::_prepareInterpolator() {
+    if (!hasInterpolator()) return;
+    for (pair<const double, KnotArrayNF>& q2_ka : _knotarrays) {
+      KnotArrayNF& arraynf = q2_ka.second;
+      for (int pid : arraynf.pids()) _interpolator->prepare(arraynf[pid]);
+    }
+    _interpolator->resetQueryCache();
   }
 
   void GridPDF::setInterpolator(const std::string& ipolname) {
@@ -43,6 +70,13 @@ namespace LHAPDF {
   void GridPDF::setExtrapolator(Extrapolator* xpol) {
     _extrapolator.reset(xpol);
     _extrapolator->bind(this);
+    _prepareExtrapolator();
+  }
+
+  void GridPDF::_prepareExtrapolator() {
+    // The extrapolator's tables may depend on both the grid and the interpolator
+    if (!hasExtrapolator() || !hasInterpolator() || _knotarrays.empty()) return;
+    _extrapolator->prepare();
   }
 
   void GridPDF::setExtrapolator(const std::string& xpolname) {
@@ -64,6 +98,15 @@ namespace LHAPDF {
   const KnotArrayNF& GridPDF::subgrid(double q2) const {
     assert(q2 >= 0);
     assert(!q2Knots().empty());
+    // Use the flat edge table if available: fall back to the map for programmatically filled grids
+    if (!_subgrids.empty()) {
+      const size_t i = upper_bound(_subgridedges.begin(), _subgridedges.end(), q2) - _subgridedges.begin();
+      if (i == 0)
+        throw GridError("Requested Q2 " + to_str(q2) + " is lower than any available Q2 subgrid (lowest Q2 = " + to_str(q2Knots().front()) + ")");
+      if (i == _subgridedges.size() && q2 > _q2knots.back())
+        throw GridError("Requested Q2 " + to_str(q2) + " is higher than any available Q2 subgrid (highest Q2 = " + to_str(q2Knots().back()) + ")");
+      return *_subgrids[i-1];
+    }
     map<double, KnotArrayNF>::const_iterator it = _knotarrays.upper_bound(q2);
     if (it == _knotarrays.begin())
       throw GridError("Requested Q2 " + to_str(q2) + " is lower than any available Q2 subgrid (lowest Q2 = " + to_str(q2Knots().front()) + ")");
@@ -76,21 +119,42 @@ namespace LHAPDF {
 
 
   const vector<double>& GridPDF::q2Knots() const {
-    if (_q2knots.empty()) {
-      // Get the list of Q2 knots by combining all subgrids
-      for (const pair<double, KnotArrayNF>& q2_ka : _knotarrays) {
-        const KnotArrayNF& subgrid = q2_ka.second;
-        const KnotArray1F& grid1 = subgrid.get_first();
-        if (grid1.q2s().empty()) continue; //< @todo This shouldn't be possible, right? Throw instead, or ditch the check?
-        for (double q2 : grid1.q2s()) {
-          if (_q2knots.empty() || q2 != _q2knots.back()) _q2knots.push_back(q2);
+    // Filled on loading, or once only on first use for grids filled by hand
+    if (!_q2knotsready.load(memory_order_acquire)) {
+      lock_guard<mutex> lock(_lazymutex);
+      if (!_q2knotsready.load(memory_order_relaxed)) {
+        // Get the list of Q2 knots by combining all subgrids
+        _q2knots.clear();
+        for (const pair<const double, KnotArrayNF>& q2_ka : _knotarrays) {
+          const KnotArrayNF& subgrid = q2_ka.second;
+          const KnotArray1F& grid1 = subgrid.get_first();
+          if (grid1.q2s().empty()) continue; //< @todo This shouldn't be possible, right? Throw instead, or ditch the check?
+          for (double q2 : grid1.q2s()) {
+            if (_q2knots.empty() || q2 != _q2knots.back()) _q2knots.push_back(q2);
+          }
         }
+        _q2knotsready.store(true, memory_order_release);
       }
     }
     return _q2knots;
   }
 
 
+  void GridPDF::_syncSubgrids() {
+    _subgridedges.clear();
+    _subgrids.clear();
+    _subgridedges.reserve(_knotarrays.size());
+    _subgrids.reserve(_knotarrays.size());
+    for (const pair<const double, KnotArrayNF>& q2_ka : _knotarrays) {
+      _subgridedges.push_back(q2_ka.first);
+      _subgrids.push_back(&q2_ka.second);
+    }
+    // Also fill the Q2 knot cache, which the subgrid lookup relies on
+    _q2knotsready = false;
+    q2Knots();
+  }
+
+
   double GridPDF::_xfxQ2(int id, double x, double q2) const {
     /// Decide whether to use interpolation or extrapolation... the sanity checks
     /// are done in the public PDF::xfxQ2 function.
@@ -111,32 +175,231 @@ namespace LHAPDF {
   }
 
 
+  void GridPDF::_xfxQ2NF(const int* ids, size_t nids, double x, double q2, double* rtn) const {
+    if (inRangeXQ2(x, q2)) {
+      interpolator().interpolateXQ2(ids, nids, x, q2, rtn);
+    } else {
+      for (size_t j = 0; j < nids; ++j) rtn[j] = extrapolator().extrapolateXQ2(ids[j], x, q2);
+    }
+  }
+
+
+  PreparedPoint GridPDF::prepare(double x, double q2) const {
+    PreparedPoint rtn;
+    rtn._x = x;
+    rtn._q2 = q2;
+    // Only in-range points of grids with the flat subgrid table are prepared: others use the normal route
+    if (_subgrids.empty() || !inRangeXQ2(x, q2)) return rtn;
+    const size_t isub = upper_bound(_subgridedges.begin(), _subgridedges.end(), q2) - _subgridedges.begin() - 1;
+    const KnotArray1F& grid = _subgrids[isub]->get_first();
+    if (!interpolator().stencils(grid, x, q2, rtn._sx, rtn._sq)) return rtn;
+    rtn._isubgrid = isub;
+    rtn._axes = grid.axes();
+    rtn._ipoltype = &typeid(interpolator());
+    return rtn;
+  }
+
+
+  const KnotArrayNF* GridPDF::_preparedSubgrid(const PreparedPoint& pt) const {
+    if (!pt.prepared() || pt._isubgrid >= _subgrids.size()) return 0;
+    if (*pt._ipoltype != typeid(interpolator())) return 0;
+    if (!inRangeXQ2(pt._x, pt._q2)) return 0;
+    // The normal lookup must also give this subgrid, which it does not for Q2 at a higher subgrid's edge
+    if (pt._isubgrid+1 < _subgridedges.size() && pt._q2 >= _subgridedges[pt._isubgrid+1]) return 0;
+    const KnotArrayNF* rtn = _subgrids[pt._isubgrid];
+    if (!pt._axes->matches(*rtn->get_first().axes())) return 0;
+    return rtn;
+  }
+
+
+  double GridPDF::xfxQ2(int id, const PreparedPoint& pt) const {
+    const KnotArrayNF* subgrid = _preparedSubgrid(pt);
+    if (subgrid == 0) return xfxQ2(id, pt.x(), pt.q2());
+    // Treat PID = 0 as always equivalent to a gluon: query as PID = 21
+    const int id2 = (id != 0) ? id : 21;
+    // Undefined PIDs
+    if (!hasFlavor(id2)) return 0.0;
+    const KnotArray1F* grid = &subgrid->get_pid(id2);
+    if (!pt._axes->matches(*grid->axes())) return xfxQ2(id, pt.x(), pt.q2());
+    double xfx;
+    applyStencilNF(interpolator().simdLevel(), pt._sx, pt._sq, &grid, 1, &xfx);
+    // Apply positivity forcing at the enabled level
+    switch (forcePositive()) {
+    case 0: break;
+    case 1: if (xfx < 0) xfx = 0; break;
+    case 2: if (xfx < 1e-10) xfx = 1e-10; break;
+    default: throw LogicError("ForcePositive value not in expected range!");
+    }
+    return xfx;
+  }
+
+
+  void GridPDF::xfxQ2(const PreparedPoint& pt, std::vector<double>& rtn) const {
+    const KnotArrayNF* subgrid = _preparedSubgrid(pt);
+    if (subgrid == 0) {
+      xfxQ2(pt.x(), pt.q2(), rtn);
+      return;
+    }
+    static const int IDS[13] = { -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6 }; //< PID = 0 is automatically treated as PID = 21
+    rtn.clear();
+    rtn.resize(13);
+    // Collect the defined flavors, all of which must have the prepared knots
+    const KnotArray1F* grids[13];
+    size_t cols[13];
+    size_t n = 0;
+    for (size_t j = 0; j < 13; ++j) {
+      const int id2 = (IDS[j] != 0) ? IDS[j] : 21;
+      if (!hasFlavor(id2)) continue;
+      grids[n] = &subgrid->get_pid(id2);
+      if (!pt._axes->matches(*grids[n]->axes())) {
+        xfxQ2(pt.x(), pt.q2(), rtn);
+        return;
+      }
+      cols[n] = j;
+      n += 1;
+    }
+    double xfs[13];
+    applyStencilNF(interpolator().simdLevel(), pt._sx, pt._sq, grids, n, xfs);
+    // Apply positivity forcing at the enabled level
+    const int forcepos = forcePositive();
+    if (forcepos < 0 || forcepos > 2) throw LogicError("ForcePositive value not in expected range!");
+    const double xfmin = (forcepos == 1) ? 0 : 1e-10;
+    for (size_t k = 0; k < n; ++k)
+      rtn[cols[k]] = (forcepos != 0 && xfs[k] < xfmin) ? xfmin : xfs[k];
+  }
+
+
+  void GridPDF::_xfxQ2Batch(int id, const double* xs, const double* q2s, size_t npoints, double* rtn, size_t stride) const {
+    // Grid range, hoisted out of the loop
+    const double xmin = xKnots().front(), xmax = xKnots().back();
+    const double q2min = q2Knots().front(), q2max = q2Knots().back();
+    const Interpolator& ipol = interpolator();
+    size_t i = 0;
+    while (i < npoints) {
+      // Interpolate each run of in-range points in one go, and extrapolate the others one by one
+      size_t j = i;
+      while (j < npoints && xs[j] >= xmin && xs[j] <= xmax && q2s[j] >= q2min && q2s[j] <= q2max) ++j;
+      if (j > i) {
+        ipol.interpolateXQ2(id, xs+i, q2s+i, j-i, rtn + i*stride, stride);
+        i = j;
+      } else {
+        rtn[i*stride] = extrapolator().extrapolateXQ2(id, xs[i], q2s[i]);
+        i += 1;
+      }
+    }
+  }
+
+
   namespace {
 
-    // A wrapper for std::strtod and std::strtol, for fast tokenizing when all
-    // input is guaranteed to be numeric (as in this data block). Based very
-    // closely on FastIStringStream by Gavin Salam.
+    /// @brief Locale-independent parsing of a double from the text at [p, end)
+    ///
+    /// Returns the position after the number, or @a p if there is no number
+    /// there. Decimal mantissas of up to 2^53 with power-of-ten exponents of
+    /// magnitude up to 22, which covers the printf-style values in grid files,
+    /// are converted exactly by a single correctly-rounded multiplication or
+    /// division. Anything else falls back to a classic-locale stream conversion.
+    const char* parse_double(const char* p, const char* end, double& x) {
+      static const double POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+      const char* const start = p;
+      const bool neg = (p < end && *p == '-');
+      if (p < end && (*p == '-' || *p == '+')) ++p;
+
+      // Mantissa digits, accumulated while they fit exactly in 19 decimal digits
+      uint64_t m = 0;
+      int ndigits = 0, exp10 = 0;
+      bool anydigits = false, truncated = false;
+      for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        anydigits = true;
+        if (ndigits < 19) { m = 10*m + (*p - '0'); if (m != 0) ndigits += 1; }
+        else { exp10 += 1; truncated |= (*p != '0'); }
+      }
+      if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+          anydigits = true;
+          if (ndigits < 19) { m = 10*m + (*p - '0'); if (m != 0) ndigits += 1; exp10 -= 1; }
+          else truncated |= (*p != '0');
+        }
+      }
+      if (!anydigits) {
+        // Only the special values remain: inf, infinity and nan, in any case
+        const char* q = p;
+        string word;
+        while (q < end && word.size() < 8 && isalpha((unsigned char) *q)) word += tolower((unsigned char) *q++);
+        if (word == "inf" || word == "infinity") x = numeric_limits<double>::infinity();
+        else if (word == "nan") x = numeric_limits<double>::quiet_NaN();
+        else return start;
+        if (neg) x = -x;
+        return q;
+      }
+
+      // Optional exponent, only consumed if it has at least one digit
+      if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        const bool eneg = (q < end && *q == '-');
+        if (q < end && (*q == '-' || *q == '+')) ++q;
+        if (q < end && *q >= '0' && *q <= '9') {
+          int e = 0;
+          for (; q < end && *q >= '0' && *q <= '9'; ++q) if (e < 100000) e = 10*e + (*q - '0');
+          exp10 += eneg ? -e : e;
+          p = q;
+        }
+      }
+
+      // Exact fast path, else the slow but correctly-rounded library conversion
+      if (m == 0 && !truncated) {
+        x = neg ? -0.0 : 0.0;
+      } else if (!truncated && m <= (uint64_t(1) << 53) && exp10 >= -22 && exp10 <= 22) {
+        x = (exp10 >= 0) ? double(m) * POW10[exp10] : double(m) / POW10[-exp10];
+        if (neg) x = -x;
+      } else {
+        istringstream iss(string(start, p));
+        iss.imbue(locale::classic());
+        iss >> x;
+        if (iss.fail()) { // out of range: overflow to infinity, or underflow to zero
+          x = (exp10 > 0) ? numeric_limits<double>::infinity() : 0.0;
+          if (neg) x = -x;
+        }
+      }
+      return p;
+    }
+
+
+    /// Parsing of a base-10 integer from the text at [p, end), returning the position after it or @a p on failure
+    const char* parse_int(const char* p, const char* end, int& i) {
+      const char* q = p;
+      const bool neg = (q < end && *q == '-');
+      if (q < end && (*q == '-' || *q == '+')) ++q;
+      if (q == end || *q < '0' || *q > '9') return p;
+      long n = 0;
+      for (; q < end && *q >= '0' && *q <= '9'; ++q) n = 10*n + (*q - '0');
+      i = neg ? -n : n;
+      return q;
+    }
+
+
+    // Fast whitespace-separated number tokenizer for one line of an in-memory
+    // buffer, when all input is expected to be numeric (as in this data block).
+    // Parsing stops at the first token which is not a number.
     class NumParser {
     public:
-      // Constructor from char*
-      NumParser(const char* line=0) { reset(line); }
-      // Constructor from std::string
-      NumParser(const string& line) { reset(line); }
-
-      // Re-init to new line as char*
-      void reset(const char* line=0) {
-        _next = const_cast<char*>(line);
-        _new_next = _next;
+      // Constructor from a [begin, end) character range
+      NumParser(const char* begin=0, const char* end=0) { reset(begin, end); }
+
+      // Re-init to a new [begin, end) line
+      void reset(const char* begin, const char* end) {
+        _next = begin;
+        _end = end;
         _error = false;
       }
-      // Re-init to new line as std::string
-      void reset(const string& line) { reset(line.c_str()); }
 
       // Tokenizing stream operator (forwards to double and int specialisations)
       template<class T> NumParser& operator>>(T& value) {
-        _get(value);
-        if (_new_next == _next) _error = true; // handy error condition behaviour!
-        _next = _new_next;
+        while (_next < _end && isspace((unsigned char) *_next)) ++_next;
+        const char* new_next = _get(value);
+        if (new_next == _next) _error = true; // handy error condition behaviour!
+        _next = new_next;
         return *this;
       }
 
@@ -144,47 +407,273 @@ namespace LHAPDF {
       operator bool() const { return !_error; }
 
     private:
-      void _get(double& x) { x = std::strtod(_next, &_new_next); }
-      void _get(float& x) { x = std::strtof(_next, &_new_next); }
-      void _get(int& i) { i = std::strtol(_next, &_new_next, 10); } // force base 10!
+      const char* _get(double& x) { return parse_double(_next, _end, x); }
+      const char* _get(int& i) { return parse_int(_next, _end, i); }
 
-      char *_next, *_new_next;
+      const char *_next, *_end;
       bool _error;
     };
 
+
+    /// @name Binary .lhab grid file format
+    ///
+    /// All values are in the native byte order of the writing machine, identified
+    /// by the endianness tag, and 8-byte aligned:
+    ///
+    ///  - header: magic "LHAB", uint32 endianness tag, uint32 format version,
+    ///    uint32 number of subgrids, uint64 total file size, and the uint64 size
+    ///    and int64 modification time of the text member file it was made from;
+    ///  - then per subgrid: uint64 nx, nQ2 and nflavors; double x and Q2 knots;
+    ///    int64 PIDs; double xf values as [flavor][ix][iQ2].
+    //@{
+    const char* const LHAB_MAGIC = "LHAB";
+    const uint32_t LHAB_ENDIANTAG = 0x01020304;
+    const uint32_t LHAB_VERSION = 2;
+    const size_t LHAB_HEADERSIZE = 40;
+    //@}
+
+
+    /// Bounds-checked sequential access to the contents of a mapped binary grid file
+    class LHABReader {
+    public:
+      LHABReader(const char* data, size_t size)
+        : _data(data), _size(size), _pos(0)
+      {    }
+
+      /// Get a pointer to the next @a n values of type T, advancing past them, or null if the file is too short
+      template <typename T>
+      const T* take(size_t n=1) {
+        if (n > (_size - _pos) / sizeof(T)) return 0;
+        const T* rtn = reinterpret_cast<const T*>(_data + _pos);
+        _pos += n * sizeof(T);
+        return rtn;
+      }
+
+      /// Have all the contents been read?
+      bool atEnd() const { return _pos == _size; }
+
+    private:
+      const char* _data;
+      size_t _size, _pos;
+    };
+
+  }
+
+
+  bool GridPDF::_fileStamp(const std::string& path, uint64_t& size, int64_t& mtime) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return false;
+    size = st.st_size;
+    mtime = st.st_mtime;
+    return true;
   }
 
 
   void GridPDF::_loadData(const std::string& mempath) {
-    string line, prevline;
+    // Choose between per-flavor and flavor-interleaved xf storage
+    const string layout = to_lower(info().get_entry("GridLayout", "separate"));
+    if (layout != "separate" && layout != "interleaved")
+      throw MetadataError("Unknown GridLayout '" + layout + "': valid values are 'separate' and 'interleaved'");
+
+    // Use the binary companion file if it was made from this version of the text file, else parse the text
+    const string binpath = binaryDataPath(mempath);
+    bool loaded = false;
+    if (file_exists(binpath) && info().get_entry_as<bool>("BinaryGrids", true))
+      loaded = _loadBinaryData(binpath, mempath);
+    if (!loaded) _loadAsciiData(mempath);
+
+    // Optionally repack each subgrid into a single flavor-interleaved block
+    if (layout == "interleaved") {
+      for (pair<const double, KnotArrayNF>& q2_ka : _knotarrays) q2_ka.second.interleave();
+    }
+
+    // Build the flat subgrid lookup tables for the interpolation hot path
+    _syncSubgrids();
+    _prepareInterpolator();
+    _prepareExtrapolator();
+  }
+
+
+  bool GridPDF::_loadBinaryData(const std::string& binpath, const std::string& mempath) {
+    // An unusable file, e.g. stale, truncated or half-written, is skipped so that the text file is read
+    // instead: only a failure to access an existing file is an error
+    const auto reject = [&binpath](const string& why) {
+      if (verbosity() > 0) cerr << "WARNING: Ignoring binary grid file " << binpath << ": " << why << endl;
+      return false;
+    };
+
+    // Map the whole file read-only, to be unmapped when the last array using it is destroyed
+    const int fd = open(binpath.c_str(), O_RDONLY);
+    if (fd < 0) throw ReadError("Could not open binary grid file " + binpath);
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      throw ReadError("Could not stat binary grid file " + binpath);
+    }
+    const size_t filesize = st.st_size;
+    if (filesize < LHAB_HEADERSIZE) {
+      close(fd);
+      return reject("the file is too short");
+    }
+    void* addr = mmap(0, filesize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) return reject("the file could not be memory-mapped");
+    const shared_ptr<const char> mapping((const char*) addr, [filesize](const char* p) { munmap((void*) p, filesize); });
+
+    // Check the header
+    LHABReader rd(mapping.get(), filesize);
+    if (string(rd.take<char>(4), 4) != LHAB_MAGIC) return reject("not an LHAPDF binary grid file");
+    if (*rd.take<uint32_t>() != LHAB_ENDIANTAG) return reject("written with a different byte order");
+    if (*rd.take<uint32_t>() != LHAB_VERSION) return reject("unsupported format version");
+    const uint32_t nsubgrids = *rd.take<uint32_t>();
+    if (*rd.take<uint64_t>() != filesize) return reject("the file is truncated or corrupted");
+    // The text file must be unchanged since the binary one was made from it: unpacking an updated
+    // set can leave an older modification time on the text file, so the time must match exactly
+    const uint64_t srcsize = *rd.take<uint64_t>();
+    const int64_t srcmtime = *rd.take<int64_t>();
+    uint64_t memsize = 0;
+    int64_t memmtime = 0;
+    if (!_fileStamp(mempath, memsize, memmtime) || memsize != srcsize || memmtime != srcmtime)
+      return reject("not made from the current version of " + mempath);
+
+    // Register each subgrid block, as views on the mapped xf values, only using them if the whole file is valid
+    map<double, KnotArrayNF> knotarrays;
+    for (uint32_t isub = 0; isub < nsubgrids; ++isub) {
+      const uint64_t* dims = rd.take<uint64_t>(3);
+      if (!dims) return reject("the file is truncated or corrupted");
+      const uint64_t nx = dims[0], nq2 = dims[1], nflav = dims[2];
+      if (nx < 2 || nq2 < 2 || nflav == 0 || nx*nq2 > filesize || nflav > filesize)
+        return reject("empty or invalid subgrid " + to_str(isub));
+      const double* xs = rd.take<double>(nx);
+      const double* q2s = rd.take<double>(nq2);
+      const int64_t* pids = rd.take<int64_t>(nflav);
+      const double* xfs = rd.take<double>(nflav*nx*nq2);
+      if (!xs || !q2s || !pids || !xfs) return reject("the file is truncated or corrupted");
+      const shared_ptr<const KnotAxes> axes = set().knotAxes(vector<double>(xs, xs+nx), vector<double>(q2s, q2s+nq2));
+      KnotArrayNF& arraynf = knotarrays[q2s[0]];
+      for (uint64_t iflav = 0; iflav < nflav; ++iflav) {
+        const shared_ptr<const double> xfdata(mapping, xfs + iflav*nx*nq2);
+        arraynf[pids[iflav]] = KnotArray1F(axes, xfdata, 1);
+      }
+    }
+    if (!rd.atEnd()) return reject("the file is truncated or corrupted");
+    _knotarrays.swap(knotarrays);
+    return true;
+  }
+
+
+  void GridPDF::writeBinaryData(const std::string& path) const {
+    // Check the grid structure and work out the file size
+    uint64_t filesize = LHAB_HEADERSIZE;
+    for (const pair<const double, KnotArrayNF>& q2_ka : _knotarrays) {
+      const KnotArrayNF& arraynf = q2_ka.second;
+      const KnotArray1F& first = arraynf.get_first();
+      for (int pid : arraynf.pids()) {
+        const KnotArray1F& ka = arraynf.get_pid(pid);
+        if (ka.axes() != first.axes() && !ka.axes()->matches(first.xs(), first.q2s()))
+          throw GridError("Binary grid files require all flavors in a subgrid to share the same knots");
+      }
+      filesize += 8 * (3 + first.xsize() + first.q2size() + arraynf.size()*(1 + first.size()));
+    }
+
+    // Identify the text file the grid was loaded from, if any
+    uint64_t srcsize = 0;
+    int64_t srcmtime = 0;
+    _fileStamp(_mempath, srcsize, srcmtime);
+
+    // Write to a temporary file, and move it into place when complete
+    const string tmppath = path + ".tmp" + to_str(getpid());
+    {
+      ofstream file(tmppath.c_str(), ios::binary | ios::trunc);
+      if (!file) throw WriteError("Could not open " + tmppath + " for writing");
+      const uint32_t endiantag = LHAB_ENDIANTAG, version = LHAB_VERSION, nsubgrids = _knotarrays.size();
+      file.write(LHAB_MAGIC, 4);
+      file.write((const char*) &endiantag, 4);
+      file.write((const char*) &version, 4);
+      file.write((const char*) &nsubgrids, 4);
+      file.write((const char*) &filesize, 8);
+      file.write((const char*) &srcsize, 8);
+      file.write((const char*) &srcmtime, 8);
+      for (const pair<const double, KnotArrayNF>& q2_ka : _knotarrays) {
+        const KnotArrayNF& arraynf = q2_ka.second;
+        const KnotArray1F& first = arraynf.get_first();
+        const uint64_t dims[3] = { first.xsize(), first.q2size(), arraynf.size() };
+        file.write((const char*) dims, sizeof(dims));
+        file.write((const char*) first.xs().data(), 8*first.xsize());
+        file.write((const char*) first.q2s().data(), 8*first.q2size());
+        for (int pid : arraynf.pids()) {
+          const int64_t pid64 = pid;
+          file.write((const char*) &pid64, 8);
+        }
+        vector<double> xfs(first.size());
+        for (int pid : arraynf.pids()) {
+          const KnotArray1F& ka = arraynf.get_pid(pid);
+          for (size_t ix = 0; ix < ka.xsize(); ++ix)
+            for (size_t iq2 = 0; iq2 < ka.q2size(); ++iq2)
+              xfs[ix*ka.q2size() + iq2] = ka.xf(ix, iq2);
+          file.write((const char*) xfs.data(), 8*xfs.size());
+        }
+      }
+      if (!file) {
+        file.close();
+        remove(tmppath.c_str());
+        throw WriteError("Error writing binary grid file " + tmppath);
+      }
+    }
+    if (rename(tmppath.c_str(), path.c_str()) != 0) {
+      remove(tmppath.c_str());
+      throw WriteError("Could not move binary grid file into place at " + path);
+    }
+  }
+
+
+  void GridPDF::_loadAsciiData(const std::string& mempath) {
     int iblock(0), iblockline(0), iline(0);
     vector<double> xs, q2s;
     vector<int> pids;
     vector< vector<double> > ipid_xfs;
 
     try {
-      ifstream file(mempath.c_str());
+      // Read the whole file into one buffer, to be scanned in place line by line
+      string buffer;
+      ifstream file(mempath.c_str(), ios::binary);
+      if (file) {
+        file.seekg(0, ios::end);
+        buffer.resize(file.tellg());
+        file.seekg(0, ios::beg);
+        file.read(&buffer[0], buffer.size());
+      }
+      const char* pos = buffer.data();
+      const char* const bufend = pos + buffer.size();
+      bool lastsep = false; // whether the last line was a separator, tested after the loop
+
       NumParser nparser; double ftoken; int itoken;
-      while (getline(file, line)) {
-        // Trim the current line to ensure that there is no effect of leading spaces, etc.
-        line = trim(line);
-        prevline = line; // used to test the last line after the while loop fails
+      while (pos < bufend) {
+        // Find the current line and trim it, to ensure that there is no effect of leading spaces, etc.
+        const char* linebegin = pos;
+        const char* lineend = static_cast<const char*>(memchr(pos, '\n', bufend - pos));
+        if (lineend == 0) lineend = bufend;
+        pos = (lineend < bufend) ? lineend + 1 : bufend;
+        while (linebegin < lineend && *linebegin == ' ') ++linebegin;
+        while (lineend > linebegin && *(lineend-1) == ' ') --lineend;
+        const bool issep = (lineend - linebegin == 3 && memcmp(linebegin, "---", 3) == 0);
+        lastsep = issep;
 
         // If the line is commented out, increment the line number but not the block line
         iline += 1;
-        if (line.find("#") == 0) continue;
+        if (linebegin < lineend && *linebegin == '#') continue;
         iblockline += 1;
 
-        if (line != "---") { // if we are not on a block separator line...
+        if (!issep) { // if we are not on a block separator line...
 
           // Block 0 is the metadata, which we ignore here
           if (iblock == 0) continue;
 
           // Debug printout
-          // cout << iline << " = block line #" << iblockline << " => " << line << endl;
+          // cout << iline << " = block line #" << iblockline << " => " << string(linebegin, lineend) << endl;
 
           // Parse the data lines
-          nparser.reset(line);
+          nparser.reset(linebegin, lineend);
           if (iblockline == 1) { // x knots line
             while (nparser >> ftoken) xs.push_back(ftoken);
             if (xs.empty())
@@ -210,7 +699,7 @@ namespace LHAPDF {
             }
             size_t ipid = 0;
             while (nparser >> ftoken) {
-              ipid_xfs[ipid].push_back(ftoken);
+              if (ipid < pids.size()) ipid_xfs[ipid].push_back(ftoken);
               ipid += 1;
             }
             // Check that each line has many tokens as there should be flavours
@@ -236,12 +725,12 @@ namespace LHAPDF {
 
             // Register data from the block into the GridPDF data structure
             KnotArrayNF& arraynf = _knotarrays[q2s.front()]; //< Reference to newly created subgrid object
+            // Get the x and Q2 knot positions, shared with all flavors and members of the set
+            const shared_ptr<const KnotAxes> axes = set().knotAxes(xs, q2s);
             for (size_t ipid = 0; ipid < pids.size(); ++ipid) {
               const int pid = pids[ipid];
-              // Create the 2D array with the x and Q2 knot positions
-              arraynf[pid] = KnotArray1F(xs, q2s);
-              // Populate the xf data array
-              arraynf[pid].setxfs(ipid_xfs[ipid]);
+              // Create the 2D array with the shared knots, handing over the xf data array
+              arraynf[pid] = KnotArray1F(axes, std::move(ipid_xfs[ipid]));
             }
           }
 
@@ -255,7 +744,7 @@ namespace LHAPDF {
         }
       }
       // File reading finished: complain if it was not properly terminated
-      if (prevline != "---")
+      if (!lastsep)
         throw ReadError("Grid file " + mempath + " is not properly terminated: .dat files MUST end with a --- separator line");
 
       // Error handling
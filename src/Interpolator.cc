@@ -5,11 +5,112 @@
 //
 #include "LHAPDF/Interpolator.h"
 #include "LHAPDF/GridPDF.h"
+#include <atomic>
+#include <cstring>
 
 namespace LHAPDF {
 
 
-double Interpolator::interpolateXQ2(int id, double x, double q2) const {
+  namespace {
+
+    /// Number of recent queries remembered by each thread
+    const size_t NQUERIES = 8;
+
+    /// A cached query, keyed on the interpolator and the x and Q2 bit patterns
+    struct _Query {
+      uint64_t ipolid; //< 0 if unused
+      uint64_t xbits, q2bits;
+      const KnotArrayNF* subgrid;
+      Interpolator::CellWeights w;
+    };
+
+    /// The ring of recent queries of a thread
+    struct _QueryRing {
+      _Query queries[NQUERIES];
+      size_t next;
+      QueryCacheStats stats;
+    };
+
+    /// @brief The ring of the calling thread
+    ///
+    /// Not inlined, since GCC otherwise repeats the thread-local address
+    /// look-up for every entry compared.
+    #ifdef __GNUC__
+    __attribute__((noinline))
+    #endif
+    _QueryRing& _threadRing() {
+      thread_local _QueryRing ring;
+      return ring;
+    }
+
+    /// Next interpolator identifier in the query cache
+    std::atomic<uint64_t> _nextqueryid(1);
+
+    /// The bit pattern of a double
+    inline uint64_t _bits(double v) {
+      uint64_t b;
+      memcpy(&b, &v, sizeof(b));
+      return b;
+    }
+
+  }
+
+
+  QueryCacheStats queryCacheStats() {
+    return _threadRing().stats;
+  }
+
+
+  void resetQueryCacheStats() {
+    _threadRing().stats = QueryCacheStats();
+  }
+
+
+  void Interpolator::resetQueryCache() {
+    // Entries with the old identifier can no longer match
+    _queryid = _nextqueryid++;
+  }
+
+
+  const Interpolator::CellWeights& Interpolator::_cachedWeights(double x, double q2, const KnotArrayNF*& subgridnf) const {
+    _QueryRing& ring = _threadRing();
+    const uint64_t xbits = _bits(x), q2bits = _bits(q2);
+    for (_Query& q : ring.queries) {
+      if (q.ipolid == _queryid && q.xbits == xbits && q.q2bits == q2bits) {
+        ring.stats.hits += 1;
+        subgridnf = q.subgrid;
+        return q.w;
+      }
+    }
+    ring.stats.misses += 1;
+    // Overwrite the oldest entry, which only becomes valid once the look-ups have succeeded
+    _Query& q = ring.queries[ring.next];
+    ring.next = (ring.next + 1) % NQUERIES;
+    q.ipolid = 0;
+    q.subgrid = &pdf().subgrid(q2);
+    const KnotArray1F& subgrid = q.subgrid->get_first();
+    q.w.x = x;
+    q.w.q2 = q2;
+    q.w.axes = subgrid.axes().get();
+    _cellWeights(subgrid, q.w);
+    q.xbits = xbits;
+    q.q2bits = q2bits;
+    q.ipolid = _queryid;
+    subgridnf = q.subgrid;
+    return q.w;
+  }
+
+
+  double Interpolator::interpolateXQ2(int id, double x, double q2) const {
+      // Cached subgrid, indices and weights for a repeated point
+      if (_querycache) {
+        const KnotArrayNF* subgridnf;
+        const CellWeights& w = _cachedWeights(x, q2, subgridnf);
+        const KnotArray1F& subgrid = subgridnf->get_pid(id);
+        if (subgrid.axes().get() == w.axes) return _interpolateWeighted(subgrid, w);
+        return _interpolateXQ2(subgrid, x, subgrid.ixbelow(x), q2, subgrid.iq2below(q2));
+      }
+
       // Subgrid lookup
       /// @todo Do this in two stages to cache the KnotArrayNF?
       /// @todo Add flavour error checking
@@ -26,4 +127,114 @@ double Interpolator::interpolateXQ2(int id, double x, double q2) const {
     }
 
 
+
+  void Interpolator::interpolateXQ2(int id, const double* xs, const double* q2s, size_t npoints,
+                                    double* rtn, size_t stride) const {
+    const size_t BLOCKSIZE = 256;
+
+    // Vectorised kernels if enabled and supported by this interpolator, with the blocks spanning subgrids
+    if (_simd != SIMD_NONE) {
+      const KnotArray1F* subgrids[BLOCKSIZE];
+      KnotStencil sxs[BLOCKSIZE], sqs[BLOCKSIZE];
+      bool stencils = true;
+      for (size_t i = 0; stencils && i < npoints; i += BLOCKSIZE) {
+        const size_t n = min(BLOCKSIZE, npoints - i);
+        for (size_t j = 0; stencils && j < n; ++j) {
+          // Reuse the previous point's subgrid if it covers this Q2
+          const double q2 = q2s[i+j];
+          if (j > 0 && q2 >= subgrids[j-1]->q2s().front() && q2 < subgrids[j-1]->q2s().back())
+            subgrids[j] = subgrids[j-1];
+          else
+            subgrids[j] = &pdf().subgrid(id, q2);
+          stencils = _stencils(*subgrids[j], xs[i+j], q2, sxs[j], sqs[j]);
+        }
+        if (stencils) applyStencils(_simd, subgrids, n, sxs, sqs, rtn + i*stride, stride);
+      }
+      if (stencils) return;
+    }
+
+    size_t ixs[BLOCKSIZE], iq2s[BLOCKSIZE];
+    size_t i = 0;
+    while (i < npoints) {
+      // Look up the subgrid once for the run of following points in the same Q2 range, up to the block size
+      const KnotArray1F& subgrid = pdf().subgrid(id, q2s[i]);
+      const double q2lo = subgrid.q2s().front(), q2hi = subgrid.q2s().back();
+      size_t n = 1;
+      while (n < BLOCKSIZE && i+n < npoints && q2s[i+n] >= q2lo && q2s[i+n] < q2hi) ++n;
+      // Index look-ups, then the block interpolation
+      for (size_t j = 0; j < n; ++j) {
+        ixs[j] = subgrid.ixbelow(xs[i+j]);
+        iq2s[j] = subgrid.iq2below(q2s[i+j]);
+      }
+      _interpolateXQ2Batch(subgrid, n, xs+i, ixs, q2s+i, iq2s, rtn + i*stride, stride);
+      i += n;
+    }
+  }
+
+
+  void Interpolator::interpolateXQ2(const int* ids, size_t nids, double x, double q2, double* rtn) const {
+    const size_t MAXFLAVS = 32;
+    const KnotArray1F* subgrids[MAXFLAVS];
+    const KnotArrayNF& subgridnf = pdf().subgrid(q2);
+    for (size_t j0 = 0; j0 < nids; j0 += MAXFLAVS) {
+      const size_t n = min(MAXFLAVS, nids - j0);
+      // Gather the flavor arrays, checking whether they all share the same knots
+      bool shared = true;
+      for (size_t j = 0; j < n; ++j) {
+        subgrids[j] = &subgridnf.get_pid(ids[j0+j]);
+        if (subgrids[j]->axes() != subgrids[0]->axes()) shared = false;
+      }
+      KnotStencil sx, sq;
+      if (shared && _simd != SIMD_NONE && _stencils(*subgrids[0], x, q2, sx, sq)) {
+        // Stencil built once, including the index look-ups, then applied by the vectorised kernels
+        applyStencilNF(_simd, sx, sq, subgrids, n, rtn + j0);
+      } else if (shared && _querycache) {
+        // Cached or freshly computed weights, shared by the flavors
+        const KnotArrayNF* cachednf;
+        const CellWeights& w = _cachedWeights(x, q2, cachednf);
+        if (subgrids[0]->axes().get() == w.axes) {
+          for (size_t j = 0; j < n; ++j) rtn[j0+j] = _interpolateWeighted(*subgrids[j], w);
+        } else {
+          _interpolateXQ2NF(subgrids, n, x, subgrids[0]->ixbelow(x), q2, subgrids[0]->iq2below(q2), rtn + j0);
+        }
+      } else if (shared) {
+        // Index look-ups once, then the fused interpolation
+        const size_t ix = subgrids[0]->ixbelow(x);
+        const size_t iq2 = subgrids[0]->iq2below(q2);
+        _interpolateXQ2NF(subgrids, n, x, ix, q2, iq2, rtn + j0);
+      } else {
+        for (size_t j = 0; j < n; ++j)
+          rtn[j0+j] = _interpolateXQ2(*subgrids[j], x, subgrids[j]->ixbelow(x), q2, subgrids[j]->iq2below(q2));
+      }
+    }
+  }
+
+
+  void Interpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                       double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _interpolateXQ2(*subgrids[j], x, ix, q2, iq2);
+  }
+
+
+  void Interpolator::_cellWeights(const KnotArray1F& subgrid, CellWeights& w) const {
+    w.ix = subgrid.ixbelow(w.x);
+    w.iq2 = subgrid.iq2below(w.q2);
+  }
+
+
+  double Interpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    return _interpolateXQ2(subgrid, w.x, w.ix, w.q2, w.iq2);
+  }
+
+
+  void Interpolator::_interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                                          const double* xs, const size_t* ixs,
+                                          const double* q2s, const size_t* iq2s,
+                                          double* rtn, size_t stride) const {
+    for (size_t i = 0; i < npoints; ++i)
+      rtn[i*stride] = _interpolateXQ2(subgrid, xs[i], ixs[i], q2s[i], iq2s[i]);
+  }
+
+
 }
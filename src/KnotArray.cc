@@ -0,0 +1,111 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/KnotArray.h"
+
+namespace LHAPDF {
+
+
+  namespace { // Unnamed namespace
+
+    /// Minimum number of knots for which a bucket lookup is used
+    const size_t MINKNOTS = 16;
+
+    /// Derivative of the strided values ys at knot i of ts: central average, or one-sided at the edges
+    inline double _ddt(const std::vector<double>& ts, const double* ys, size_t stride, size_t i) {
+      const size_t n = ts.size();
+      if (i != 0 && i != n-1) {
+        const double ld = (ys[i*stride] - ys[(i-1)*stride]) / (ts[i] - ts[i-1]);
+        const double rd = (ys[(i+1)*stride] - ys[i*stride]) / (ts[i+1] - ts[i]);
+        return (ld + rd) / 2.0;
+      } else if (i == 0) {
+        return (ys[stride] - ys[0]) / (ts[1] - ts[0]);
+      } else {
+        return (ys[i*stride] - ys[(i-1)*stride]) / (ts[i] - ts[i-1]);
+      }
+    }
+
+  }
+
+
+  KnotLookup::KnotLookup(const std::vector<double>& knots, const std::vector<double>& logknots)
+    : _tmin(0), _invdt(0), _uniform(false)
+  {
+    // Leave empty, to use binary search, if the logs are unusable or the knots are not strictly increasing.
+    // Binary search is also faster than computing a log for short knot lists.
+    const size_t n = knots.size();
+    if (n < MINKNOTS || !(knots.front() > 0)) return;
+    double dtmin = logknots.back() - logknots.front();
+    for (size_t i = 0; i+1 < n; ++i) {
+      const double dt = logknots[i+1] - logknots[i];
+      if (!(dt > 0)) return;
+      dtmin = std::min(dtmin, dt);
+    }
+    _tmin = logknots.front();
+    const double trange = logknots.back() - _tmin;
+
+    // Exactly log-uniform knots need no table: the index follows directly from the spacing
+    const double dtavg = trange / (n-1);
+    _uniform = true;
+    for (size_t i = 1; i+1 < n; ++i) {
+      if (fabs(logknots[i] - (_tmin + i*dtavg)) > 1e-10*dtavg) {
+        _uniform = false;
+        break;
+      }
+    }
+    if (_uniform) {
+      _invdt = 1 / dtavg;
+      return;
+    }
+
+    // Otherwise make the buckets no wider than the smallest spacing, within a size limit
+    const size_t nbuckets = std::min(size_t(ceil(trange/dtmin)), 64*n);
+    _invdt = nbuckets / trange;
+    _buckets.resize(nbuckets);
+    size_t k = 0;
+    for (size_t b = 0; b < nbuckets; ++b) {
+      const double tedge = _tmin + b/_invdt;
+      while (k+2 < n && logknots[k+1] <= tedge) ++k;
+      _buckets[b] = k;
+    }
+  }
+
+
+  void KnotArray1F::computeGradients(bool logspace) {
+    if (hasGradients(logspace)) return;
+    if (xsize() < 2 || q2size() < 2)
+      throw GridError("Knot arrays need at least 2 knots in both x and Q2 to compute derivatives");
+    const std::vector<double>& ts_x = logspace ? logxs() : xs();
+    const std::vector<double>& ts_q2 = logspace ? logq2s() : q2s();
+    const size_t nx = xsize(), nq2 = q2size();
+
+    // Unpack the (possibly strided) xf values into a contiguous [ix][iQ2] array
+    std::vector<double> vals(size());
+    for (size_t ix = 0; ix < nx; ++ix)
+      for (size_t iq2 = 0; iq2 < nq2; ++iq2)
+        vals[ix*nq2 + iq2] = xf(ix, iq2);
+
+    // First derivatives along x, stepping across Q2 rows
+    std::vector<double> dxs(size());
+    for (size_t iq2 = 0; iq2 < nq2; ++iq2)
+      for (size_t ix = 0; ix < nx; ++ix)
+        dxs[ix*nq2 + iq2] = _ddt(ts_x, &vals[iq2], nq2, ix);
+
+    // Q2 derivatives of both the values and the x derivatives, interleaved into the table
+    std::shared_ptr<double> grads(new double[3*size()], std::default_delete<double[]>());
+    for (size_t ix = 0; ix < nx; ++ix) {
+      for (size_t iq2 = 0; iq2 < nq2; ++iq2) {
+        double* g = grads.get() + 3*(ix*nq2 + iq2);
+        g[0] = dxs[ix*nq2 + iq2];
+        g[1] = _ddt(ts_q2, &vals[ix*nq2], 1, iq2);
+        g[2] = _ddt(ts_q2, &dxs[ix*nq2], 1, iq2);
+      }
+    }
+    _grads = grads;
+    _gradslog = logspace;
+  }
+
+
+}
@@ -369,6 +369,15 @@ extern "C" {
     CURRENTSET = nset;
   }
 
+  /// Get the alpha_s(Q2) values at the n scales q2s, for set nset
+  void lhapdf_alphasq2_array_(const int& nset, const int& nmem, const int& n, const double* q2s, double* alphas) {
+    if (ACTIVESETS.find(nset) == ACTIVESETS.end())
+      throw LHAPDF::UserError("Trying to use LHAGLUE set #" + LHAPDF::to_str(nset) + " but it is not initialised");
+    if (n > 0) ACTIVESETS[nset].member(nmem)->alphasQ2(q2s, alphas, n);
+    // Update current set focus
+    CURRENTSET = nset;
+  }
+
   /// Get the alpha_s(Q) value for set nset
   /// @todo Return value rather than return arg? Can we do that elsewhere, too, e.g. single-value PDF xf functions?
   void lhapdf_alphasq_(const int& nset, const int& nmem, const double& q, double& alphas) {
@@ -762,12 +771,20 @@ extern "C" {
   void evolvepdfm_(const int& nset, const double& x, const double& q, double* fxq) {
     if (ACTIVESETS.find(nset) == ACTIVESETS.end())
       throw LHAPDF::UserError("Trying to use LHAGLUE set #" + LHAPDF::to_str(nset) + " but it is not initialised");
-    // Evaluate for the 13 LHAPDF5 standard partons (-6..6)
-    for (int i = 0; i < 13; ++i) {
-      try {
-        fxq[i] = ACTIVESETS[nset].activeMember()->xfxQ(i-6, x, q);
-      } catch (const exception& e) {
-        fxq[i] = 0;
+    // Evaluate for the 13 LHAPDF5 standard partons (-6..6), all at once
+    static const vector<int> ids = { -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6 };
+    const PDFPtr pdf = ACTIVESETS[nset].activeMember();
+    const double q2 = q*q;
+    try {
+      pdf->xfxQ2(ids, &x, &q2, 1, fxq);
+    } catch (const exception& e) {
+      // Fall back to one parton at a time, zeroing those which fail
+      for (int i = 0; i < 13; ++i) {
+        try {
+          fxq[i] = pdf->xfxQ(i-6, x, q);
+        } catch (const exception& e) {
+          fxq[i] = 0;
+        }
       }
     }
     // Update current set focus
@@ -0,0 +1,125 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/LazyPDFs.h"
+#include "LHAPDF/PDFSet.h"
+#include "LHAPDF/GridPDF.h"
+
+namespace LHAPDF {
+
+
+  namespace {
+
+    /// In-memory size of the grid data of a PDF, in bytes, including any derivative and patch tables
+    size_t _memsize(const PDF& pdf) {
+      const GridPDF* gpdf = dynamic_cast<const GridPDF*>(&pdf);
+      if (gpdf == 0) return 0;
+      size_t rtn = 0;
+      for (const pair<const double, KnotArrayNF>& q2_ka : gpdf->knotarrays()) {
+        const KnotArrayNF& arraynf = q2_ka.second;
+        for (int pid : arraynf.pids()) {
+          const KnotArray1F& ka = arraynf.get_pid(pid);
+          rtn += ka.size()*sizeof(double) + ka.gradientsMemSize() + ka.patchesMemSize();
+        }
+      }
+      return rtn;
+    }
+
+  }
+
+
+  LazyPDFs::LazyPDFs(const PDFSet& set, double budgetMB)
+    : _set(&set), _mutex(new mutex), _bytes(0), _tick(new atomic<uint64_t>(0))
+  {
+    if (budgetMB < 0) budgetMB = set.get_entry_as<double>("LazyMemoryBudget", 0);
+    _budget = 1e6 * budgetMB;
+    _slots.reserve(set.size());
+    for (size_t i = 0; i < set.size(); ++i) _slots.push_back(unique_ptr<_Slot>(new _Slot));
+  }
+
+
+  shared_ptr<PDF> LazyPDFs::at(size_t imem) const {
+    if (imem >= size())
+      throw UserError("Member " + to_str(imem) + " requested from PDF set " + set().name() + " with " + to_str(size()) + " members");
+    return _get(imem);
+  }
+
+
+  shared_ptr<PDF> LazyPDFs::_get(size_t imem) const {
+    _Slot& slot = *_slots[imem];
+    slot.lastuse = ++(*_tick);
+
+    // Fast path for an already loaded member
+    shared_ptr<PDF> rtn = atomic_load(&slot.pdf);
+    if (rtn) return rtn;
+
+    // Load the member once, with any concurrent requests for it waiting on the slot lock
+    lock_guard<mutex> loadlock(slot.loadmutex);
+    rtn = atomic_load(&slot.pdf);
+    if (rtn) return rtn;
+    rtn.reset(_set->mkPDF(imem));
+    const size_t bytes = _memsize(*rtn);
+
+    // Publish and account for the new member, and evict the least recently used others if over budget
+    lock_guard<mutex> lock(*_mutex);
+    atomic_store(&slot.pdf, rtn);
+    slot.bytes = bytes;
+    slot.resident = true;
+    _bytes += bytes;
+    while (_budget > 0 && _bytes > _budget) {
+      _Slot* lru = 0;
+      for (const unique_ptr<_Slot>& s : _slots) {
+        if (!s->resident || s.get() == &slot) continue;
+        if (lru == 0 || s->lastuse < lru->lastuse) lru = s.get();
+      }
+      if (lru == 0) break;
+      _evict(*lru);
+    }
+    return rtn;
+  }
+
+
+  void LazyPDFs::_evict(_Slot& slot) const {
+    if (!slot.resident) return;
+    atomic_store(&slot.pdf, shared_ptr<PDF>());
+    _bytes -= slot.bytes;
+    slot.bytes = 0;
+    slot.resident = false;
+  }
+
+
+  bool LazyPDFs::loaded(size_t imem) const {
+    return bool(atomic_load(&_slots[imem]->pdf));
+  }
+
+
+  size_t LazyPDFs::numLoaded() const {
+    lock_guard<mutex> lock(*_mutex);
+    size_t rtn = 0;
+    for (const unique_ptr<_Slot>& s : _slots)
+      if (s->resident) rtn += 1;
+    return rtn;
+  }
+
+
+  double LazyPDFs::memoryMB() const {
+    lock_guard<mutex> lock(*_mutex);
+    return _bytes / 1e6;
+  }
+
+
+  void LazyPDFs::evict(size_t imem) {
+    lock_guard<mutex> lock(*_mutex);
+    _evict(*_slots[imem]);
+  }
+
+
+  void LazyPDFs::clear() {
+    lock_guard<mutex> lock(*_mutex);
+    for (const unique_ptr<_Slot>& s : _slots) _evict(*s);
+  }
+
+
+}
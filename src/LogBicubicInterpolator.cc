@@ -4,7 +4,9 @@
 // Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
 //
 #include "LHAPDF/LogBicubicInterpolator.h"
+#include "LHAPDF/GridEvaluator.h"
 #include <iostream>
+#include <new>
 
 namespace LHAPDF {
 
@@ -18,19 +20,29 @@ namespace LHAPDF {
       return yl + (x - xl) / (xh - xl) * (yh - yl);
     }
 
-    /// One-dimensional cubic interpolation
-    inline double _interpolateCubic(double T, double VL, double VDL, double VH, double VDH) {
-      // Pre-calculate powers of T
-      const double t2 = T*T;
-      const double t3 = t2*T;
+    /// Cubic Hermite basis function values at T, shared by all the flavors interpolated at a point
+    struct _HermiteWeights {
+      _HermiteWeights(double T=0) {
+        // Pre-calculate powers of T
+        const double t2 = T*T;
+        const double t3 = t2*T;
+        h00 = 2*t3 - 3*t2 + 1;
+        h10 = t3 - 2*t2 + T;
+        h01 = -2*t3 + 3*t2;
+        h11 = t3 - t2;
+      }
+      double h00, h10, h01, h11;
+    };
 
+    /// One-dimensional cubic interpolation
+    inline double _interpolateCubic(const _HermiteWeights& w, double VL, double VDL, double VH, double VDH) {
       // Calculate left point
-      const double p0 = (2*t3 - 3*t2 + 1)*VL;
-      const double m0 = (t3 - 2*t2 + T)*VDL;
+      const double p0 = w.h00*VL;
+      const double m0 = w.h10*VDL;
 
       // Calculate right point
-      const double p1 = (-2*t3 + 3*t2)*VH;
-      const double m1 = (t3 - t2)*VDH;
+      const double p1 = w.h01*VH;
+      const double m1 = w.h11*VDH;
 
       return p0 + m0 + p1 + m1;
     }
@@ -54,93 +66,215 @@ namespace LHAPDF {
       }
     }
 
+
+    /// Position of a point in its (ix, iq2) cell and the interpolation weights, shared by all flavors with the same knots
+    struct _CellWeights {
+      _CellWeights(const KnotArray1F& subgrid, double logx, size_t ix, double logq2, size_t iq2)
+        : logx(logx), logq2(logq2), ix(ix), iq2(iq2), cubic(subgrid.q2size() >= 4)
+      {
+        if (!cubic) return; //< the bilinear fallback uses log(x) and log(Q2) directly
+
+        // Pre-calculate parameters
+        const vector<double>& logxs = subgrid.logxs();
+        const vector<double>& logq2s = subgrid.logq2s();
+        const size_t iq2max = logq2s.size() - 1;
+        dlogx_1 = logxs[ix+1] - logxs[ix];
+        hx = _HermiteWeights((logx - logxs[ix]) / dlogx_1);
+        dlogq_0 = (iq2 != 0) ? logq2s[iq2] - logq2s[iq2-1] : -1; //< Don't evaluate (or use) if iq2-1 < 0
+        dlogq_1 = logq2s[iq2+1] - logq2s[iq2];
+        dlogq_2 = (iq2+1 != iq2max) ? logq2s[iq2+2] - logq2s[iq2+1] : -1; //< Don't evaluate (or use) if iq2+2 > iq2max
+        hq = _HermiteWeights((logq2 - logq2s[iq2]) / dlogq_1);
+      }
+      double logx, logq2;
+      size_t ix, iq2;
+      bool cubic;
+      double dlogx_1, dlogq_0, dlogq_1, dlogq_2;
+      _HermiteWeights hx, hq;
+    };
+
+
+    /// Interpolate a single flavor at a point with precalculated cell weights
+    double _interpolateCell(const KnotArray1F& subgrid, const _CellWeights& w, bool precomputed) {
+      const size_t ix = w.ix, iq2 = w.iq2;
+      const size_t iq2max = subgrid.q2size() - 1;
+
+      // Fall back to LogBilinearInterpolator if either 2 or 3 Q-knots
+      if (!w.cubic) {
+        // First interpolate in x
+        const double logx0 = subgrid.logxs()[ix];
+        const double logx1 = subgrid.logxs()[ix+1];
+        const double f_ql = _interpolateLinear(w.logx, logx0, logx1, subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
+        const double f_qh = _interpolateLinear(w.logx, logx0, logx1, subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
+        // Then interpolate in Q2, using the x-ipol results as anchor points
+        return _interpolateLinear(w.logq2, subgrid.logq2s()[iq2], subgrid.logq2s()[iq2+1], f_ql, f_qh);
+      }
+      // else proceed with cubic interpolation:
+
+      const double dlogx_1 = w.dlogx_1;
+      const _HermiteWeights& tlogx = w.hx;
+      const _HermiteWeights& tlogq = w.hq;
+
+      // With precomputed knot derivatives, interpolate the values and the Q2 derivatives in x, then in Q2
+      if (precomputed && subgrid.hasGradients(true)) {
+        const double dlogq = w.dlogq_1;
+        const double vl = _interpolateCubic(tlogx, subgrid.xf(ix, iq2), subgrid.dxf_dx(ix, iq2) * dlogx_1,
+                                                   subgrid.xf(ix+1, iq2), subgrid.dxf_dx(ix+1, iq2) * dlogx_1);
+        const double vh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+1), subgrid.dxf_dx(ix, iq2+1) * dlogx_1,
+                                                   subgrid.xf(ix+1, iq2+1), subgrid.dxf_dx(ix+1, iq2+1) * dlogx_1);
+        const double vdl = _interpolateCubic(tlogx, subgrid.dxf_dq2(ix, iq2), subgrid.d2xf_dxdq2(ix, iq2) * dlogx_1,
+                                                    subgrid.dxf_dq2(ix+1, iq2), subgrid.d2xf_dxdq2(ix+1, iq2) * dlogx_1);
+        const double vdh = _interpolateCubic(tlogx, subgrid.dxf_dq2(ix, iq2+1), subgrid.d2xf_dxdq2(ix, iq2+1) * dlogx_1,
+                                                    subgrid.dxf_dq2(ix+1, iq2+1), subgrid.d2xf_dxdq2(ix+1, iq2+1) * dlogx_1);
+        return _interpolateCubic(tlogq, vl, vdl * dlogq, vh, vdh * dlogq);
+      }
+      const double dlogq_0 = w.dlogq_0, dlogq_1 = w.dlogq_1, dlogq_2 = w.dlogq_2;
+
+      /// @todo Statically pre-compute the whole nx * nq gradiant array? I.e. _dxf_dlogx for all points in all subgrids. Memory ~doubling :-/ Could cache them as they are used...
+
+      // Points in Q2
+      double vl = _interpolateCubic(tlogx, subgrid.xf(ix, iq2), _dxf_dlogx(subgrid, ix, iq2) * dlogx_1,
+                                           subgrid.xf(ix+1, iq2), _dxf_dlogx(subgrid, ix+1, iq2) * dlogx_1);
+      double vh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+1), _dxf_dlogx(subgrid, ix, iq2+1) * dlogx_1,
+                                           subgrid.xf(ix+1, iq2+1), _dxf_dlogx(subgrid, ix+1, iq2+1) * dlogx_1);
+
+      // Derivatives in Q2
+      double vdl, vdh;
+      if (iq2 > 0 && iq2+1 < iq2max) {
+        // Central difference for both q
+        /// @note We evaluate the most likely condition first to help compiler branch prediction
+        double vll = _interpolateCubic(tlogx, subgrid.xf(ix, iq2-1), _dxf_dlogx(subgrid, ix, iq2-1) * dlogx_1,
+                                              subgrid.xf(ix+1, iq2-1), _dxf_dlogx(subgrid, ix+1, iq2-1) * dlogx_1);
+        vdl = ( (vh - vl)/dlogq_1 + (vl - vll)/dlogq_0 ) / 2.0;
+        double vhh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+2), _dxf_dlogx(subgrid, ix, iq2+2) * dlogx_1,
+                                              subgrid.xf(ix+1, iq2+2), _dxf_dlogx(subgrid, ix+1, iq2+2) * dlogx_1);
+        vdh = ( (vh - vl)/dlogq_1 + (vhh - vh)/dlogq_2 ) / 2.0;
+      }
+      else if (iq2 == 0) {
+        // Forward difference for lower q
+        vdl = (vh - vl) / dlogq_1;
+        // Central difference for higher q
+        double vhh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+2), _dxf_dlogx(subgrid, ix, iq2+2) * dlogx_1,
+                                              subgrid.xf(ix+1, iq2+2), _dxf_dlogx(subgrid, ix+1, iq2+2) * dlogx_1);
+        vdh = (vdl + (vhh - vh)/dlogq_2) / 2.0;
+      }
+      else if (iq2+1 == iq2max) {
+        // Backward difference for higher q
+        vdh = (vh - vl) / dlogq_1;
+        // Central difference for lower q
+        double vll = _interpolateCubic(tlogx, subgrid.xf(ix, iq2-1), _dxf_dlogx(subgrid, ix, iq2-1) * dlogx_1,
+                                              subgrid.xf(ix+1, iq2-1), _dxf_dlogx(subgrid, ix+1, iq2-1) * dlogx_1);
+        vdl = (vdh + (vl - vll)/dlogq_0) / 2.0;
+      }
+      else throw LogicError("We shouldn't be able to get here!");
+
+      vdl *= dlogq_1;
+      vdh *= dlogq_1;
+      return _interpolateCubic(tlogq, vl, vdl, vh, vdh);
+    }
+
+
   }
 
 
 
+  void LogBicubicInterpolator::prepare(KnotArray1F& subgrid) const {
+    if (_precomputed && subgrid.xsize() > 1 && subgrid.q2size() > 1)
+      subgrid.computeGradients(true);
+  }
+
+
   double LogBicubicInterpolator::_interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const {
+    _checkKnots(subgrid);
+    _checkIndices(subgrid, ix, iq2);
+    return _interpolateLogXQ2(subgrid, log(x), ix, log(q2), iq2);
+  }
+
+
+  void LogBicubicInterpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                                 double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    // The flavors share the knots, so the checks, logs and weights are computed once
+    _checkKnots(*subgrids[0]);
+    _checkIndices(*subgrids[0], ix, iq2);
+    const _CellWeights w(*subgrids[0], log(x), ix, log(q2), iq2);
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _interpolateCell(*subgrids[j], w, _precomputed);
+  }
+
+
+  void LogBicubicInterpolator::_interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                                                    const double* xs, const size_t* ixs,
+                                                    const double* q2s, const size_t* iq2s,
+                                                    double* rtn, size_t stride) const {
+    // The knot counts are the same for the whole block: check them once
+    _checkKnots(subgrid);
+    for (size_t i = 0; i < npoints; ++i) {
+      _checkIndices(subgrid, ixs[i], iq2s[i]);
+      rtn[i*stride] = _interpolateLogXQ2(subgrid, log(xs[i]), ixs[i], log(q2s[i]), iq2s[i]);
+    }
+  }
+
+
+  void LogBicubicInterpolator::_checkKnots(const KnotArray1F& subgrid) const {
     // Raise an error if there are too few knots even for a linear fall-back
-    const size_t nxknots = subgrid.logxs().size();
-    const size_t nq2knots = subgrid.logq2s().size();
-    if (nxknots < 4)
+    if (subgrid.xsize() < 4)
       throw GridError("PDF subgrids are required to have at least 4 x-knots for use with LogBicubicInterpolator");
-    if (nq2knots < 2)
+    if (subgrid.q2size() < 2)
       throw GridError("PDF subgrids are required to have at least 2 Q-knots for use with LogBicubicInterpolator");
+  }
 
+
+  void LogBicubicInterpolator::_checkIndices(const KnotArray1F& subgrid, size_t ix, size_t iq2) const {
     // Check x and q index ranges -- we always need i and i+1 indices to be valid
-    const size_t ixmax = nxknots - 1;
-    const size_t iq2max = nq2knots - 1;
-    if (ix+1 > ixmax) // also true if ix is off the end
+    if (ix+1 > subgrid.xsize()-1) // also true if ix is off the end
       throw GridError("Attempting to access an x-knot index past the end of the array, in linear fallback mode");
-    if (iq2+1 > iq2max) // also true if iq2 is off the end
+    if (iq2+1 > subgrid.q2size()-1) // also true if iq2 is off the end
       throw GridError("Attempting to access an Q-knot index past the end of the array, in linear fallback mode");
+  }
 
-    const double logx = log(x);
-    const double logq2 = log(q2);
-
-    // Fall back to LogBilinearInterpolator if either 2 or 3 Q-knots
-    if (nq2knots < 4) {
-      // First interpolate in x
-      const double logx0 = subgrid.logxs()[ix];
-      const double logx1 = subgrid.logxs()[ix+1];
-      const double f_ql = _interpolateLinear(logx, logx0, logx1, subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
-      const double f_qh = _interpolateLinear(logx, logx0, logx1, subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
-      // Then interpolate in Q2, using the x-ipol results as anchor points
-      return _interpolateLinear(logq2, subgrid.logq2s()[iq2], subgrid.logq2s()[iq2+1], f_ql, f_qh);
-    }
-    // else proceed with cubic interpolation:
-
-    // Pre-calculate parameters
-    /// @todo Cache these between calls, re-using if x == x_prev and Q2 == Q2_prev
-    const double dlogx_1 = subgrid.logxs()[ix+1] - subgrid.logxs()[ix];
-    const double tlogx = (logx - subgrid.logxs()[ix]) / dlogx_1;
-    const double dlogq_0 = (iq2 != 0) ? subgrid.logq2s()[iq2] - subgrid.logq2s()[iq2-1] : -1; //< Don't evaluate (or use) if iq2-1 < 0
-    const double dlogq_1 = subgrid.logq2s()[iq2+1] - subgrid.logq2s()[iq2];
-    const double dlogq_2 = (iq2+1 != iq2max) ? subgrid.logq2s()[iq2+2] - subgrid.logq2s()[iq2+1] : -1; //< Don't evaluate (or use) if iq2+2 > iq2max
-    const double tlogq = (logq2 - subgrid.logq2s()[iq2]) / dlogq_1;
-
-    /// @todo Statically pre-compute the whole nx * nq gradiant array? I.e. _dxf_dlogx for all points in all subgrids. Memory ~doubling :-/ Could cache them as they are used...
-
-    // Points in Q2
-    double vl = _interpolateCubic(tlogx, subgrid.xf(ix, iq2), _dxf_dlogx(subgrid, ix, iq2) * dlogx_1,
-                                         subgrid.xf(ix+1, iq2), _dxf_dlogx(subgrid, ix+1, iq2) * dlogx_1);
-    double vh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+1), _dxf_dlogx(subgrid, ix, iq2+1) * dlogx_1,
-                                         subgrid.xf(ix+1, iq2+1), _dxf_dlogx(subgrid, ix+1, iq2+1) * dlogx_1);
-
-    // Derivatives in Q2
-    double vdl, vdh;
-    if (iq2 > 0 && iq2+1 < iq2max) {
-      // Central difference for both q
-      /// @note We evaluate the most likely condition first to help compiler branch prediction
-      double vll = _interpolateCubic(tlogx, subgrid.xf(ix, iq2-1), _dxf_dlogx(subgrid, ix, iq2-1) * dlogx_1,
-                                            subgrid.xf(ix+1, iq2-1), _dxf_dlogx(subgrid, ix+1, iq2-1) * dlogx_1);
-      vdl = ( (vh - vl)/dlogq_1 + (vl - vll)/dlogq_0 ) / 2.0;
-      double vhh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+2), _dxf_dlogx(subgrid, ix, iq2+2) * dlogx_1,
-                                            subgrid.xf(ix+1, iq2+2), _dxf_dlogx(subgrid, ix+1, iq2+2) * dlogx_1);
-      vdh = ( (vh - vl)/dlogq_1 + (vhh - vh)/dlogq_2 ) / 2.0;
-    }
-    else if (iq2 == 0) {
-      // Forward difference for lower q
-      vdl = (vh - vl) / dlogq_1;
-      // Central difference for higher q
-      double vhh = _interpolateCubic(tlogx, subgrid.xf(ix, iq2+2), _dxf_dlogx(subgrid, ix, iq2+2) * dlogx_1,
-                                            subgrid.xf(ix+1, iq2+2), _dxf_dlogx(subgrid, ix+1, iq2+2) * dlogx_1);
-      vdh = (vdl + (vhh - vh)/dlogq_2) / 2.0;
-    }
-    else if (iq2+1 == iq2max) {
-      // Backward difference for higher q
-      vdh = (vh - vl) / dlogq_1;
-      // Central difference for lower q
-      double vll = _interpolateCubic(tlogx, subgrid.xf(ix, iq2-1), _dxf_dlogx(subgrid, ix, iq2-1) * dlogx_1,
-                                            subgrid.xf(ix+1, iq2-1), _dxf_dlogx(subgrid, ix+1, iq2-1) * dlogx_1);
-      vdl = (vdh + (vl - vll)/dlogq_0) / 2.0;
+
+  double LogBicubicInterpolator::_interpolateLogXQ2(const KnotArray1F& subgrid, double logx, size_t ix, double logq2, size_t iq2) const {
+    return _interpolateCell(subgrid, _CellWeights(subgrid, logx, ix, logq2, iq2), _precomputed);
+  }
+
+
+  bool LogBicubicInterpolator::_stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const {
+    _checkKnots(subgrid);
+    // The logs are shared by the index look-ups and the weights
+    const double logx = log(x), logq2 = log(q2);
+    const size_t ix = subgrid.ixbelow(x, logx), iq2 = subgrid.iq2below(q2, logq2);
+    _checkIndices(subgrid, ix, iq2);
+    if (subgrid.q2size() < 4) {
+      // Fall back to log-bilinear interpolation if either 2 or 3 Q-knots
+      linearStencil(subgrid.logxs(), ix, logx, sx);
+      linearStencil(subgrid.logq2s(), iq2, logq2, sq);
+    } else {
+      cubicStencil(subgrid.logxs(), ix, logx, sx);
+      cubicStencil(subgrid.logq2s(), iq2, logq2, sq);
     }
-    else throw LogicError("We shouldn't be able to get here!");
+    return true;
+  }
 
-    vdl *= dlogq_1;
-    vdh *= dlogq_1;
-    return _interpolateCubic(tlogq, vl, vdl, vh, vdh);
+
+  void LogBicubicInterpolator::_cellWeights(const KnotArray1F& subgrid, CellWeights& w) const {
+    _checkKnots(subgrid);
+    w.logx = log(w.x);
+    w.logq2 = log(w.q2);
+    w.ix = subgrid.ixbelow(w.x, w.logx);
+    w.iq2 = subgrid.iq2below(w.q2, w.logq2);
+    _checkIndices(subgrid, w.ix, w.iq2);
+    new (w.data<_CellWeights>()) _CellWeights(subgrid, w.logx, w.ix, w.logq2, w.iq2);
+  }
+
+
+  double LogBicubicInterpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    return _interpolateCell(subgrid, *w.data<_CellWeights>(), _precomputed);
   }
 
 
+  // Compile the devirtualised evaluators for this interpolator here, so that its kernel can be inlined into them
+  template class GridEvaluator<LogBicubicInterpolator, ErrExtrapolator>;
+  template class GridEvaluator<LogBicubicInterpolator, NearestPointExtrapolator>;
+  template class GridEvaluator<LogBicubicInterpolator, ContinuationExtrapolator>;
+
+
 }
@@ -0,0 +1,160 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/LogBicubicPatchInterpolator.h"
+#include "LHAPDF/GridEvaluator.h"
+
+namespace LHAPDF {
+
+
+  namespace { // Unnamed namespace
+
+    /// Number of coefficients in a bicubic patch
+    const size_t NCOEFFS = 16;
+
+    /// Power-series coefficients of the cubic Hermite basis functions h00, h10, h01, h11 (rows)
+    const double HERMITE[4][4] = { {1, 0, -3,  2},
+                                   {0, 1, -2,  1},
+                                   {0, 0,  3, -2},
+                                   {0, 0, -1,  1} };
+
+
+    /// Local (log(x), log(Q2)) coordinates of a point in the cell with lower corner (ix, iq2)
+    inline double _tlogx(const KnotArray1F& subgrid, double logx, size_t ix) {
+      return (logx - subgrid.logxs()[ix]) / (subgrid.logxs()[ix+1] - subgrid.logxs()[ix]);
+    }
+    inline double _tlogq(const KnotArray1F& subgrid, double logq2, size_t iq2) {
+      return (logq2 - subgrid.logq2s()[iq2]) / (subgrid.logq2s()[iq2+1] - subgrid.logq2s()[iq2]);
+    }
+
+
+    /// Nested Horner evaluation of the cell polynomial @a a at local cell coordinates
+    inline double _evalPatch(const double* a, double tlogx, double tlogq) {
+      const double c0 = ((a[3]*tlogq + a[2])*tlogq + a[1])*tlogq + a[0];
+      const double c1 = ((a[7]*tlogq + a[6])*tlogq + a[5])*tlogq + a[4];
+      const double c2 = ((a[11]*tlogq + a[10])*tlogq + a[9])*tlogq + a[8];
+      const double c3 = ((a[15]*tlogq + a[14])*tlogq + a[13])*tlogq + a[12];
+      return ((c3*tlogx + c2)*tlogx + c1)*tlogx + c0;
+    }
+
+
+    /// Evaluate the cell polynomial at (log(x), log(Q2)), in the cell with lower corner (ix, iq2)
+    inline double _evalPatch(const KnotArray1F& subgrid, double logx, size_t ix, double logq2, size_t iq2) {
+      return _evalPatch(subgrid.patch(ix, iq2), _tlogx(subgrid, logx, ix), _tlogq(subgrid, logq2, iq2));
+    }
+
+  }
+
+
+  void LogBicubicPatchInterpolator::prepare(KnotArray1F& subgrid) const {
+    const size_t nx = subgrid.xsize(), nq2 = subgrid.q2size();
+    if (nx < 4 || nq2 < 4) return; //< handled by the LogBicubicInterpolator fallbacks
+
+    // The patches are built from the log-space knot derivatives, which are then discarded
+    const bool hadgrads = subgrid.hasGradients(true);
+    subgrid.computeGradients(true);
+
+    std::shared_ptr<double> patches(new double[NCOEFFS*subgrid.size()], std::default_delete<double[]>());
+    for (size_t ix = 0; ix+1 < nx; ++ix) {
+      const double dlogx = subgrid.logxs()[ix+1] - subgrid.logxs()[ix];
+      for (size_t iq2 = 0; iq2+1 < nq2; ++iq2) {
+        const double dlogq = subgrid.logq2s()[iq2+1] - subgrid.logq2s()[iq2];
+
+        // Hermite control values: rows are the x basis (f_l, f'_l, f_h, f'_h), columns the Q2 basis
+        double g[4][4];
+        for (size_t jx = 0; jx < 2; ++jx) {
+          for (size_t jq = 0; jq < 2; ++jq) {
+            g[2*jx][2*jq]     = subgrid.xf(ix+jx, iq2+jq);
+            g[2*jx+1][2*jq]   = subgrid.dxf_dx(ix+jx, iq2+jq) * dlogx;
+            g[2*jx][2*jq+1]   = subgrid.dxf_dq2(ix+jx, iq2+jq) * dlogq;
+            g[2*jx+1][2*jq+1] = subgrid.d2xf_dxdq2(ix+jx, iq2+jq) * dlogx * dlogq;
+          }
+        }
+
+        // Convert to power-series coefficients a[px][pq] of tx^px tq^pq
+        double* a = patches.get() + NCOEFFS*(ix*nq2 + iq2);
+        for (size_t px = 0; px < 4; ++px) {
+          for (size_t pq = 0; pq < 4; ++pq) {
+            double sum = 0;
+            for (size_t k = 0; k < 4; ++k) {
+              if (HERMITE[k][px] == 0) continue;
+              for (size_t l = 0; l < 4; ++l)
+                sum += HERMITE[k][px] * g[k][l] * HERMITE[l][pq];
+            }
+            a[4*px + pq] = sum;
+          }
+        }
+      }
+    }
+    subgrid.setPatches(patches, NCOEFFS);
+    if (!hadgrads) subgrid.clearGradients();
+  }
+
+
+  double LogBicubicPatchInterpolator::_interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const {
+    if (!subgrid.hasPatches(NCOEFFS))
+      return LogBicubicInterpolator::_interpolateXQ2(subgrid, x, ix, q2, iq2);
+
+    // Check x and q index ranges -- we always need i and i+1 indices to be valid
+    if (ix+1 > subgrid.xsize()-1) // also true if ix is off the end
+      throw GridError("Attempting to access an x-knot index past the end of the array");
+    if (iq2+1 > subgrid.q2size()-1) // also true if iq2 is off the end
+      throw GridError("Attempting to access an Q-knot index past the end of the array");
+
+    return _evalPatch(subgrid, log(x), ix, log(q2), iq2);
+  }
+
+
+  void LogBicubicPatchInterpolator::_interpolateXQ2Batch(const KnotArray1F& subgrid, size_t npoints,
+                                                         const double* xs, const size_t* ixs,
+                                                         const double* q2s, const size_t* iq2s,
+                                                         double* rtn, size_t stride) const {
+    if (!subgrid.hasPatches(NCOEFFS)) {
+      LogBicubicInterpolator::_interpolateXQ2Batch(subgrid, npoints, xs, ixs, q2s, iq2s, rtn, stride);
+      return;
+    }
+    for (size_t i = 0; i < npoints; ++i) {
+      // Check x and q index ranges -- we always need i and i+1 indices to be valid
+      if (ixs[i]+1 > subgrid.xsize()-1 || iq2s[i]+1 > subgrid.q2size()-1)
+        throw GridError("Attempting to access a knot index past the end of the array");
+      rtn[i*stride] = _evalPatch(subgrid, log(xs[i]), ixs[i], log(q2s[i]), iq2s[i]);
+    }
+  }
+
+
+  void LogBicubicPatchInterpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                                      double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    for (size_t j = 0; j < nflavs; ++j) {
+      if (!subgrids[j]->hasPatches(NCOEFFS)) {
+        LogBicubicInterpolator::_interpolateXQ2NF(subgrids, nflavs, x, ix, q2, iq2, rtn);
+        return;
+      }
+    }
+    // Check x and q index ranges -- we always need i and i+1 indices to be valid
+    if (ix+1 > subgrids[0]->xsize()-1 || iq2+1 > subgrids[0]->q2size()-1)
+      throw GridError("Attempting to access a knot index past the end of the array");
+    // The flavors share the knots, so the local cell coordinates are computed once
+    const double tlogx = _tlogx(*subgrids[0], log(x), ix);
+    const double tlogq = _tlogq(*subgrids[0], log(q2), iq2);
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _evalPatch(subgrids[j]->patch(ix, iq2), tlogx, tlogq);
+  }
+
+
+  double LogBicubicPatchInterpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    // The indices were checked when the weights were cached
+    if (!subgrid.hasPatches(NCOEFFS))
+      return LogBicubicInterpolator::_interpolateWeighted(subgrid, w);
+    return _evalPatch(subgrid, w.logx, w.ix, w.logq2, w.iq2);
+  }
+
+
+  // Compile the devirtualised evaluators for this interpolator here, so that its kernel can be inlined into them
+  template class GridEvaluator<LogBicubicPatchInterpolator, ErrExtrapolator>;
+  template class GridEvaluator<LogBicubicPatchInterpolator, NearestPointExtrapolator>;
+  template class GridEvaluator<LogBicubicPatchInterpolator, ContinuationExtrapolator>;
+
+
+}
@@ -4,36 +4,102 @@
 // Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
 //
 #include "LHAPDF/LogBilinearInterpolator.h"
+#include "LHAPDF/GridEvaluator.h"
 
 namespace LHAPDF {
 
 
   namespace { // Unnamed namespace
 
-    // One-dimensional linear interpolation for y(x)
-    inline double _interpolateLinear(double x, double xl, double xh, double yl, double yh)	{
+    /// The log(x) and log(Q2) weights of a point in its cell, as stored by the query cache
+    struct _LinearWeights {
+      double tlogx, tlogq;
+    };
+
+    // Weight of the upper point in one-dimensional linear interpolation for y(x)
+    inline double _linearWeight(double x, double xl, double xh) {
       assert(x >= xl);
       assert(xh >= x);
-      return yl + (x - xl) / (xh - xl) * (yh - yl);
+      return (x - xl) / (xh - xl);
+    }
+
+    // One-dimensional linear interpolation for y(x), given the upper-point weight
+    inline double _interpolateLinear(double t, double yl, double yh) {
+      return yl + t * (yh - yl);
+    }
+
+    /// Check that the subgrid has enough knots for log-bilinear interpolation
+    void _checkKnots(const KnotArray1F& subgrid) {
+      if (subgrid.logxs().size() < 2)
+        throw GridError("PDF subgrids are required to have at least 2 x-knots for use with LogBilinearInterpolator");
+      if (subgrid.logq2s().size() < 2)
+        throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with LogBilinearInterpolator");
+    }
+
+    /// Interpolate a single flavor, given the log(x) and log(Q2) weights in the (ix, iq2) cell
+    inline double _interpolateCell(const KnotArray1F& subgrid, size_t ix, size_t iq2, double tlogx, double tlogq) {
+      // First interpolate in x
+      const double f_ql = _interpolateLinear(tlogx, subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
+      const double f_qh = _interpolateLinear(tlogx, subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
+      // Then interpolate in Q2, using the x-ipol results as anchor points
+      return _interpolateLinear(tlogq, f_ql, f_qh);
     }
 
   }
 
 
   double LogBilinearInterpolator::_interpolateXQ2(const KnotArray1F& subgrid, double x, size_t ix, double q2, size_t iq2) const {
-    if (subgrid.logxs().size() < 2)
-      throw GridError("PDF subgrids are required to have at least 2 x-knots for use with LogBilinearInterpolator");
-    if (subgrid.logq2s().size() < 2)
-      throw GridError("PDF subgrids are required to have at least 2 Q2-knots for use with LogBilinearInterpolator");
-    // First interpolate in x
-    const double logx = log(x);
-    const double logx0 = subgrid.logxs()[ix];
-    const double logx1 = subgrid.logxs()[ix+1];
-    const double f_ql = _interpolateLinear(logx, logx0, logx1, subgrid.xf(ix, iq2), subgrid.xf(ix+1, iq2));
-    const double f_qh = _interpolateLinear(logx, logx0, logx1, subgrid.xf(ix, iq2+1), subgrid.xf(ix+1, iq2+1));
-    // Then interpolate in Q2, using the x-ipol results as anchor points
-    return _interpolateLinear(log(q2), subgrid.logq2s()[iq2], subgrid.logq2s()[iq2+1], f_ql, f_qh);
+    _checkKnots(subgrid);
+    const double tlogx = _linearWeight(log(x), subgrid.logxs()[ix], subgrid.logxs()[ix+1]);
+    const double tlogq = _linearWeight(log(q2), subgrid.logq2s()[iq2], subgrid.logq2s()[iq2+1]);
+    return _interpolateCell(subgrid, ix, iq2, tlogx, tlogq);
   }
 
 
+  void LogBilinearInterpolator::_interpolateXQ2NF(const KnotArray1F* const* subgrids, size_t nflavs,
+                                                  double x, size_t ix, double q2, size_t iq2, double* rtn) const {
+    // The flavors share the knots, so the checks, logs and weights are computed once
+    const KnotArray1F& subgrid = *subgrids[0];
+    _checkKnots(subgrid);
+    const double tlogx = _linearWeight(log(x), subgrid.logxs()[ix], subgrid.logxs()[ix+1]);
+    const double tlogq = _linearWeight(log(q2), subgrid.logq2s()[iq2], subgrid.logq2s()[iq2+1]);
+    for (size_t j = 0; j < nflavs; ++j)
+      rtn[j] = _interpolateCell(*subgrids[j], ix, iq2, tlogx, tlogq);
+  }
+
+
+  bool LogBilinearInterpolator::_stencils(const KnotArray1F& subgrid, double x, double q2, KnotStencil& sx, KnotStencil& sq) const {
+    _checkKnots(subgrid);
+    // The logs are shared by the index look-ups and the weights
+    const double logx = log(x), logq2 = log(q2);
+    linearStencil(subgrid.logxs(), subgrid.ixbelow(x, logx), logx, sx);
+    linearStencil(subgrid.logq2s(), subgrid.iq2below(q2, logq2), logq2, sq);
+    return true;
+  }
+
+
+  void LogBilinearInterpolator::_cellWeights(const KnotArray1F& subgrid, CellWeights& w) const {
+    _checkKnots(subgrid);
+    w.logx = log(w.x);
+    w.logq2 = log(w.q2);
+    w.ix = subgrid.ixbelow(w.x, w.logx);
+    w.iq2 = subgrid.iq2below(w.q2, w.logq2);
+    _LinearWeights& t = *w.data<_LinearWeights>();
+    t.tlogx = _linearWeight(w.logx, subgrid.logxs()[w.ix], subgrid.logxs()[w.ix+1]);
+    t.tlogq = _linearWeight(w.logq2, subgrid.logq2s()[w.iq2], subgrid.logq2s()[w.iq2+1]);
+  }
+
+
+  double LogBilinearInterpolator::_interpolateWeighted(const KnotArray1F& subgrid, const CellWeights& w) const {
+    const _LinearWeights& t = *w.data<_LinearWeights>();
+    return _interpolateCell(subgrid, w.ix, w.iq2, t.tlogx, t.tlogq);
+  }
+
+
+  // Compile the devirtualised evaluators for this interpolator here, so that its kernel can be inlined into them
+  template class GridEvaluator<LogBilinearInterpolator, ErrExtrapolator>;
+  template class GridEvaluator<LogBilinearInterpolator, NearestPointExtrapolator>;
+  template class GridEvaluator<LogBilinearInterpolator, ContinuationExtrapolator>;
+
+
 }
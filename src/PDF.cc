@@ -36,6 +36,15 @@ namespace LHAPDF {
   }
 
 
+  void PDF::_loadFlavors() const {
+    lock_guard<mutex> lock(_lazymutex);
+    if (_flavorsready.load(memory_order_relaxed)) return;
+    _flavors = info().get_entry_as< vector<int> >("Flavors");
+    sort(_flavors.begin(), _flavors.end());
+    _flavorsready.store(true, memory_order_release);
+  }
+
+
   bool PDF::hasFlavor(int id) const {
     const int id2 = (id != 0) ? id : 21; //< @note Treat 0 as an alias for 21
     const vector<int>& ids = flavors();
@@ -73,19 +82,112 @@ namespace LHAPDF {
   }
 
 
+  void PDF::xfxQ2(int id, const double* xs, const double* q2s, size_t npoints, double* rtn) const {
+    _xfxQ2Flavors(&id, 1, xs, q2s, npoints, rtn);
+  }
+
+
+  void PDF::xfxQ2(int id, const std::vector<double>& xs, const std::vector<double>& q2s, std::vector<double>& rtn) const {
+    if (xs.size() != q2s.size())
+      throw UserError("Batch xfxQ2 called with " + to_str(xs.size()) + " x values but " + to_str(q2s.size()) + " Q2 values");
+    rtn.resize(xs.size());
+    xfxQ2(id, xs.data(), q2s.data(), xs.size(), rtn.data());
+  }
+
+
+  void PDF::xfxQ2(const std::vector<int>& ids, const double* xs, const double* q2s, size_t npoints, double* rtn) const {
+    _xfxQ2Flavors(ids.data(), ids.size(), xs, q2s, npoints, rtn);
+  }
+
+
+  void PDF::_xfxQ2Flavors(const int* ids, size_t nids, const double* xs, const double* q2s, size_t npoints, double* rtn) const {
+    // Physical x and Q2 range checks, for all points before any evaluation
+    for (size_t i = 0; i < npoints; ++i) {
+      if (!inPhysicalRangeX(xs[i])) throw RangeError("Unphysical x given: " + to_str(xs[i]));
+      if (!inPhysicalRangeQ2(q2s[i])) throw RangeError("Unphysical Q2 given: " + to_str(q2s[i]));
+    }
+    const int forcepos = forcePositive();
+    if (forcepos < 0 || forcepos > 2) throw LogicError("ForcePositive value not in expected range!");
+
+    // Work through the PIDs in chunks, collecting the defined ones for the fused evaluation
+    const size_t MAXFLAVS = 32;
+    int defids[MAXFLAVS];
+    size_t defcols[MAXFLAVS];
+    double xfs[MAXFLAVS];
+    for (size_t j0 = 0; j0 < nids; j0 += MAXFLAVS) {
+      const size_t n = min(MAXFLAVS, nids - j0);
+      size_t ndef = 0;
+      for (size_t j = j0; j < j0+n; ++j) {
+        // Treat PID = 0 as always equivalent to a gluon: query as PID = 21
+        const int id2 = (ids[j] != 0) ? ids[j] : 21;
+        if (hasFlavor(id2)) {
+          defids[ndef] = id2;
+          defcols[ndef] = j;
+          ndef += 1;
+        } else {
+          // Undefined PIDs
+          for (size_t i = 0; i < npoints; ++i) rtn[i*nids + j] = 0.0;
+        }
+      }
+      if (ndef == 0) continue;
+
+      // Call the delegated methods in the concrete PDF object to calculate the in-range values:
+      // a single flavor is evaluated over all the points at once, several flavors point by point
+      if (ndef == 1) {
+        _xfxQ2Batch(defids[0], xs, q2s, npoints, rtn + defcols[0], nids);
+      } else {
+        for (size_t i = 0; i < npoints; ++i) {
+          _xfxQ2NF(defids, ndef, xs[i], q2s[i], xfs);
+          for (size_t k = 0; k < ndef; ++k) rtn[i*nids + defcols[k]] = xfs[k];
+        }
+      }
+
+      // Apply positivity forcing at the enabled level
+      if (forcepos == 0) continue;
+      const double xfmin = (forcepos == 1) ? 0 : 1e-10;
+      for (size_t k = 0; k < ndef; ++k) {
+        double* const rtnk = rtn + defcols[k];
+        for (size_t i = 0; i < npoints; ++i) if (rtnk[i*nids] < xfmin) rtnk[i*nids] = xfmin;
+      }
+    }
+  }
+
+
+  void PDF::_xfxQ2NF(const int* ids, size_t nids, double x, double q2, double* rtn) const {
+    for (size_t j = 0; j < nids; ++j) rtn[j] = _xfxQ2(ids[j], x, q2);
+  }
+
+
+  void PDF::_xfxQ2Batch(int id, const double* xs, const double* q2s, size_t npoints, double* rtn, size_t stride) const {
+    for (size_t i = 0; i < npoints; ++i) rtn[i*stride] = _xfxQ2(id, xs[i], q2s[i]);
+  }
+
+
   void PDF::xfxQ2(double x, double q2, std::map<int, double>& rtn) const {
-    rtn.clear();
-    for (int id : flavors()) rtn[id] = xfxQ2(id, x, q2);
+    const vector<int>& ids = flavors();
+    // Update the values in place if the map already holds exactly these PIDs, as when reused
+    const bool inplace = rtn.size() == ids.size() &&
+      equal(ids.begin(), ids.end(), rtn.begin(), [](int id, const pair<const int, double>& id_xf) { return id == id_xf.first; });
+    if (!inplace) rtn.clear();
+    // Evaluate the PIDs in chunks, into a buffer on the stack
+    const size_t MAXFLAVS = 32;
+    double xfs[MAXFLAVS];
+    map<int, double>::iterator it = rtn.begin();
+    for (size_t j0 = 0; j0 < ids.size(); j0 += MAXFLAVS) {
+      const size_t n = min(MAXFLAVS, ids.size() - j0);
+      _xfxQ2Flavors(ids.data() + j0, n, &x, &q2, 1, xfs);
+      for (size_t j = 0; j < n; ++j) {
+        if (inplace) (it++)->second = xfs[j];
+        else rtn[ids[j0+j]] = xfs[j];
+      }
+    }
   }
 
 
   void PDF::xfxQ2(double x, double q2, std::vector<double>& rtn) const {
-    rtn.clear();
-    rtn.resize(13);
-    for (int i = 0; i < 13; ++i) {
-      const int id = i-6; // PID = 0 is automatically treated as PID = 21
-      rtn[i] = xfxQ2(id, x, q2);
-    }
+    static const int IDS[13] = { -6, -5, -4, -3, -2, -1, 0, 1, 2, 3, 4, 5, 6 }; //< PID = 0 is automatically treated as PID = 21
+    rtn.resize(13); //< Every entry is overwritten, so no clearing, and no reallocation once sized
+    _xfxQ2Flavors(IDS, 13, &x, &q2, 1, rtn.data());
   }
 
 
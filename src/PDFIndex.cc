@@ -6,12 +6,15 @@
 #include "LHAPDF/PDFIndex.h"
 #include "LHAPDF/Paths.h"
 #include "LHAPDF/Exceptions.h"
+#include <mutex>
 
 namespace LHAPDF {
 
 
   std::map<int, std::string>& getPDFIndex() {
     static map<int, string> _lhaindex;
+    static mutex _lhaindex_mutex; //< Populate only once if called from several threads
+    lock_guard<mutex> lock(_lhaindex_mutex);
     if (_lhaindex.empty()) { // The map needs to be populated first
       string indexpath = findFile("pdfsets.index");
       if (indexpath.empty()) throw ReadError("Could not find a pdfsets.index file");
@@ -4,6 +4,12 @@
 // Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
 //
 #include "LHAPDF/PDFSet.h"
+#include "LHAPDF/PDF.h"
+#include "LHAPDF/UncertaintyAccumulator.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
 
 namespace LHAPDF {
 
@@ -30,138 +36,79 @@ namespace LHAPDF {
   }
 
 
-  double PDFSet::errorConfLevel() const {
-    // Return -1 or similar invalid value if errorType is replicas: requires changes in uncertainty code below.
-    return get_entry_as<double>("ErrorConfLevel", (!startswith(errorType(), "replicas")) ? 100*erf(1/sqrt(2)) : -1);
+  namespace {
+    /// Lock for the knot-axes interning, which may be called from concurrent member loads
+    mutex _knotaxes_mutex;
   }
 
 
-
-  PDFUncertainty PDFSet::uncertainty(const vector<double>& values, double cl, bool alternative) const {
-    if (values.size() != size())
-      throw UserError("Error in LHAPDF::PDFSet::uncertainty. Input vector must contain values for all PDF members.");
-
-    // PDF members labelled 0 to nmem, excluding possible parameter variations.
-    size_t nmem = size()-1;
-    const size_t npar = countchar(errorType(), '+');
-    nmem -= 2*npar;
-
-    if (nmem <= 0)
-      throw UserError("Error in LHAPDF::PDFSet::uncertainty. PDF set must contain more than just the central value.");
-
-    // Get set- and requested conf levels (converted from %) and check sanity (req CL = set CL if cl < 0).
-    // For replica sets, we internally use a nominal setCL corresponding to 1-sigma, since errorConfLevel() == -1.
-    const double setCL = (!startswith(errorType(), "replicas")) ? errorConfLevel() / 100.0 : erf(1/sqrt(2));
-    const double reqCL = (cl >= 0) ? cl / 100.0 : setCL; // convert from percentage
-    if (!in_range(reqCL, 0, 1) || !in_range(setCL, 0, 1))
-      throw UserError("Error in LHAPDF::PDFSet::uncertainty. Requested or PDF set confidence level outside [0,1] range.");
-
-    // Return value
-    PDFUncertainty rtn;
-    rtn.central = values[0];
-
-    if (alternative && startswith(errorType(), "replicas")) {
-
-      // Compute median and requested CL directly from probability distribution of replicas.
-      // Sort "values" into increasing order, ignoring zeroth member (average over replicas).
-      // Also ignore possible parameter variations included at the end of the set.
-      vector<double> sorted = values;
-      sort(sorted.begin()+1, sorted.end()-2*npar);
-      // Define central value to be median.
-      if (nmem % 2) { // odd nmem => one middle value
-        rtn.central = sorted[nmem/2 + 1];
-      } else { // even nmem => average of two middle values
-        rtn.central = 0.5*(sorted[nmem/2] + sorted[nmem/2 + 1]);
-      }
-      // Define uncertainties via quantiles with a CL given by reqCL.
-      const int upper = round(0.5*(1+reqCL)*nmem); // round to nearest integer
-      const int lower = 1 + round(0.5*(1-reqCL)*nmem); // round to nearest integer
-      rtn.errplus = sorted[upper] - rtn.central;
-      rtn.errminus = rtn.central - sorted[lower];
-      rtn.errsymm = 0.5*(rtn.errplus + rtn.errminus); // symmetrised
-
-    } else if (alternative) {
-
-      throw UserError("Error in LHAPDF::PDFSet::uncertainty. This PDF set is not in the format of replicas.");
-
-    } else if (startswith(errorType(), "replicas")) {
-
-      // Calculate the average and standard deviation using Eqs. (2.3) and (2.4) of arXiv:1106.5788v2.
-      double av = 0.0, sd = 0.0;
-      for (size_t imem = 1; imem <= nmem; imem++) {
-        av += values[imem];
-        sd += sqr(values[imem]);
+  void PDFSet::_mkPDFs(vector<PDF*>& pdfs, int nthreads) const {
+    const size_t nmem = size();
+    if (nthreads < 0) nthreads = get_entry_as<int>("LoadThreads", 1);
+    if (nthreads == 0) nthreads = max(thread::hardware_concurrency(), 1u);
+    nthreads = min(size_t(nthreads), max(nmem, size_t(1)));
+
+    // Each thread takes the next unloaded member until all are done
+    pdfs.assign(nmem, 0);
+    vector<exception_ptr> errors(nmem);
+    atomic<size_t> next(0);
+    auto work = [&]() {
+      for (size_t i = next++; i < nmem; i = next++) {
+        try {
+          pdfs[i] = mkPDF(i);
+        } catch (...) {
+          errors[i] = current_exception();
+        }
       }
-      av /= nmem; sd /= nmem;
-      sd = nmem/(nmem-1.0)*(sd-sqr(av));
-      sd = (sd > 0.0 && nmem > 1) ? sqrt(sd) : 0.0;
-      rtn.central = av;
-      rtn.errplus = rtn.errminus = rtn.errsymm = sd;
-
-    } else if (startswith(errorType(), "symmhessian")) {
-
-      double errsymm = 0;
-      for (size_t ieigen = 1; ieigen <= nmem; ieigen++)
-        errsymm += sqr(values[ieigen]-values[0]);
-      errsymm = sqrt(errsymm);
-      rtn.errplus = rtn.errminus = rtn.errsymm = errsymm;
+    };
+    vector<thread> threads;
+    for (int i = 1; i < nthreads; ++i) threads.push_back(thread(work));
+    work();
+    for (thread& t : threads) t.join();
+
+    // Clean up and report the first error, if any
+    for (size_t i = 0; i < nmem; ++i) {
+      if (!errors[i]) continue;
+      for (PDF* pdf : pdfs) delete pdf;
+      pdfs.clear();
+      rethrow_exception(errors[i]);
+    }
+  }
 
-    } else if (startswith(errorType(), "hessian")) {
 
-      // Calculate the asymmetric and symmetric Hessian uncertainties
-      // using Eqs. (2.1), (2.2) and (2.6) of arXiv:1106.5788v2.
-      double errplus = 0, errminus = 0, errsymm = 0;
-      for (size_t ieigen = 1; ieigen <= nmem/2; ieigen++) {
-        errplus += sqr(max(max(values[2*ieigen-1]-values[0],values[2*ieigen]-values[0]), 0.0));
-        errminus += sqr(max(max(values[0]-values[2*ieigen-1],values[0]-values[2*ieigen]), 0.0));
-        errsymm += sqr(values[2*ieigen-1]-values[2*ieigen]);
+  shared_ptr<const KnotAxes> PDFSet::knotAxes(const vector<double>& xs, const vector<double>& q2s) {
+    lock_guard<mutex> lock(_knotaxes_mutex);
+    shared_ptr<const KnotAxes> rtn;
+    // Look for a live match, dropping the entries whose axes have been freed
+    for (size_t i = 0; i < _knotaxes.size(); ) {
+      shared_ptr<const KnotAxes> axes = _knotaxes[i].lock();
+      if (!axes) {
+        _knotaxes.erase(_knotaxes.begin() + i);
+        continue;
       }
-      rtn.errsymm = 0.5*sqrt(errsymm);
-      rtn.errplus = sqrt(errplus);
-      rtn.errminus = sqrt(errminus);
-
-    } else {
-      throw MetadataError("\"ErrorType: " + errorType() + "\" not supported by LHAPDF::PDFSet::uncertainty.");
+      if (!rtn && axes->matches(xs, q2s)) rtn = axes;
+      ++i;
     }
-
-    if (setCL != reqCL) {
-      // Apply scaling to Hessian sets or replica sets with alternative=false.
-
-      // Calculate the qth quantile of the chi-squared distribution with one degree of freedom.
-      // Examples: quantile(dist, q) = {0.988946, 1, 2.70554, 3.84146, 4} for q = {0.68, 1-sigma, 0.90, 0.95, 2-sigma}.
-      double qsetCL = chisquared_quantile(setCL, 1);
-      double qreqCL = chisquared_quantile(reqCL, 1);
-      // Scale uncertainties from the original set CL to the requested CL.
-      const double scale = sqrt(qreqCL/qsetCL);
-      rtn.scale = scale;
-      if (!alternative) {
-        rtn.errplus *= scale;
-        rtn.errminus *= scale;
-        rtn.errsymm *= scale;
-      }
-
+    if (!rtn) {
+      rtn = make_shared<KnotAxes>(xs, q2s);
+      _knotaxes.push_back(rtn);
     }
+    return rtn;
+  }
 
-    rtn.errplus_pdf = rtn.errplus;
-    rtn.errminus_pdf = rtn.errminus;
-    rtn.errsymm_pdf = rtn.errsymm;
-    if (npar > 0) {
 
-      // All individual parameter variation uncertainties are added in quadrature.
-      double err_par = 0;
-      for (size_t ipar = 1; ipar <= npar; ipar++) {
-        err_par += sqr(values[nmem+2*ipar-1]-values[nmem+2*ipar]);
-      }
-      // Calculate total uncertainty from parameter variation with same scaling as for PDF uncertainty.
-      rtn.err_par = rtn.scale * 0.5 * sqrt(err_par);
-      // Add parameter variation uncertainty in quadrature with PDF uncertainty.
-      rtn.errplus = sqrt( sqr(rtn.errplus_pdf) + sqr(rtn.err_par) );
-      rtn.errminus = sqrt( sqr(rtn.errminus_pdf) + sqr(rtn.err_par) );
-      rtn.errsymm = sqrt( sqr(rtn.errsymm_pdf) + sqr(rtn.err_par) );
+  double PDFSet::errorConfLevel() const {
+    // Return -1 or similar invalid value if errorType is replicas: requires changes in uncertainty code below.
+    return get_entry_as<double>("ErrorConfLevel", (!startswith(errorType(), "replicas")) ? 100*erf(1/sqrt(2)) : -1);
+  }
 
-    }
 
-    return rtn;
+
+  PDFUncertainty PDFSet::uncertainty(const vector<double>& values, double cl, bool alternative) const {
+    if (values.size() != size())
+      throw UserError("Error in LHAPDF::PDFSet::uncertainty. Input vector must contain values for all PDF members.");
+    // An accumulator without observables resolves the set layout, and applies the formulae to the values
+    return UncertaintyAccumulator(*this, 0, cl).uncertainty(values.data(), alternative);
   }
 
 
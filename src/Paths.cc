@@ -47,6 +47,17 @@ namespace LHAPDF {
   }
 
 
+  std::string cachePath() {
+    const char* cachevar = getenv("LHAPDF_CACHE");
+    return (cachevar != 0) ? cachevar : "";
+  }
+
+
+  void setCachePath(const std::string& path) {
+    setenv("LHAPDF_CACHE", path.c_str(), 1);
+  }
+
+
   const std::vector<std::string>& availablePDFSets() {
     // Cached path list
     static vector<string> rtn;
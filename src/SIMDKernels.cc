@@ -0,0 +1,363 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/SIMDKernels.h"
+
+// The vectorised kernels are built for x86 with GCC-compatible compilers, using per-function target attributes
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LHAPDF_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace LHAPDF {
+
+
+  namespace {
+
+    /// Maximum number of flavors in a single applyStencilNF call
+    const size_t MAXFLAVS = 32;
+
+    /// Number of points per applyStencils kernel call
+    const size_t BLOCKSIZE = 64;
+
+    /// Maximum number of knots in a stencil
+    const size_t MAXKNOTS = 4;
+
+    /// Round a vector length up to a whole number of AVX-512 registers
+    inline size_t _padded(size_t n) { return (n + 7) & ~size_t(7); }
+
+
+    /// @brief Stencil contraction kernel signatures
+    ///
+    /// Compute rtn[j] = sum_b wq[b] sum_a wx[a] v[(a*nq+b)*ld+j] for j < ld,
+    /// with ld a multiple of 8. The weights are either the same for all j, for
+    /// the flavor kernels, or given per j as wx[a*ld+j] and wq[b*ld+j], for the
+    /// point kernels.
+    typedef void (*ContractFn)(size_t nx, size_t nq, const double* wx, const double* wq,
+                               const double* v, size_t ld, double* rtn);
+
+
+    void _contractFlavorsScalar(size_t nx, size_t nq, const double* wx, const double* wq,
+                                const double* v, size_t ld, double* rtn) {
+      for (size_t j = 0; j < ld; ++j) {
+        double acc = 0;
+        for (size_t b = 0; b < nq; ++b) {
+          double r = 0;
+          for (size_t a = 0; a < nx; ++a) r += wx[a] * v[(a*nq + b)*ld + j];
+          acc += wq[b] * r;
+        }
+        rtn[j] = acc;
+      }
+    }
+
+    void _contractPointsScalar(size_t nx, size_t nq, const double* wx, const double* wq,
+                               const double* v, size_t ld, double* rtn) {
+      for (size_t j = 0; j < ld; ++j) {
+        double acc = 0;
+        for (size_t b = 0; b < nq; ++b) {
+          double r = 0;
+          for (size_t a = 0; a < nx; ++a) r += wx[a*ld + j] * v[(a*nq + b)*ld + j];
+          acc += wq[b*ld + j] * r;
+        }
+        rtn[j] = acc;
+      }
+    }
+
+
+    #ifdef LHAPDF_SIMD_X86
+
+    __attribute__((target("sse2")))
+    void _contractFlavorsSSE2(size_t nx, size_t nq, const double* wx, const double* wq,
+                              const double* v, size_t ld, double* rtn) {
+      __m128d bwx[MAXKNOTS], bwq[MAXKNOTS];
+      for (size_t a = 0; a < nx; ++a) bwx[a] = _mm_set1_pd(wx[a]);
+      for (size_t b = 0; b < nq; ++b) bwq[b] = _mm_set1_pd(wq[b]);
+      for (size_t j = 0; j < ld; j += 2) {
+        __m128d acc = _mm_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m128d r = _mm_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm_add_pd(r, _mm_mul_pd(bwx[a], _mm_loadu_pd(v + (a*nq + b)*ld + j)));
+          acc = _mm_add_pd(acc, _mm_mul_pd(bwq[b], r));
+        }
+        _mm_storeu_pd(rtn + j, acc);
+      }
+    }
+
+    __attribute__((target("sse2")))
+    void _contractPointsSSE2(size_t nx, size_t nq, const double* wx, const double* wq,
+                             const double* v, size_t ld, double* rtn) {
+      for (size_t j = 0; j < ld; j += 2) {
+        __m128d acc = _mm_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m128d r = _mm_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm_add_pd(r, _mm_mul_pd(_mm_loadu_pd(wx + a*ld + j), _mm_loadu_pd(v + (a*nq + b)*ld + j)));
+          acc = _mm_add_pd(acc, _mm_mul_pd(_mm_loadu_pd(wq + b*ld + j), r));
+        }
+        _mm_storeu_pd(rtn + j, acc);
+      }
+    }
+
+
+    __attribute__((target("avx2,fma")))
+    void _contractFlavorsAVX2(size_t nx, size_t nq, const double* wx, const double* wq,
+                              const double* v, size_t ld, double* rtn) {
+      __m256d bwx[MAXKNOTS], bwq[MAXKNOTS];
+      for (size_t a = 0; a < nx; ++a) bwx[a] = _mm256_set1_pd(wx[a]);
+      for (size_t b = 0; b < nq; ++b) bwq[b] = _mm256_set1_pd(wq[b]);
+      for (size_t j = 0; j < ld; j += 4) {
+        __m256d acc = _mm256_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m256d r = _mm256_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm256_fmadd_pd(bwx[a], _mm256_loadu_pd(v + (a*nq + b)*ld + j), r);
+          acc = _mm256_fmadd_pd(bwq[b], r, acc);
+        }
+        _mm256_storeu_pd(rtn + j, acc);
+      }
+    }
+
+    __attribute__((target("avx2,fma")))
+    void _contractPointsAVX2(size_t nx, size_t nq, const double* wx, const double* wq,
+                             const double* v, size_t ld, double* rtn) {
+      for (size_t j = 0; j < ld; j += 4) {
+        __m256d acc = _mm256_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m256d r = _mm256_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm256_fmadd_pd(_mm256_loadu_pd(wx + a*ld + j), _mm256_loadu_pd(v + (a*nq + b)*ld + j), r);
+          acc = _mm256_fmadd_pd(_mm256_loadu_pd(wq + b*ld + j), r, acc);
+        }
+        _mm256_storeu_pd(rtn + j, acc);
+      }
+    }
+
+
+    __attribute__((target("avx512f")))
+    void _contractFlavorsAVX512(size_t nx, size_t nq, const double* wx, const double* wq,
+                                const double* v, size_t ld, double* rtn) {
+      __m512d bwx[MAXKNOTS], bwq[MAXKNOTS];
+      for (size_t a = 0; a < nx; ++a) bwx[a] = _mm512_set1_pd(wx[a]);
+      for (size_t b = 0; b < nq; ++b) bwq[b] = _mm512_set1_pd(wq[b]);
+      for (size_t j = 0; j < ld; j += 8) {
+        __m512d acc = _mm512_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m512d r = _mm512_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm512_fmadd_pd(bwx[a], _mm512_loadu_pd(v + (a*nq + b)*ld + j), r);
+          acc = _mm512_fmadd_pd(bwq[b], r, acc);
+        }
+        _mm512_storeu_pd(rtn + j, acc);
+      }
+    }
+
+    __attribute__((target("avx512f")))
+    void _contractPointsAVX512(size_t nx, size_t nq, const double* wx, const double* wq,
+                               const double* v, size_t ld, double* rtn) {
+      for (size_t j = 0; j < ld; j += 8) {
+        __m512d acc = _mm512_setzero_pd();
+        for (size_t b = 0; b < nq; ++b) {
+          __m512d r = _mm512_setzero_pd();
+          for (size_t a = 0; a < nx; ++a)
+            r = _mm512_fmadd_pd(_mm512_loadu_pd(wx + a*ld + j), _mm512_loadu_pd(v + (a*nq + b)*ld + j), r);
+          acc = _mm512_fmadd_pd(_mm512_loadu_pd(wq + b*ld + j), r, acc);
+        }
+        _mm512_storeu_pd(rtn + j, acc);
+      }
+    }
+
+    #endif
+
+
+    /// The flavor contraction kernel for a SIMD level, capped at the supported one
+    ContractFn _flavorContractor(SIMDLevel level) {
+      switch (min(level, simdLevelSupported())) {
+      #ifdef LHAPDF_SIMD_X86
+      case SIMD_AVX512: return _contractFlavorsAVX512;
+      case SIMD_AVX2: return _contractFlavorsAVX2;
+      case SIMD_SSE2: return _contractFlavorsSSE2;
+      #endif
+      default: return _contractFlavorsScalar;
+      }
+    }
+
+    /// The point contraction kernel for a SIMD level, capped at the supported one
+    ContractFn _pointContractor(SIMDLevel level) {
+      switch (min(level, simdLevelSupported())) {
+      #ifdef LHAPDF_SIMD_X86
+      case SIMD_AVX512: return _contractPointsAVX512;
+      case SIMD_AVX2: return _contractPointsAVX2;
+      case SIMD_SSE2: return _contractPointsSSE2;
+      #endif
+      default: return _contractPointsScalar;
+      }
+    }
+
+  }
+
+
+
+  SIMDLevel simdLevelSupported() {
+    #ifdef LHAPDF_SIMD_X86
+    static const SIMDLevel level = []() {
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+      if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SIMD_AVX2;
+      if (__builtin_cpu_supports("sse2")) return SIMD_SSE2;
+      return SIMD_NONE;
+    }();
+    return level;
+    #else
+    return SIMD_NONE;
+    #endif
+  }
+
+
+  std::string simdLevelName(SIMDLevel level) {
+    switch (level) {
+    case SIMD_SSE2: return "sse2";
+    case SIMD_AVX2: return "avx2";
+    case SIMD_AVX512: return "avx512";
+    default: return "none";
+    }
+  }
+
+
+  SIMDLevel simdLevelFromName(const std::string& name) {
+    const string lname = to_lower(name);
+    SIMDLevel level;
+    if (lname == "auto") return simdLevelSupported();
+    else if (lname == "none") level = SIMD_NONE;
+    else if (lname == "sse2") level = SIMD_SSE2;
+    else if (lname == "avx2") level = SIMD_AVX2;
+    else if (lname == "avx512") level = SIMD_AVX512;
+    else throw UserError("Unknown SIMD level '" + name + "': valid values are none, sse2, avx2, avx512 and auto");
+    return min(level, simdLevelSupported());
+  }
+
+
+
+  void linearStencil(const std::vector<double>& knots, size_t i, double v, KnotStencil& s) {
+    const double t = (v - knots[i]) / (knots[i+1] - knots[i]);
+    s.i0 = i;
+    s.n = 2;
+    s.w[0] = 1 - t;
+    s.w[1] = t;
+    s.w[2] = s.w[3] = 0;
+  }
+
+
+  void cubicStencil(const std::vector<double>& knots, size_t i, double v, KnotStencil& s) {
+    const size_t nknots = knots.size();
+    assert(nknots >= 4);
+    assert(i+1 < nknots);
+
+    // Hermite basis weights, for the values and the derivatives scaled by the knot spacing
+    const double d = knots[i+1] - knots[i];
+    const double t = (v - knots[i]) / d;
+    const double t2 = t*t, t3 = t2*t;
+    const double h00 = 2*t3 - 3*t2 + 1, h10 = t3 - 2*t2 + t;
+    const double h01 = -2*t3 + 3*t2, h11 = t3 - t2;
+
+    // Weights of the values at knots i-1, i, i+1 and i+2
+    double c[4] = { 0, h00, h01, 0 };
+    // Add the finite-difference derivative at knot m with coefficient g, where k = m - (i-1)
+    const auto adddiff = [&](size_t m, size_t k, double g) {
+      if (m == 0) { //< forward difference at the lower edge
+        const double gr = g / (knots[1] - knots[0]);
+        c[k] -= gr; c[k+1] += gr;
+      } else if (m == nknots-1) { //< backward difference at the upper edge
+        const double gl = g / (knots[m] - knots[m-1]);
+        c[k-1] -= gl; c[k] += gl;
+      } else { //< average of the adjacent differences
+        const double gl = g / (2*(knots[m] - knots[m-1]));
+        const double gr = g / (2*(knots[m+1] - knots[m]));
+        c[k-1] -= gl; c[k] += gl - gr; c[k+1] += gr;
+      }
+    };
+    adddiff(i, 1, d*h10);
+    adddiff(i+1, 2, d*h11);
+
+    // Place the weights in a 4-knot window within the knot range: the unused end weights are zero
+    s.i0 = (i == 0) ? 0 : min(i-1, nknots-4);
+    s.n = 4;
+    s.w[0] = s.w[1] = s.w[2] = s.w[3] = 0;
+    for (size_t k = 0; k < 4; ++k) {
+      if (i+k < s.i0+1 || i+k > s.i0+4) continue; //< knot i-1+k outside the window
+      s.w[i+k-1-s.i0] += c[k];
+    }
+  }
+
+
+
+  void applyStencilNF(SIMDLevel level, const KnotStencil& sx, const KnotStencil& sq,
+                      const KnotArray1F* const* subgrids, size_t nflavs, double* rtn) {
+    if (nflavs > MAXFLAVS) throw UserError("At most " + to_str(MAXFLAVS) + " flavors can be interpolated at once");
+    const size_t ld = _padded(nflavs);
+    const size_t nx = sx.n, nq = sq.n;
+
+    // Gather the stencil values as rows over the flavors, padded with zeros
+    alignas(64) double v[MAXKNOTS*MAXKNOTS*MAXFLAVS];
+    alignas(64) double out[MAXFLAVS];
+    const size_t nq2 = subgrids[0]->q2size();
+    const size_t k0 = sx.i0*nq2 + sq.i0;
+    for (size_t j = 0; j < nflavs; ++j) {
+      const double* xfs = &subgrids[j]->xf(0, 0);
+      const size_t xfstride = subgrids[j]->xfstride();
+      for (size_t a = 0; a < nx; ++a)
+        for (size_t b = 0; b < nq; ++b)
+          v[(a*nq + b)*ld + j] = xfs[(k0 + a*nq2 + b)*xfstride];
+    }
+    for (size_t k = 0; k < nx*nq; ++k)
+      for (size_t j = nflavs; j < ld; ++j) v[k*ld + j] = 0;
+
+    _flavorContractor(level)(nx, nq, sx.w, sq.w, v, ld, out);
+    for (size_t j = 0; j < nflavs; ++j) rtn[j] = out[j];
+  }
+
+
+  void applyStencils(SIMDLevel level, const KnotArray1F* const* subgrids, size_t npoints,
+                     const KnotStencil* sxs, const KnotStencil* sqs, double* rtn, size_t stride) {
+    const ContractFn contract = _pointContractor(level);
+    alignas(64) double v[MAXKNOTS*MAXKNOTS*BLOCKSIZE];
+    alignas(64) double wx[MAXKNOTS*BLOCKSIZE], wq[MAXKNOTS*BLOCKSIZE];
+    alignas(64) double out[BLOCKSIZE];
+    for (size_t i0 = 0; i0 < npoints; i0 += BLOCKSIZE) {
+      const size_t n = min(BLOCKSIZE, npoints - i0);
+      const size_t ld = _padded(n);
+      size_t nx = 0, nq = 0;
+      for (size_t i = i0; i < i0+n; ++i) {
+        nx = max(nx, sxs[i].n);
+        nq = max(nq, sqs[i].n);
+      }
+
+      // Gather the stencil weights and values as rows over the points, padding shorter stencils and the rows with zeros
+      for (size_t i = 0; i < n; ++i) {
+        const KnotStencil& sx = sxs[i0+i];
+        const KnotStencil& sq = sqs[i0+i];
+        const KnotArray1F& subgrid = *subgrids[i0+i];
+        const double* xfs = &subgrid.xf(0, 0);
+        const size_t xfstride = subgrid.xfstride();
+        const size_t nq2 = subgrid.q2size();
+        const size_t k0 = sx.i0*nq2 + sq.i0;
+        for (size_t a = 0; a < nx; ++a) wx[a*ld + i] = (a < sx.n) ? sx.w[a] : 0;
+        for (size_t b = 0; b < nq; ++b) wq[b*ld + i] = (b < sq.n) ? sq.w[b] : 0;
+        for (size_t a = 0; a < nx; ++a)
+          for (size_t b = 0; b < nq; ++b)
+            v[(a*nq + b)*ld + i] = (a < sx.n && b < sq.n) ? xfs[(k0 + a*nq2 + b)*xfstride] : 0;
+      }
+      for (size_t i = n; i < ld; ++i) {
+        for (size_t a = 0; a < nx; ++a) wx[a*ld + i] = 0;
+        for (size_t b = 0; b < nq; ++b) wq[b*ld + i] = 0;
+        for (size_t k = 0; k < nx*nq; ++k) v[k*ld + i] = 0;
+      }
+
+      contract(nx, nq, wx, wq, v, ld, out);
+      for (size_t i = 0; i < n; ++i) rtn[(i0+i)*stride] = out[i];
+    }
+  }
+
+}
@@ -0,0 +1,192 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/SetGrid.h"
+#include "LHAPDF/PDFSet.h"
+#include "LHAPDF/GridPDF.h"
+#include <typeinfo>
+
+namespace LHAPDF {
+
+
+  namespace {
+
+    /// The PIDs -6 to 6 of the all-parton queries, with the gluon as 21
+    const int IDS[13] = { -6, -5, -4, -3, -2, -1, 21, 1, 2, 3, 4, 5, 6 };
+
+    /// Do two grid PDFs have the same subgrids, knots, flavors and interpolator type?
+    bool _sameLayout(const GridPDF& a, const GridPDF& b) {
+      if (a.flavors() != b.flavors()) return false;
+      if (typeid(a.interpolator()) != typeid(b.interpolator())) return false;
+      if (a.knotarrays().size() != b.knotarrays().size()) return false;
+      map<double, KnotArrayNF>::const_iterator ita = a.knotarrays().begin(), itb = b.knotarrays().begin();
+      for (; ita != a.knotarrays().end(); ++ita, ++itb) {
+        if (ita->first != itb->first) return false;
+        const KnotArrayNF& nfa = ita->second;
+        const KnotArrayNF& nfb = itb->second;
+        if (nfa.pids() != nfb.pids()) return false;
+        const KnotAxes& axes = *nfa.get_first().axes();
+        for (int pid : nfa.pids()) {
+          if (!axes.matches(*nfa.get_pid(pid).axes())) return false;
+          if (!axes.matches(*nfb.get_pid(pid).axes())) return false;
+        }
+      }
+      return true;
+    }
+
+  }
+
+
+  SetGrid::SetGrid(const PDFSet& set, int nthreads)
+    : _set(&set), _lazypdfs(set)
+  {
+    vector< shared_ptr<PDF> > pdfs;
+    set.mkPDFs(pdfs, nthreads);
+    for (const shared_ptr<PDF>& pdf : pdfs) _forcepos.push_back(pdf->forcePositive());
+    _build(pdfs);
+    // With a tensor, keep only member 0 rather than holding every grid twice
+    if (tensor()) _pdf0 = pdfs[0];
+    else _pdfs.swap(pdfs);
+  }
+
+
+  void SetGrid::_build(const std::vector< std::shared_ptr<PDF> >& pdfs) {
+    // All the members must be grid PDFs with the same layout, whose interpolator provides stencils
+    if (pdfs.empty()) return;
+    vector<const GridPDF*> gpdfs;
+    for (const shared_ptr<PDF>& pdf : pdfs) {
+      const GridPDF* gpdf = dynamic_cast<const GridPDF*>(pdf.get());
+      if (gpdf == 0) return;
+      if (!gpdfs.empty() && !_sameLayout(*gpdfs[0], *gpdf)) return;
+      gpdfs.push_back(gpdf);
+    }
+    const GridPDF& pdf0 = *gpdfs[0];
+    const vector<double>& xknots = pdf0.xKnots();
+    const vector<double>& q2knots = pdf0.q2Knots();
+    if (!pdf0.prepare(xknots[xknots.size()/2], q2knots[q2knots.size()/2]).prepared()) return;
+
+    // Fill the [ix][iQ2][flavor][member] block of each subgrid
+    const size_t nmem = gpdfs.size();
+    for (const pair<const double, KnotArrayNF>& q2_ka : pdf0.knotarrays()) {
+      _Block block;
+      block.pids = q2_ka.second.pids();
+      const KnotArray1F& grid0 = q2_ka.second.get_first();
+      const size_t nx = grid0.xsize(), nflav = block.pids.size();
+      block.nq2 = grid0.q2size();
+      block.xfs.resize(nx * block.nq2 * nflav * nmem);
+      for (size_t imem = 0; imem < nmem; ++imem) {
+        const KnotArrayNF& arraynf = gpdfs[imem]->knotarrays().find(q2_ka.first)->second;
+        for (size_t iflav = 0; iflav < nflav; ++iflav) {
+          const KnotArray1F& grid = arraynf.get_pid(block.pids[iflav]);
+          for (size_t ix = 0; ix < nx; ++ix)
+            for (size_t iq2 = 0; iq2 < block.nq2; ++iq2)
+              block.xfs[((ix*block.nq2 + iq2)*nflav + iflav)*nmem + imem] = grid.xf(ix, iq2);
+        }
+      }
+      _blocks.push_back(std::move(block));
+    }
+  }
+
+
+  void SetGrid::_contract(const _Block& block, size_t iflav, const PreparedPoint& pt, double* rtn) const {
+    const KnotStencil& sx = pt.xStencil();
+    const KnotStencil& sq = pt.q2Stencil();
+    const size_t nmem = size(), nflav = block.pids.size();
+    const size_t qstride = nflav*nmem, xstride = block.nq2*qstride;
+    const double* base = block.xfs.data() + (sx.i0*block.nq2 + sq.i0)*qstride + iflav*nmem;
+    // Contiguous loops over chunks of the members, in the same order of operations as the stencil kernels,
+    // with the partial sums over x on the stack
+    const size_t NCHUNK = 64;
+    double r[NCHUNK];
+    for (size_t m0 = 0; m0 < nmem; m0 += NCHUNK) {
+      const size_t nm = min(NCHUNK, nmem - m0);
+      double* out = rtn + m0;
+      for (size_t imem = 0; imem < nm; ++imem) out[imem] = 0;
+      for (size_t b = 0; b < sq.n; ++b) {
+        for (size_t imem = 0; imem < nm; ++imem) r[imem] = 0;
+        for (size_t a = 0; a < sx.n; ++a) {
+          const double w = sx.w[a];
+          const double* row = base + a*xstride + b*qstride + m0;
+          for (size_t imem = 0; imem < nm; ++imem) r[imem] += w * row[imem];
+        }
+        const double w = sq.w[b];
+        for (size_t imem = 0; imem < nm; ++imem) out[imem] += w * r[imem];
+      }
+    }
+  }
+
+
+  void SetGrid::_forcePositive(double* rtn) const {
+    for (size_t imem = 0; imem < size(); ++imem) {
+      switch (_forcepos[imem]) {
+      case 0: break;
+      case 1: if (rtn[imem] < 0) rtn[imem] = 0; break;
+      case 2: if (rtn[imem] < 1e-10) rtn[imem] = 1e-10; break;
+      default: throw LogicError("ForcePositive value not in expected range!");
+      }
+    }
+  }
+
+
+  void SetGrid::xfxQ2(int id, double x, double q2, std::vector<double>& rtn) const {
+    rtn.resize(size());
+    if (tensor()) {
+      const GridPDF& pdf0 = static_cast<const GridPDF&>(*_pdf0);
+      const PreparedPoint pt = pdf0.prepare(x, q2);
+      if (pt.prepared()) {
+        // Treat PID = 0 as always equivalent to a gluon: query as PID = 21
+        const int id2 = (id != 0) ? id : 21;
+        const _Block& block = _blocks[pt.subgridIndex()];
+        const vector<int>::const_iterator it = lower_bound(block.pids.begin(), block.pids.end(), id2);
+        if (!pdf0.hasFlavor(id2)) {
+          // Undefined PIDs
+          for (double& xf : rtn) xf = 0.0;
+        } else if (it != block.pids.end() && *it == id2) {
+          _contract(block, it - block.pids.begin(), pt, rtn.data());
+          _forcePositive(rtn.data());
+        } else {
+          throw FlavorError("Undefined particle ID requested: " + to_str(id2));
+        }
+        return;
+      }
+    }
+    // Member by member, for unprepared points and sets without a tensor
+    for (size_t imem = 0; imem < size(); ++imem) rtn[imem] = _member(imem)->xfxQ2(id, x, q2);
+  }
+
+
+  void SetGrid::xfxQ2(double x, double q2, std::vector< std::vector<double> >& rtn) const {
+    rtn.resize(13);
+    for (vector<double>& xfs : rtn) xfs.resize(size());
+    if (tensor()) {
+      const GridPDF& pdf0 = static_cast<const GridPDF&>(*_pdf0);
+      const PreparedPoint pt = pdf0.prepare(x, q2);
+      if (pt.prepared()) {
+        const _Block& block = _blocks[pt.subgridIndex()];
+        for (size_t j = 0; j < 13; ++j) {
+          const vector<int>::const_iterator it = lower_bound(block.pids.begin(), block.pids.end(), IDS[j]);
+          if (!pdf0.hasFlavor(IDS[j])) {
+            // Undefined PIDs
+            for (double& xf : rtn[j]) xf = 0.0;
+          } else if (it != block.pids.end() && *it == IDS[j]) {
+            _contract(block, it - block.pids.begin(), pt, rtn[j].data());
+            _forcePositive(rtn[j].data());
+          } else {
+            throw FlavorError("Undefined particle ID requested: " + to_str(IDS[j]));
+          }
+        }
+        return;
+      }
+    }
+    // Member by member, for unprepared points and sets without a tensor
+    vector<double> xfs;
+    for (size_t imem = 0; imem < size(); ++imem) {
+      _member(imem)->xfxQ2(x, q2, xfs);
+      for (size_t j = 0; j < 13; ++j) rtn[j][imem] = xfs[j];
+    }
+  }
+
+
+}
@@ -0,0 +1,170 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+#include "LHAPDF/UncertaintyAccumulator.h"
+
+namespace LHAPDF {
+
+
+  UncertaintyAccumulator::UncertaintyAccumulator(const PDFSet& set, size_t nobs, double cl)
+    : _size(set.size()), _nobs(nobs), _sums(nobs*set.size(), 0.0)
+  {
+    // Parse the error type once
+    _errtypestr = set.errorType();
+    if (startswith(_errtypestr, "replicas")) _errtype = REPLICAS;
+    else if (startswith(_errtypestr, "symmhessian")) _errtype = SYMMHESSIAN;
+    else if (startswith(_errtypestr, "hessian")) _errtype = HESSIAN;
+    else _errtype = UNSUPPORTED; //< Reported when an uncertainty is requested
+
+    // PDF members labelled 0 to nmem, excluding possible parameter variations.
+    _npar = countchar(_errtypestr, '+');
+    if (_size < 2 + 2*_npar)
+      throw UserError("Error in LHAPDF::PDFSet::uncertainty. PDF set must contain more than just the central value.");
+    _nmem = _size - 1 - 2*_npar;
+
+    // Get set- and requested conf levels (converted from %) and check sanity (req CL = set CL if cl < 0).
+    // For replica sets, we internally use a nominal setCL corresponding to 1-sigma, since errorConfLevel() == -1.
+    const double setCL = (_errtype != REPLICAS) ? set.errorConfLevel() / 100.0 : erf(1/sqrt(2));
+    _reqCL = (cl >= 0) ? cl / 100.0 : setCL; // convert from percentage
+    if (!in_range(_reqCL, 0, 1) || !in_range(setCL, 0, 1))
+      throw UserError("Error in LHAPDF::PDFSet::uncertainty. Requested or PDF set confidence level outside [0,1] range.");
+
+    // Scaling of Hessian sets, or replica sets without the alternative, from the set CL to the requested one
+    _rescale = (setCL != _reqCL);
+    _scale = 1;
+    if (_rescale) {
+      // Calculate the qth quantile of the chi-squared distribution with one degree of freedom.
+      // Examples: quantile(dist, q) = {0.988946, 1, 2.70554, 3.84146, 4} for q = {0.68, 1-sigma, 0.90, 0.95, 2-sigma}.
+      const double qsetCL = chisquared_quantile(setCL, 1);
+      const double qreqCL = chisquared_quantile(_reqCL, 1);
+      _scale = sqrt(qreqCL/qsetCL);
+    }
+  }
+
+
+  void UncertaintyAccumulator::merge(const UncertaintyAccumulator& other) {
+    if (other._size != _size || other._nobs != _nobs)
+      throw UserError("Error in LHAPDF::UncertaintyAccumulator::merge. Accumulators must have the same numbers of members and observables.");
+    merge(other._sums);
+  }
+
+
+  void UncertaintyAccumulator::merge(const std::vector<double>& sums) {
+    if (sums.size() != _sums.size())
+      throw UserError("Error in LHAPDF::UncertaintyAccumulator::merge. Input vector must contain sums for all observables and PDF members.");
+    for (size_t i = 0; i < _sums.size(); ++i) _sums[i] += sums[i];
+  }
+
+
+  void UncertaintyAccumulator::reset() {
+    std::fill(_sums.begin(), _sums.end(), 0.0);
+  }
+
+
+  PDFUncertainty UncertaintyAccumulator::uncertainty(const double* values, bool alternative) const {
+    const size_t nmem = _nmem, npar = _npar;
+
+    // Return value
+    PDFUncertainty rtn;
+    rtn.central = values[0];
+
+    if (alternative && _errtype == REPLICAS) {
+
+      // Compute median and requested CL directly from probability distribution of replicas.
+      // Sort "values" into increasing order, ignoring zeroth member (average over replicas).
+      // Also ignore possible parameter variations included at the end of the set.
+      vector<double> sorted(values, values + _size);
+      sort(sorted.begin()+1, sorted.end()-2*npar);
+      // Define central value to be median.
+      if (nmem % 2) { // odd nmem => one middle value
+        rtn.central = sorted[nmem/2 + 1];
+      } else { // even nmem => average of two middle values
+        rtn.central = 0.5*(sorted[nmem/2] + sorted[nmem/2 + 1]);
+      }
+      // Define uncertainties via quantiles with a CL given by reqCL.
+      const int upper = round(0.5*(1+_reqCL)*nmem); // round to nearest integer
+      const int lower = 1 + round(0.5*(1-_reqCL)*nmem); // round to nearest integer
+      rtn.errplus = sorted[upper] - rtn.central;
+      rtn.errminus = rtn.central - sorted[lower];
+      rtn.errsymm = 0.5*(rtn.errplus + rtn.errminus); // symmetrised
+
+    } else if (alternative) {
+
+      throw UserError("Error in LHAPDF::PDFSet::uncertainty. This PDF set is not in the format of replicas.");
+
+    } else if (_errtype == REPLICAS) {
+
+      // Calculate the average and standard deviation using Eqs. (2.3) and (2.4) of arXiv:1106.5788v2.
+      double av = 0.0, sd = 0.0;
+      for (size_t imem = 1; imem <= nmem; imem++) {
+        av += values[imem];
+        sd += sqr(values[imem]);
+      }
+      av /= nmem; sd /= nmem;
+      sd = nmem/(nmem-1.0)*(sd-sqr(av));
+      sd = (sd > 0.0 && nmem > 1) ? sqrt(sd) : 0.0;
+      rtn.central = av;
+      rtn.errplus = rtn.errminus = rtn.errsymm = sd;
+
+    } else if (_errtype == SYMMHESSIAN) {
+
+      double errsymm = 0;
+      for (size_t ieigen = 1; ieigen <= nmem; ieigen++)
+        errsymm += sqr(values[ieigen]-values[0]);
+      errsymm = sqrt(errsymm);
+      rtn.errplus = rtn.errminus = rtn.errsymm = errsymm;
+
+    } else if (_errtype == HESSIAN) {
+
+      // Calculate the asymmetric and symmetric Hessian uncertainties
+      // using Eqs. (2.1), (2.2) and (2.6) of arXiv:1106.5788v2.
+      double errplus = 0, errminus = 0, errsymm = 0;
+      for (size_t ieigen = 1; ieigen <= nmem/2; ieigen++) {
+        errplus += sqr(max(max(values[2*ieigen-1]-values[0],values[2*ieigen]-values[0]), 0.0));
+        errminus += sqr(max(max(values[0]-values[2*ieigen-1],values[0]-values[2*ieigen]), 0.0));
+        errsymm += sqr(values[2*ieigen-1]-values[2*ieigen]);
+      }
+      rtn.errsymm = 0.5*sqrt(errsymm);
+      rtn.errplus = sqrt(errplus);
+      rtn.errminus = sqrt(errminus);
+
+    } else {
+      throw MetadataError("\"ErrorType: " + _errtypestr + "\" not supported by LHAPDF::PDFSet::uncertainty.");
+    }
+
+    if (_rescale) {
+      // Apply scaling to Hessian sets or replica sets with alternative=false.
+      rtn.scale = _scale;
+      if (!alternative) {
+        rtn.errplus *= _scale;
+        rtn.errminus *= _scale;
+        rtn.errsymm *= _scale;
+      }
+    }
+
+    rtn.errplus_pdf = rtn.errplus;
+    rtn.errminus_pdf = rtn.errminus;
+    rtn.errsymm_pdf = rtn.errsymm;
+    if (npar > 0) {
+
+      // All individual parameter variation uncertainties are added in quadrature.
+      double err_par = 0;
+      for (size_t ipar = 1; ipar <= npar; ipar++) {
+        err_par += sqr(values[nmem+2*ipar-1]-values[nmem+2*ipar]);
+      }
+      // Calculate total uncertainty from parameter variation with same scaling as for PDF uncertainty.
+      rtn.err_par = rtn.scale * 0.5 * sqrt(err_par);
+      // Add parameter variation uncertainty in quadrature with PDF uncertainty.
+      rtn.errplus = sqrt( sqr(rtn.errplus_pdf) + sqr(rtn.err_par) );
+      rtn.errminus = sqrt( sqr(rtn.errminus_pdf) + sqr(rtn.err_par) );
+      rtn.errsymm = sqrt( sqr(rtn.errsymm_pdf) + sqr(rtn.err_par) );
+
+    }
+
+    return rtn;
+  }
+
+
+}
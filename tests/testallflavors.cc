@@ -0,0 +1,39 @@
+// Test of the all-flavor xfxQ2 for each interpolator, checking that the results are identical to the per-flavor ones
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 2000;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, -8.5, 0.0, 0.0, 10.0, xs, q2s);
+
+  bool ok = true;
+  const vector<string> ipols = { "linear", "log", "cubic", "logcubic", "cubic-precomputed", "logcubic-precomputed", "logcubic-patch" };
+  for (const string& ipol : ipols) {
+    pdf->setInterpolator(ipol);
+    vector<double> xfs;
+    for (size_t i = 0; i < npoints; ++i) {
+      pdf->xfxQ2(xs[i], q2s[i], xfs);
+      for (int j = 0; j < 13; ++j)
+        if (xfs[j] != pdf->xfxQ2(j-6, xs[i], q2s[i])) ok = false;
+    }
+  }
+
+  cout << (ok ? "All-flavor values match the per-flavor ones" : "All-flavor values differ from the per-flavor ones!") << endl;
+  delete pdf;
+  return ok ? 0 : 1;
+}
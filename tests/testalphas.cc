@@ -1,6 +1,7 @@
  // Example program to test alpha_s calculation
 
 #include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
 #include <iostream>
 #include <fstream>
 #include <limits>
@@ -10,6 +11,8 @@ using namespace std;
 
 int main() {
 
+  requirePDFSet("CT10");
+
   // Set up three standalone AlphaS solvers:
 
 
@@ -86,6 +89,36 @@ int main() {
   // as_ode.setQValues(qs);
 
 
+  ///////////////////////////////
+  // Compare the results of the two ODE integration methods:
+
+
+  AlphaS_ODE* odes[2] = { new AlphaS_ODE(), new AlphaS_ODE() };
+  odes[1]->setSolver(AlphaS_ODE::DOPRI5);
+  for (AlphaS_ODE* ode : odes) {
+    ode->setOrderQCD(5);
+    ode->setMZ(91);
+    ode->setAlphaSMZ(0.118);
+    for (int iq = 1; iq <= 6; ++iq) ode->setQuarkMass(iq, as_ode.quarkMass(iq));
+  }
+  double maxdev = 0, maxdevlow = 0;
+  for (double log10q = -0.5; log10q < 3; log10q += 0.01) {
+    const double q = pow(10, log10q);
+    const double as_rk4 = odes[0]->alphasQ(q), as_dopri = odes[1]->alphasQ(q);
+    if (as_rk4 > 2 || as_dopri > 2) continue;
+    const double dev = fabs(as_dopri - as_rk4) / as_rk4;
+    if (q >= 1) maxdev = max(maxdev, dev);
+    else maxdevlow = max(maxdevlow, dev);
+  }
+  cout << "Max relative difference of the ODE solvers: " << maxdev << " for Q >= 1 GeV, "
+       << maxdevlow << " below" << endl;
+  // The solvers must agree to their accuracy, more loosely where alpha_s grows large below 1 GeV
+  const bool odesagree = (maxdev < 1e-3 && maxdevlow < 5e-3);
+  if (!odesagree) cerr << "ERROR: The RK4 and Dormand-Prince ODE solvers disagree!" << endl;
+  delete odes[0];
+  delete odes[1];
+
+
   ///////////////////////////////
   // Test these solvers and the CT10nlo PDF's default behaviours:
 
@@ -121,5 +154,5 @@ int main() {
   fa.close(); fo.close(); fi.close(); fc.close();
 
   delete pdf;
-  return 0;
+  return odesagree ? 0 : 1;
 }
@@ -0,0 +1,39 @@
+// Test of batched alphasQ2 for each AlphaS type, checking that the results are identical to the single-value ones
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main() {
+
+  const size_t npoints = 4096;
+  LHAPDF::setVerbosity(0);
+
+  // Random scales, log-distributed from below the lowest knots to beyond the highest,
+  // and the same sorted, as in a scan
+  vector<double> q2s = randomLogValues(npoints, -1.0, 9.0);
+  vector<double> sortedq2s = q2s;
+  sort(sortedq2s.begin(), sortedq2s.end());
+
+  bool ok = true;
+  // Sets with analytic, ODE and interpolated alpha_s
+  const string setnames[] = { "CT10", "CT10nlo", "MSTW2008nlo68cl" };
+  for (const string& setname : setnames) requirePDFSet(setname);
+  for (const string& setname : setnames) {
+    const unique_ptr<const LHAPDF::PDF> pdf(LHAPDF::mkPDF(setname, 0));
+    for (const vector<double>* scales : {&q2s, &sortedq2s}) {
+      vector<double> as(npoints);
+      pdf->alphasQ2(scales->data(), as.data(), npoints);
+      for (size_t i = 0; i < npoints; ++i)
+        if (as[i] != pdf->alphasQ2((*scales)[i])) ok = false;
+    }
+  }
+
+  cout << (ok ? "Batched values match the single-value ones" : "Batched values differ from the single-value ones!") << endl;
+  return ok ? 0 : 1;
+}
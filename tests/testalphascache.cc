@@ -0,0 +1,108 @@
+// Test of the on-disk cache of solved alpha_s ODE tables, checking that cached values are identical to solved ones
+
+#include "LHAPDF/LHAPDF.h"
+#include <iostream>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+using namespace std;
+
+
+/// An ODE alpha_s solver with fixed parameters
+LHAPDF::AlphaS_ODE* mkODE(double asmz=0.118) {
+  LHAPDF::AlphaS_ODE* as = new LHAPDF::AlphaS_ODE();
+  as->setMZ(91.1876);
+  as->setAlphaSMZ(asmz);
+  as->setOrderQCD(4);
+  as->setQuarkMass(4, 1.4);
+  as->setQuarkMass(5, 4.75);
+  as->setQuarkMass(6, 172.5);
+  as->setSolver(LHAPDF::AlphaS_ODE::DOPRI5);
+  return as;
+}
+
+
+/// The names of the files in directory @a dir
+vector<string> listdir(const string& dir) {
+  vector<string> rtn;
+  DIR* d = opendir(dir.c_str());
+  if (d == NULL) return rtn;
+  while (struct dirent* ent = readdir(d)) {
+    const string name = ent->d_name;
+    if (name != "." && name != "..") rtn.push_back(name);
+  }
+  closedir(d);
+  return rtn;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  LHAPDF::setVerbosity(0);
+  char tmpl[] = "/tmp/lhapdf-testalphascache-XXXXXX";
+  const string cachedir = string(mkdtemp(tmpl)) + "/cache";
+  const size_t npoints = 1000, nthreads = 4;
+
+  // Q2 values, log-distributed from below 1 GeV to beyond the knots
+  vector<double> q2s(npoints);
+  for (size_t i = 0; i < npoints; ++i) q2s[i] = pow(10, -0.5 + 7.0*i/double(npoints));
+
+  // Reference values, without the cache
+  LHAPDF::setCachePath("");
+  vector<double> refas;
+  {
+    const unique_ptr<LHAPDF::AlphaS> as(mkODE());
+    for (double q2 : q2s) refas.push_back(as->alphasQ2(q2));
+  }
+
+  // Concurrent first solutions by several objects, all storing the same table
+  LHAPDF::setCachePath(cachedir);
+  vector<size_t> nbad(nthreads, 0);
+  vector<thread> threads;
+  for (size_t ithread = 0; ithread < nthreads; ++ithread) {
+    threads.push_back(thread([&, ithread]() {
+      const unique_ptr<LHAPDF::AlphaS> as(mkODE());
+      for (size_t i = 0; i < npoints; ++i)
+        if (as->alphasQ2(q2s[i]) != refas[i]) nbad[ithread] += 1;
+    }));
+  }
+  for (thread& t : threads) t.join();
+  bool ok = true;
+  for (size_t n : nbad) if (n != 0) ok = false;
+  const vector<string> files = listdir(cachedir);
+  cout << "Cache files after concurrent solutions: " << files.size() << endl;
+  if (files.size() != 1 || files[0].find(".lhas") == string::npos) ok = false;
+
+  // A new object loads the table, with identical values
+  {
+    const unique_ptr<LHAPDF::AlphaS> as(mkODE());
+    for (size_t i = 0; i < npoints; ++i)
+      if (as->alphasQ2(q2s[i]) != refas[i]) ok = false;
+  }
+
+  // Different parameters give a different table, and a corrupt file is solved again and replaced
+  {
+    const unique_ptr<LHAPDF::AlphaS> as(mkODE(0.120));
+    if (as->alphasQ2(100.0) == refas[0]) ok = false;
+  }
+  if (listdir(cachedir).size() != 2) ok = false;
+  if (truncate((cachedir + "/" + files[0]).c_str(), 100) != 0) ok = false;
+  {
+    const unique_ptr<LHAPDF::AlphaS> as(mkODE());
+    for (size_t i = 0; i < npoints; ++i)
+      if (as->alphasQ2(q2s[i]) != refas[i]) ok = false;
+  }
+  const unique_ptr<LHAPDF::AlphaS> as(mkODE());
+  if (as->alphasQ2(q2s[0]) != refas[0]) ok = false;
+
+  // Clean up
+  LHAPDF::setCachePath("");
+  for (const string& f : listdir(cachedir)) remove((cachedir + "/" + f).c_str());
+  rmdir(cachedir.c_str());
+  rmdir(tmpl);
+
+  cout << (ok ? "Cached alpha_s values match the solved ones" : "Cached alpha_s values differ from the solved ones!") << endl;
+  return ok ? 0 : 1;
+}
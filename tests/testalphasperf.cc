@@ -0,0 +1,53 @@
+// Program to compare single-value and batched alphasQ2 throughput for each AlphaS type
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const size_t npoints = (argc < 2) ? 4096 : atoi(argv[1]);
+  const int nrepeats = 200;
+  LHAPDF::setVerbosity(0);
+
+  // Random scales, log-distributed from below the lowest knots to beyond the highest,
+  // and the same sorted, as in a scan
+  vector<double> q2s = randomLogValues(npoints, -1.0, 9.0);
+  vector<double> sortedq2s = q2s;
+  sort(sortedq2s.begin(), sortedq2s.end());
+
+  // Sets with analytic, ODE and interpolated alpha_s
+  const string setnames[] = { "CT10", "CT10nlo", "MSTW2008nlo68cl" };
+  for (const string& setname : setnames) {
+    const unique_ptr<const LHAPDF::PDF> pdf(LHAPDF::mkPDF(setname, 0));
+    pdf->alphasQ2(100.0); //< Solve the ODE, if any, before timing
+    for (const vector<double>* scales : {&q2s, &sortedq2s}) {
+      // Single-value calls
+      vector<double> as1(npoints);
+      clock_t start = clock();
+      for (int n = 0; n < nrepeats; ++n)
+        for (size_t i = 0; i < npoints; ++i)
+          as1[i] = pdf->alphasQ2((*scales)[i]);
+      const clock_t t_single = clock() - start;
+
+      // Batched calls
+      vector<double> as2(npoints);
+      start = clock();
+      for (int n = 0; n < nrepeats; ++n)
+        pdf->alphasQ2(scales->data(), as2.data(), npoints);
+      const clock_t t_batch = clock() - start;
+
+      cout << pdf->alphaS().type() << (scales == &q2s ? ", random" : ", sorted")
+           << ": single = " << t_single << ", batch = " << t_batch
+           << ", speed-up = " << double(t_single)/double(max(t_batch, clock_t(1))) << endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,43 @@
+// Test of batched xfxQ2 over arrays of points, checking that the results are identical to the single-point ones
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 4096;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDF* pdf = LHAPDF::mkPDF(setname, 0);
+
+  // Random block of points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, -8.5, 0.0, 0.0, 10.0, xs, q2s);
+  const vector<int> pids = { -3, -2, -1, 21, 1, 2, 3 };
+
+  // Single-PID batches
+  bool ok = true;
+  vector<double> xfs(npoints);
+  for (int pid : pids) {
+    pdf->xfxQ2(pid, xs.data(), q2s.data(), npoints, xfs.data());
+    for (size_t i = 0; i < npoints; ++i)
+      if (xfs[i] != pdf->xfxQ2(pid, xs[i], q2s[i])) ok = false;
+  }
+
+  // Multi-PID batch, with point-major output
+  xfs.resize(npoints*pids.size());
+  pdf->xfxQ2(pids, xs.data(), q2s.data(), npoints, xfs.data());
+  for (size_t i = 0; i < npoints; ++i)
+    for (size_t j = 0; j < pids.size(); ++j)
+      if (xfs[i*pids.size() + j] != pdf->xfxQ2(pids[j], xs[i], q2s[i])) ok = false;
+
+  cout << (ok ? "Batched values match the single-point ones" : "Batched values differ from the single-point ones!") << endl;
+  delete pdf;
+  return ok ? 0 : 1;
+}
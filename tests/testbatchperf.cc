@@ -0,0 +1,47 @@
+// Program to compare single-point and batched xfxQ2 throughput
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = (argc < 3) ? 4096 : atoi(argv[2]);
+  const int nrepeats = 200;
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDF* pdf = LHAPDF::mkPDF(setname, 0);
+
+  // Random block of points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, -8.5, 0.0, 0.0, 10.0, xs, q2s);
+  const vector<int> pids = { -3, -2, -1, 21, 1, 2, 3 };
+
+  for (int pid : pids) {
+    // Single-point calls
+    vector<double> xfs1(npoints);
+    clock_t start = clock();
+    for (int n = 0; n < nrepeats; ++n)
+      for (size_t i = 0; i < npoints; ++i)
+        xfs1[i] = pdf->xfxQ2(pid, xs[i], q2s[i]);
+    const clock_t t_single = clock() - start;
+
+    // Batched calls
+    vector<double> xfs2(npoints);
+    start = clock();
+    for (int n = 0; n < nrepeats; ++n)
+      pdf->xfxQ2(pid, xs.data(), q2s.data(), npoints, xfs2.data());
+    const clock_t t_batch = clock() - start;
+
+    cout << "PID " << pid << ": single = " << t_single << ", batch = " << t_batch
+         << ", speed-up = " << double(t_single)/double(max(t_batch, clock_t(1))) << endl;
+  }
+
+  delete pdf;
+  return 0;
+}
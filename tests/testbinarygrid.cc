@@ -0,0 +1,106 @@
+// Test of writing and memory-mapping binary .lhab grid files, comparing their values with the text format
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <sys/stat.h>
+#include <utime.h>
+#include <unistd.h>
+using namespace std;
+
+
+/// Copy the file at @a src to @a dst
+void copyfile(const string& src, const string& dst) {
+  ifstream in(src.c_str(), ios::binary);
+  ofstream out(dst.c_str(), ios::binary);
+  out << in.rdbuf();
+}
+
+
+/// Is the grid data of @a pdf used in place from a binary file?
+bool usesBinary(const LHAPDF::GridPDF& pdf) {
+  for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf.knotarrays())
+    for (int pid : q2_ka.second.pids())
+      if (q2_ka.second.get_pid(pid).ownsxfs()) return false;
+  return true;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+
+  // Copy the set's info and central member files into a temporary data directory, and search only there,
+  // so that the binary file is not written into the shared data directory
+  char tmpl[] = "/tmp/lhapdf-testbinarygrid-XXXXXX";
+  const string tmpdir = mkdtemp(tmpl);
+  const string setdir = tmpdir + "/" + setname;
+  mkdir(setdir.c_str(), 0755);
+  const string infopath = setdir + "/" + setname + ".info";
+  const string mempath = setdir + "/" + LHAPDF::basename(LHAPDF::findpdfmempath(setname, 0));
+  copyfile(LHAPDF::findpdfsetinfopath(setname), infopath);
+  copyfile(LHAPDF::findpdfmempath(setname, 0), mempath);
+  LHAPDF::setPaths(tmpdir);
+  const string binpath = LHAPDF::GridPDF::binaryDataPath(mempath);
+
+  // Load from the text file and write the binary one
+  LHAPDF::getConfig().set_entry("BinaryGrids", false);
+  const LHAPDF::GridPDF pdf_txt(mempath);
+  pdf_txt.writeBinaryData(binpath);
+
+  // Load from the binary file
+  LHAPDF::getConfig().set_entry("BinaryGrids", true);
+  const LHAPDF::GridPDF pdf_bin(mempath);
+
+  // Compare all knot values, and check that the binary data is used in place
+  bool ok = (pdf_txt.knotarrays().size() == pdf_bin.knotarrays().size());
+  for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf_txt.knotarrays()) {
+    const LHAPDF::KnotArrayNF& arr_txt = q2_ka.second;
+    const LHAPDF::KnotArrayNF& arr_bin = pdf_bin.subgrid(q2_ka.first);
+    if (arr_bin.pids() != arr_txt.pids() || arr_bin.xs() != arr_txt.xs() || arr_bin.q2s() != arr_txt.q2s()) {
+      ok = false;
+      continue;
+    }
+    for (int pid : arr_txt.pids()) {
+      const LHAPDF::KnotArray1F& ka_txt = arr_txt.get_pid(pid);
+      const LHAPDF::KnotArray1F& ka_bin = arr_bin.get_pid(pid);
+      if (ka_bin.ownsxfs()) ok = false;
+      for (size_t ix = 0; ix < ka_txt.xsize(); ++ix)
+        for (size_t iq2 = 0; iq2 < ka_txt.q2size(); ++iq2)
+          if (ka_bin.xf(ix, iq2) != ka_txt.xf(ix, iq2)) ok = false;
+    }
+  }
+  for (double x : {1e-5, 1e-3, 0.1, 0.5})
+    for (double q : {2.0, 10.0, 100.0, 1000.0})
+      if (pdf_bin.xfxQ(21, x, q) != pdf_txt.xfxQ(21, x, q)) ok = false;
+
+  // A binary file made from another version of the text file is ignored, even if it is newer,
+  // as when an updated set is unpacked with its original modification times
+  struct stat st;
+  if (stat(mempath.c_str(), &st) != 0) ok = false;
+  struct utimbuf older = { st.st_atime, st.st_mtime - 3600 };
+  if (utime(mempath.c_str(), &older) != 0) ok = false;
+  if (usesBinary(LHAPDF::GridPDF(mempath))) ok = false;
+
+  // A binary file made from the current text file is used again, but not once truncated
+  pdf_txt.writeBinaryData(binpath);
+  if (!usesBinary(LHAPDF::GridPDF(mempath))) ok = false;
+  if (truncate(binpath.c_str(), 1000) != 0) ok = false;
+  const LHAPDF::GridPDF pdf_trunc(mempath);
+  if (usesBinary(pdf_trunc)) ok = false;
+  if (pdf_trunc.xfxQ(21, 0.1, 10.0) != pdf_txt.xfxQ(21, 0.1, 10.0)) ok = false;
+  cout << (ok ? "Binary grid matches the text grid" : "Binary grid differs from the text grid!") << endl;
+
+  // Clean up
+  remove(binpath.c_str());
+  remove(mempath.c_str());
+  remove(infopath.c_str());
+  rmdir(setdir.c_str());
+  rmdir(tmpdir.c_str());
+  return ok ? 0 : 1;
+}
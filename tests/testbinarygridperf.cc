@@ -0,0 +1,67 @@
+// Program to compare the load times of a member from its text grid file and from the memory-mapped binary .lhab file
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+
+/// Copy the file at @a src to @a dst
+void copyfile(const string& src, const string& dst) {
+  ifstream in(src.c_str(), ios::binary);
+  ofstream out(dst.c_str(), ios::binary);
+  out << in.rdbuf();
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const int member = (argc < 3) ? 0 : atoi(argv[2]);
+  const int nrepeats = 10;
+  LHAPDF::setVerbosity(0);
+
+  // Copy the set's info and member files into a temporary data directory, and search only there,
+  // so that the binary file is not written into the shared data directory
+  char tmpl[] = "/tmp/lhapdf-testbinarygridperf-XXXXXX";
+  const string tmpdir = mkdtemp(tmpl);
+  const string setdir = tmpdir + "/" + setname;
+  mkdir(setdir.c_str(), 0755);
+  const string infopath = setdir + "/" + setname + ".info";
+  const string mempath = setdir + "/" + LHAPDF::basename(LHAPDF::findpdfmempath(setname, member));
+  copyfile(LHAPDF::findpdfsetinfopath(setname), infopath);
+  copyfile(LHAPDF::findpdfmempath(setname, member), mempath);
+  LHAPDF::setPaths(tmpdir);
+  const string binpath = LHAPDF::GridPDF::binaryDataPath(mempath);
+
+  // Load from the text file, and write the binary one
+  LHAPDF::getConfig().set_entry("BinaryGrids", false);
+  clock_t start = clock();
+  for (int n = 0; n < nrepeats; ++n) LHAPDF::GridPDF pdf(mempath);
+  const clock_t t_txt = clock() - start;
+  LHAPDF::GridPDF(mempath).writeBinaryData(binpath);
+
+  // Load from the binary file
+  LHAPDF::getConfig().set_entry("BinaryGrids", true);
+  start = clock();
+  for (int n = 0; n < nrepeats; ++n) LHAPDF::GridPDF pdf(mempath);
+  const clock_t t_bin = clock() - start;
+
+  cout << "Text load   = " << t_txt/nrepeats << endl;
+  cout << "Binary load = " << t_bin/nrepeats << endl;
+  cout << "Speed-up    = " << double(t_txt)/double(max(t_bin, clock_t(1))) << endl;
+
+  // Clean up
+  remove(binpath.c_str());
+  remove(mempath.c_str());
+  remove(infopath.c_str());
+  rmdir(setdir.c_str());
+  rmdir(tmpdir.c_str());
+  return 0;
+}
@@ -0,0 +1,61 @@
+// Test of the ContinuationExtrapolator edge tables, checking that the results are identical without them
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "LHAPDF/ContinuationExtrapolator.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+  pdf->setExtrapolator(string("continuation"));
+
+  // Random points in each extrapolation region: low x, high Q2, both, low Q2 with and without low x
+  const double logxmin = log10(pdf->xKnots().front()), logq2min = log10(pdf->q2Knots().front());
+  const double logq2max = log10(pdf->q2Knots().back());
+  vector<double> xs, q2s;
+  seedRandom();
+  for (size_t i = 0; i < npoints; ++i) {
+    const double r1 = randomUniform(), r2 = randomUniform();
+    const double lowx = logxmin - 2*r1, inx = logxmin*r1;
+    const double lowq2 = logq2min - 2*r2, highq2 = logq2max + 2*r2, inq2 = logq2min + (logq2max - logq2min)*r2;
+    switch (i % 5) {
+    case 0: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, inq2)); break;
+    case 1: xs.push_back(pow(10, inx)); q2s.push_back(pow(10, highq2)); break;
+    case 2: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, highq2)); break;
+    case 3: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, lowq2)); break;
+    default: xs.push_back(pow(10, inx)); q2s.push_back(pow(10, lowq2)); break;
+    }
+  }
+
+  // The PDF's extrapolator, with its tables, and an unprepared one bound to the same PDF
+  const LHAPDF::Extrapolator& tabulated = pdf->extrapolator();
+  LHAPDF::ContinuationExtrapolator direct;
+  direct.bind(pdf);
+
+  bool ok = true;
+  for (size_t i = 0; i < npoints; ++i) {
+    for (int id = -5; id <= 5; ++id) {
+      const int pid = (id != 0) ? id : 21;
+      if (tabulated.extrapolateXQ2(pid, xs[i], q2s[i]) != direct.extrapolateXQ2(pid, xs[i], q2s[i])) ok = false;
+    }
+  }
+
+  // Replacing the interpolator rebuilds the tables
+  pdf->setInterpolator(string("linear"));
+  for (size_t i = 0; i < npoints; i += 7)
+    if (pdf->extrapolator().extrapolateXQ2(21, xs[i], q2s[i]) != direct.extrapolateXQ2(21, xs[i], q2s[i])) ok = false;
+
+  delete pdf;
+  cout << (ok ? "Tabulated values match the direct ones" : "Tabulated values differ from the direct ones!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+// Benchmark of the ContinuationExtrapolator edge tables in each extrapolation region, against the direct evaluation
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "LHAPDF/ContinuationExtrapolator.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  const int nrepeats = 5;
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+  pdf->setExtrapolator(string("continuation"));
+
+  // Random points in each extrapolation region: low x, high Q2, both, low Q2 with and without low x
+  const double logxmin = log10(pdf->xKnots().front()), logq2min = log10(pdf->q2Knots().front());
+  const double logq2max = log10(pdf->q2Knots().back());
+  vector<double> xs, q2s;
+  seedRandom();
+  for (size_t i = 0; i < npoints; ++i) {
+    const double r1 = randomUniform(), r2 = randomUniform();
+    const double lowx = logxmin - 2*r1, inx = logxmin*r1;
+    const double lowq2 = logq2min - 2*r2, highq2 = logq2max + 2*r2, inq2 = logq2min + (logq2max - logq2min)*r2;
+    switch (i % 5) {
+    case 0: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, inq2)); break;
+    case 1: xs.push_back(pow(10, inx)); q2s.push_back(pow(10, highq2)); break;
+    case 2: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, highq2)); break;
+    case 3: xs.push_back(pow(10, lowx)); q2s.push_back(pow(10, lowq2)); break;
+    default: xs.push_back(pow(10, inx)); q2s.push_back(pow(10, lowq2)); break;
+    }
+  }
+
+  // The PDF's extrapolator, with its tables, and an unprepared one bound to the same PDF
+  const LHAPDF::Extrapolator& tabulated = pdf->extrapolator();
+  LHAPDF::ContinuationExtrapolator direct;
+  direct.bind(pdf);
+
+  const char* regions[] = { "low x", "high Q2", "low x and high Q2", "low x and low Q2", "low Q2" };
+  for (size_t region = 0; region < 5; ++region) {
+    vector<double> xfs[2];
+    clock_t times[2];
+    for (int itab = 0; itab < 2; ++itab) {
+      const LHAPDF::Extrapolator& xpol = (itab == 0) ? static_cast<const LHAPDF::Extrapolator&>(direct) : tabulated;
+      const clock_t start = clock();
+      for (int n = 0; n < nrepeats; ++n)
+        for (size_t i = region; i < npoints; i += 5)
+          for (int id = -5; id <= 5; ++id)
+            xfs[itab].push_back(xpol.extrapolateXQ2(id != 0 ? id : 21, xs[i], q2s[i]));
+      times[itab] = clock() - start;
+    }
+    cout << regions[region] << ": direct = " << times[0] << ", tabulated = " << times[1]
+         << " (x" << double(times[0])/double(max(times[1], clock_t(1))) << ")" << endl;
+  }
+
+  delete pdf;
+  return 0;
+}
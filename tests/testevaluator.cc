@@ -0,0 +1,49 @@
+// Test of the devirtualised grid evaluators, checking that the results are identical to those of PDF::xfxQ2
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridEvaluator.h"
+#include "testutils.h"
+#include <iostream>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+
+  bool ok = true;
+  const vector<string> ipolnames = {"linear", "log", "cubic", "logcubic", "logcubic-patch"};
+  for (const string& ipolname : ipolnames) {
+    pdf->setInterpolator(ipolname);
+    const unique_ptr<LHAPDF::GridEvaluatorBase> eval(LHAPDF::mkGridEvaluator(*pdf));
+    vector<double> xfs(npoints);
+
+    // One virtual call per point, and one per batch, through the type-erased evaluator
+    eval->xfxQ2(21, xs.data(), q2s.data(), npoints, xfs.data());
+    for (size_t i = 0; i < npoints; ++i) {
+      const double xf = pdf->xfxQ2(21, xs[i], q2s[i]);
+      if (eval->xfxQ2(21, xs[i], q2s[i]) != xf || xfs[i] != xf) ok = false;
+    }
+  }
+
+  // A concrete instantiation, with no virtual calls at all
+  pdf->setInterpolator(string("logcubic"));
+  const LHAPDF::GridEvaluator<LHAPDF::LogBicubicInterpolator, LHAPDF::ContinuationExtrapolator> eval(*pdf);
+  for (size_t i = 0; i < npoints; ++i)
+    if (eval.xfxQ2(2, xs[i], q2s[i]) != pdf->xfxQ2(2, xs[i], q2s[i])) ok = false;
+
+  delete pdf;
+  cout << (ok ? "Evaluator values match the PDF ones" : "Evaluator values differ from the PDF ones!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// Micro-benchmark of the devirtualised grid evaluators against PDF::xfxQ2
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridEvaluator.h"
+#include "testutils.h"
+#include <iostream>
+#include <memory>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  const int nrepeats = 20;
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+
+  const vector<string> ipolnames = {"linear", "log", "cubic", "logcubic", "logcubic-patch"};
+  for (const string& ipolname : ipolnames) {
+    pdf->setInterpolator(ipolname);
+    const unique_ptr<LHAPDF::GridEvaluatorBase> eval(LHAPDF::mkGridEvaluator(*pdf));
+    vector<double> xfs1(npoints), xfs2(npoints), xfs3(npoints);
+
+    // Virtual dispatch through the PDF
+    clock_t start = clock();
+    for (int n = 0; n < nrepeats; ++n)
+      for (size_t i = 0; i < npoints; ++i)
+        xfs1[i] = pdf->xfxQ2(21, xs[i], q2s[i]);
+    const clock_t t_pdf = clock() - start;
+
+    // One virtual call per point, through the type-erased evaluator
+    start = clock();
+    for (int n = 0; n < nrepeats; ++n)
+      for (size_t i = 0; i < npoints; ++i)
+        xfs2[i] = eval->xfxQ2(21, xs[i], q2s[i]);
+    const clock_t t_eval = clock() - start;
+
+    // One virtual call per batch
+    start = clock();
+    for (int n = 0; n < nrepeats; ++n)
+      eval->xfxQ2(21, xs.data(), q2s.data(), npoints, xfs3.data());
+    const clock_t t_batch = clock() - start;
+
+    cout << ipolname << ": PDF = " << t_pdf
+         << ", evaluator = " << t_eval << " (x" << double(t_pdf)/double(max(t_eval, clock_t(1))) << ")"
+         << ", evaluator batch = " << t_batch << " (x" << double(t_pdf)/double(max(t_batch, clock_t(1))) << ")" << endl;
+  }
+
+  delete pdf;
+  return 0;
+}
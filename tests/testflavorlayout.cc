@@ -0,0 +1,144 @@
+// Test of the allocation-free flavor-layout PDF queries and of the AlphaS objects shared between set members
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+using namespace std;
+
+
+/// @name Count of heap allocations, to check that the queries make none
+///
+/// All the replaceable global allocation functions are replaced, so that
+/// every form of new is counted and matched by the corresponding delete.
+//@{
+size_t nallocs = 0;
+
+void* countedAlloc(size_t size) {
+  nallocs += 1;
+  return malloc(size > 0 ? size : 1);
+}
+
+void* operator new(size_t size) {
+  void* p = countedAlloc(size);
+  if (!p) throw bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return countedAlloc(size); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#ifdef __cpp_aligned_new
+void* countedAlignedAlloc(size_t size, align_val_t align) {
+  nallocs += 1;
+  const size_t a = max(size_t(align), sizeof(void*));
+  void* p = 0;
+  return (posix_memalign(&p, a, size > 0 ? size : 1) == 0) ? p : 0;
+}
+
+void* operator new(size_t size, align_val_t align) {
+  void* p = countedAlignedAlloc(size, align);
+  if (!p) throw bad_alloc();
+  return p;
+}
+void* operator new[](size_t size, align_val_t align) { return operator new(size, align); }
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept { return countedAlignedAlloc(size, align); }
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept { return countedAlignedAlloc(size, align); }
+void operator delete(void* p, align_val_t) noexcept { free(p); }
+void operator delete[](void* p, align_val_t) noexcept { free(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { free(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { free(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { free(p); }
+#endif
+//@}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 1000;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+  const vector<LHAPDF::PDF*> pdfs = set.mkPDFs();
+  const LHAPDF::PDF& pdf = *pdfs[0];
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+
+  // Layouts, including the photon and an undefined PID, and their buffers, all made before the queries
+  const LHAPDF::FlavorLayout lha5, photon = LHAPDF::FlavorLayout::lhapdf5Photon();
+  const LHAPDF::FlavorLayout custom({2, 1, 21, -1, -2, 22, 99});
+  double buf5[13], bufphoton[14], bufcustom[7];
+  vector<double> xfs;
+  map<int, double> xfmap;
+  pdf.xfxQ2(xs[0], q2s[0], xfs);
+  pdf.xfxQ2(xs[0], q2s[0], xfmap);
+
+  bool ok = true;
+  nallocs = 0;
+  for (size_t i = 0; i < npoints; ++i) {
+    pdf.xfxQ2(xs[i], q2s[i], lha5, buf5);
+    pdf.xfxQ2(xs[i], q2s[i], photon, bufphoton);
+    pdf.xfxQ2(xs[i], q2s[i], custom, bufcustom);
+    pdf.xfxQ2(xs[i], q2s[i], xfs);
+    pdf.xfxQ2(xs[i], q2s[i], xfmap);
+    for (size_t j = 0; j < 13; ++j) {
+      if (buf5[j] != xfs[j] || bufphoton[j] != xfs[j]) ok = false;
+      if (buf5[j] != pdf.xfxQ2(lha5.pid(j), xs[i], q2s[i])) ok = false;
+    }
+    for (size_t j = 0; j < custom.size(); ++j)
+      if (bufcustom[j] != pdf.xfxQ2(custom.pid(j), xs[i], q2s[i])) ok = false;
+    if (bufphoton[13] != pdf.xfxQ2(22, xs[i], q2s[i]) || bufcustom[6] != 0.0) ok = false;
+    for (const pair<const int, double>& id_xf : xfmap)
+      if (id_xf.second != pdf.xfxQ2(id_xf.first, xs[i], q2s[i])) ok = false;
+  }
+  cout << "Heap allocations in " << npoints << " all-flavor queries: " << nallocs << endl;
+  if (nallocs != 0) ok = false;
+
+  // The batch layout query agrees with the single-point one
+  vector<double> batch(npoints * custom.size());
+  pdf.xfxQ2(custom, xs.data(), q2s.data(), npoints, batch.data());
+  for (size_t i = 0; i < npoints; i += 10) {
+    pdf.xfxQ2(xs[i], q2s[i], custom, bufcustom);
+    for (size_t j = 0; j < custom.size(); ++j)
+      if (batch[i*custom.size() + j] != bufcustom[j]) ok = false;
+  }
+
+  // The members share one AlphaS object, unless sharing is disabled
+  size_t nshared = 0;
+  for (const LHAPDF::PDF* p : pdfs)
+    if (&p->alphaS() == &pdf.alphaS()) nshared += 1;
+  cout << nshared << " of " << pdfs.size() << " members share the AlphaS object of member 0" << endl;
+  if (nshared != pdfs.size()) ok = false;
+  LHAPDF::Info& cfg = LHAPDF::getConfig();
+  cfg.set_entry("ShareAlphaS", false);
+  const unique_ptr<const LHAPDF::PDF> unshared(set.mkPDF(0));
+  cfg.set_entry("ShareAlphaS", true);
+  if (&unshared->alphaS() == &pdf.alphaS()) ok = false;
+
+  // Non-const access returns the object as it is, including one installed by the caller
+  if (&pdfs[1]->alphaS() != &pdf.alphaS()) ok = false;
+  const shared_ptr<const LHAPDF::AlphaS> installed(LHAPDF::mkAlphaS(setname));
+  pdfs[2]->setAlphaS(installed);
+  if (&pdfs[2]->alphaS() != installed.get()) ok = false;
+  for (size_t i = 0; i < npoints; i += 10) {
+    if (installed->alphasQ2(q2s[i]) != pdf.alphasQ2(q2s[i])) ok = false;
+    if (unshared->alphasQ2(q2s[i]) != pdf.alphasQ2(q2s[i])) ok = false;
+  }
+
+  for (LHAPDF::PDF* p : pdfs) delete p;
+  cout << (ok ? "Layout queries and shared AlphaS objects are correct" : "Layout queries or shared AlphaS objects are wrong!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+// Program to compare per-flavor and all-flavor xfxQ2 throughput for each interpolator
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = (argc < 3) ? 20000 : atoi(argv[2]);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, -8.5, 0.0, 0.0, 10.0, xs, q2s);
+
+  const vector<string> ipols = { "linear", "log", "cubic", "logcubic", "cubic-precomputed", "logcubic-precomputed", "logcubic-patch" };
+  for (const string& ipol : ipols) {
+    pdf->setInterpolator(ipol);
+
+    // One flavor at a time
+    vector<double> xfs1(13*npoints);
+    clock_t start = clock();
+    for (size_t i = 0; i < npoints; ++i)
+      for (int j = 0; j < 13; ++j)
+        xfs1[13*i + j] = pdf->xfxQ2(j-6, xs[i], q2s[i]);
+    const clock_t t_single = clock() - start;
+
+    // All flavors at once
+    vector<double> xfs2(13*npoints), xfs;
+    start = clock();
+    for (size_t i = 0; i < npoints; ++i) {
+      pdf->xfxQ2(xs[i], q2s[i], xfs);
+      copy(xfs.begin(), xfs.end(), xfs2.begin() + 13*i);
+    }
+    const clock_t t_fused = clock() - start;
+
+    cout << ipol << ": per-flavor = " << t_single << ", all-flavor = " << t_fused
+         << ", speed-up = " << double(t_single)/double(max(t_fused, clock_t(1))) << endl;
+  }
+
+  delete pdf;
+  return 0;
+}
@@ -0,0 +1,82 @@
+// Program to compare query throughput for on-the-fly and precomputed knot derivatives in the cubic interpolators
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+#include <cmath>
+#include <ctime>
+using namespace std;
+
+
+// Sample all partons on a regular log-spaced grid of points, returning the CPU time taken
+clock_t sample(const LHAPDF::PDF* pdf, vector<double>& results) {
+  const double MINLOGX = -7.5;
+  const double MINLOGQ = 1;
+  const double MAXLOGQ = 3;
+  const double dx = 0.01;
+  const double dq = 0.01;
+
+  results.clear();
+  const clock_t start = clock();
+  vector<double> xfs; xfs.resize(13);
+  for (double log10x = MINLOGX; log10x <= 0.0; log10x += dx) {
+    for (double log10q = MINLOGQ; log10q <= MAXLOGQ; log10q += dq) {
+      pdf->xfxQ(pow(10, log10x), pow(10, log10q), xfs);
+      results.insert(results.end(), xfs.begin(), xfs.end());
+    }
+  }
+  return clock() - start;
+}
+
+
+// Total size of the derivative tables held by a grid PDF
+size_t gradient_bytes(const LHAPDF::GridPDF& pdf) {
+  size_t rtn = 0;
+  for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf.knotarrays())
+    for (int pid : q2_ka.second.pids())
+      rtn += q2_ka.second.get_pid(pid).gradientsMemSize();
+  return rtn;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const vector<string> ipolnames = {"logcubic", "cubic"};
+
+  for (const string& ipolname : ipolnames) {
+    LHAPDF::GridPDF* pdf_otf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+    LHAPDF::GridPDF* pdf_pre = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+    if (pdf_otf == 0 || pdf_pre == 0) {
+      cout << setname << " is not a grid PDF" << endl;
+      return 1;
+    }
+    pdf_otf->setInterpolator(ipolname);
+    const clock_t start = clock();
+    pdf_pre->setInterpolator(ipolname + "-precomputed");
+    const clock_t t_init = clock() - start;
+
+    vector<double> xfs_otf, xfs_pre;
+    const clock_t t_otf = sample(pdf_otf, xfs_otf);
+    const clock_t t_pre = sample(pdf_pre, xfs_pre);
+
+    double maxreldiff = 0;
+    for (size_t i = 0; i < xfs_otf.size(); ++i) {
+      const double denom = max(fabs(xfs_otf[i]), 1e-10);
+      maxreldiff = max(maxreldiff, fabs(xfs_pre[i] - xfs_otf[i]) / denom);
+    }
+
+    cout << ipolname << ":" << endl;
+    cout << "  Init        = " << t_init << endl;
+    cout << "  On-the-fly  = " << t_otf << endl;
+    cout << "  Precomputed = " << t_pre << endl;
+    cout << "  Speed-up    = " << double(t_otf)/double(t_pre) << endl;
+    cout << "  Extra mem   = " << gradient_bytes(*pdf_pre) << " bytes" << endl;
+    cout << "  Max rel diff = " << maxreldiff << endl;
+
+    delete pdf_otf;
+    delete pdf_pre;
+  }
+
+  return 0;
+}
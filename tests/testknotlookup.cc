@@ -0,0 +1,73 @@
+// Test of the knot index lookup via the bucket tables, checking it against binary search at random points
+
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <random>
+using namespace std;
+
+
+// Reference binary-search lookup, as used before the bucket tables
+size_t binary_below(const vector<double>& knots, double v) {
+  size_t i = upper_bound(knots.begin(), knots.end(), v) - knots.begin();
+  if (i == knots.size()) i -= 1;
+  return i - 1;
+}
+
+
+// Look up a list of values in the given knots both ways, and check that they agree
+bool compare(const string& label, const LHAPDF::KnotArray1F& ka, bool inx, const vector<double>& vals) {
+  const vector<double>& knots = inx ? ka.xs() : ka.q2s();
+  for (size_t i = 0; i < vals.size(); ++i) {
+    const size_t ibucket = inx ? ka.ixbelow(vals[i]) : ka.iq2below(vals[i]);
+    if (ibucket != binary_below(knots, vals[i])) {
+      cout << "  " << label << " lookup of " << vals[i] << " differs!" << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  vector<string> setnames;
+  for (int i = 1; i < argc; ++i) setnames.push_back(argv[i]);
+  if (setnames.empty()) setnames = {"CT10nlo"};
+
+  const size_t NPOINTS = 100000;
+  mt19937 rng(12345);
+  bool ok = true;
+
+  for (const string& setname : setnames) {
+    requirePDFSet(setname);
+    const LHAPDF::PDF* basepdf = LHAPDF::mkPDF(setname, 0);
+    const LHAPDF::GridPDF* pdf = dynamic_cast<const LHAPDF::GridPDF*>(basepdf);
+    if (pdf == 0) {
+      cout << setname << " is not a grid PDF" << endl;
+      return 1;
+    }
+    for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf->knotarrays()) {
+      const LHAPDF::KnotArray1F& ka = q2_ka.second.get_first();
+
+      // Random points, uniform in log(x) and log(Q2) over the subgrid, plus the knots themselves
+      uniform_real_distribution<double> logxdist(ka.logxs().front(), ka.logxs().back());
+      uniform_real_distribution<double> logq2dist(ka.logq2s().front(), ka.logq2s().back());
+      vector<double> xs(NPOINTS), q2s(NPOINTS);
+      for (size_t i = 0; i < NPOINTS; ++i) {
+        xs[i] = min(max(exp(logxdist(rng)), ka.xs().front()), ka.xs().back());
+        q2s[i] = min(max(exp(logq2dist(rng)), ka.q2s().front()), ka.q2s().back());
+      }
+      for (size_t i = 0; i < ka.xsize(); ++i) xs[i] = ka.xs()[i];
+      for (size_t i = 0; i < ka.q2size(); ++i) q2s[i] = ka.q2s()[i];
+
+      ok &= compare("x ", ka, true, xs);
+      ok &= compare("Q2", ka, false, q2s);
+    }
+    delete basepdf;
+  }
+
+  cout << (ok ? "Bucket table lookups match binary search" : "Bucket table lookups differ from binary search!") << endl;
+  return ok ? 0 : 1;
+}
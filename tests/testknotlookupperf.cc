@@ -0,0 +1,81 @@
+// Program to compare random-point knot index lookup times via binary search and via the bucket tables
+
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+#include <cmath>
+#include <ctime>
+#include <random>
+using namespace std;
+
+
+// Reference binary-search lookup, as used before the bucket tables
+size_t binary_below(const vector<double>& knots, double v) {
+  size_t i = upper_bound(knots.begin(), knots.end(), v) - knots.begin();
+  if (i == knots.size()) i -= 1;
+  return i - 1;
+}
+
+
+// Time the lookup of a list of values in the given knots, both ways
+void compare(const string& label, const LHAPDF::KnotArray1F& ka, bool inx, const vector<double>& vals) {
+  const vector<double>& knots = inx ? ka.xs() : ka.q2s();
+  vector<size_t> ibin(vals.size()), ibucket(vals.size());
+
+  clock_t start = clock();
+  for (size_t i = 0; i < vals.size(); ++i) ibin[i] = binary_below(knots, vals[i]);
+  const clock_t t_bin = clock() - start;
+
+  start = clock();
+  if (inx) {
+    for (size_t i = 0; i < vals.size(); ++i) ibucket[i] = ka.ixbelow(vals[i]);
+  } else {
+    for (size_t i = 0; i < vals.size(); ++i) ibucket[i] = ka.iq2below(vals[i]);
+  }
+  const clock_t t_bucket = clock() - start;
+
+  const double nsper = 1e9 / CLOCKS_PER_SEC / vals.size();
+  cout << "  " << label << ": " << knots.size() << " knots, "
+       << "binary search = " << t_bin*nsper << " ns, bucket table = " << t_bucket*nsper << " ns per lookup" << endl;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  vector<string> setnames;
+  for (int i = 1; i < argc; ++i) setnames.push_back(argv[i]);
+  if (setnames.empty()) setnames = {"CT10nlo", "NNPDF23_nlo_as_0118"};
+
+  const size_t NPOINTS = 2000000;
+  mt19937 rng(12345);
+
+  for (const string& setname : setnames) {
+    const LHAPDF::PDF* basepdf = LHAPDF::mkPDF(setname, 0);
+    const LHAPDF::GridPDF* pdf = dynamic_cast<const LHAPDF::GridPDF*>(basepdf);
+    if (pdf == 0) {
+      cout << setname << " is not a grid PDF" << endl;
+      return 1;
+    }
+    cout << setname << ":" << endl;
+    for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf->knotarrays()) {
+      const LHAPDF::KnotArray1F& ka = q2_ka.second.get_first();
+
+      // Random points, uniform in log(x) and log(Q2) over the subgrid, plus the knots themselves
+      uniform_real_distribution<double> logxdist(ka.logxs().front(), ka.logxs().back());
+      uniform_real_distribution<double> logq2dist(ka.logq2s().front(), ka.logq2s().back());
+      vector<double> xs(NPOINTS), q2s(NPOINTS);
+      for (size_t i = 0; i < NPOINTS; ++i) {
+        xs[i] = min(max(exp(logxdist(rng)), ka.xs().front()), ka.xs().back());
+        q2s[i] = min(max(exp(logq2dist(rng)), ka.q2s().front()), ka.q2s().back());
+      }
+      for (size_t i = 0; i < ka.xsize(); ++i) xs[i] = ka.xs()[i];
+      for (size_t i = 0; i < ka.q2size(); ++i) q2s[i] = ka.q2s()[i];
+
+      cout << " Subgrid from Q2 = " << q2_ka.first << endl;
+      compare("x ", ka, true, xs);
+      compare("Q2", ka, false, q2s);
+    }
+    delete basepdf;
+  }
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Test of lazy, on-demand member loading with a memory budget, including concurrent access
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <thread>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+  bool ok = true;
+
+  // Eager loading of all members, for reference
+  const vector<LHAPDF::PDF*> pdfs = set.mkPDFs();
+
+  // Lazy container, touching only a few members
+  const LHAPDF::LazyPDFs lazy = set.mkLazyPDFs(0);
+  const vector<size_t> used = { 0, set.size()/2, set.size()-1 };
+  for (size_t imem : used) {
+    const shared_ptr<LHAPDF::PDF> pdf = lazy[imem];
+    if (pdf->memberID() != int(imem) || pdf->xfxQ(21, 0.01, 100) != pdfs[imem]->xfxQ(21, 0.01, 100)) ok = false;
+    if (lazy[imem] != pdf) ok = false; //< once loaded, the same object is returned
+  }
+  if (lazy.numLoaded() != used.size()) ok = false;
+  cout << "Lazy load of " << used.size() << " of " << set.size() << " members = " << lazy.memoryMB() << " MB" << endl;
+
+  // Least-recently-used eviction under a budget of two and a half members
+  const double budget = 2.5 * lazy.memoryMB() / used.size();
+  const LHAPDF::LazyPDFs lazy2 = set.mkLazyPDFs(budget);
+  const shared_ptr<LHAPDF::PDF> held = lazy2[0];
+  lazy2[1]; lazy2[0]; lazy2[2];
+  if (!lazy2.loaded(0) || lazy2.loaded(1) || !lazy2.loaded(2) || lazy2.memoryMB() > budget) ok = false;
+  lazy2[3];
+  if (lazy2.loaded(0) || held->xfxQ(21, 0.01, 100) != pdfs[0]->xfxQ(21, 0.01, 100)) ok = false; //< evicted members stay valid while held
+  cout << "Budget of " << budget << " MB: " << lazy2.numLoaded() << " members loaded, " << lazy2.memoryMB() << " MB" << endl;
+
+  // Concurrent random access, with and without a budget
+  for (double b : {0.0, budget}) {
+    const LHAPDF::LazyPDFs lazy3 = set.mkLazyPDFs(b);
+    vector<thread> threads;
+    vector<int> nbad(4, 0);
+    for (size_t ithread = 0; ithread < nbad.size(); ++ithread) {
+      threads.push_back(thread([&, ithread]() {
+            unsigned int seed = ithread;
+            for (int i = 0; i < 200; ++i) {
+              const size_t imem = rand_r(&seed) % lazy3.size();
+              const shared_ptr<LHAPDF::PDF> pdf = lazy3[imem];
+              if (pdf->memberID() != int(imem) || pdf->xfxQ(2, 0.1, 10) != pdfs[imem]->xfxQ(2, 0.1, 10)) nbad[ithread] += 1;
+            }
+          }));
+    }
+    for (thread& t : threads) t.join();
+    for (int n : nbad) if (n != 0) ok = false;
+    if (b > 0 && lazy3.memoryMB() > b) ok = false;
+    cout << "Concurrent access with budget " << b << " MB: " << lazy3.numLoaded() << " members loaded" << endl;
+  }
+
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  cout << (ok ? "Lazy members match the eager ones" : "Lazy member loading failed!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,80 @@
+// Benchmark of text grid loading over all members of a directory of PDF sets, with a checksum of the parsed values
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+
+// Fold the bit patterns of all the knot and xf values of a grid PDF into a hash
+uint64_t checksum(const LHAPDF::GridPDF* pdf, uint64_t hash) {
+  const auto fold = [&](double v) {
+    uint64_t bits; memcpy(&bits, &v, 8);
+    hash = (hash ^ bits) * 1099511628211ULL;
+  };
+  for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf->knotarrays()) {
+    const LHAPDF::KnotArrayNF& arraynf = q2_ka.second;
+    for (int pid : arraynf.pids()) {
+      const LHAPDF::KnotArray1F& ka = arraynf.get_pid(pid);
+      for (double x : ka.xs()) fold(x);
+      for (double q2 : ka.q2s()) fold(q2);
+      for (size_t ix = 0; ix < ka.xsize(); ++ix)
+        for (size_t iq2 = 0; iq2 < ka.q2size(); ++iq2)
+          fold(ka.xf(ix, iq2));
+    }
+  }
+  return hash;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  // Use the named sets, or all those found in the data path, e.g. LHAPDF_DATA_PATH=/path/to/sets
+  vector<string> setnames;
+  for (int i = 1; i < argc; ++i) setnames.push_back(argv[i]);
+  if (setnames.empty()) setnames = LHAPDF::availablePDFSets();
+
+  // Always parse the text files
+  LHAPDF::getConfig().set_entry("BinaryGrids", false);
+  LHAPDF::setVerbosity(0);
+
+  double ttotal = 0, mbtotal = 0;
+  for (const string& setname : setnames) {
+    const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+    if (set.get_entry("Format") != "lhagrid1") continue;
+
+    double mb = 0;
+    for (size_t imem = 0; imem < set.size(); ++imem) {
+      ifstream f(LHAPDF::findpdfmempath(setname, imem).c_str(), ios::binary | ios::ate);
+      mb += f.tellg() / 1e6;
+    }
+
+    const auto start = chrono::steady_clock::now();
+    const vector<LHAPDF::PDF*> pdfs = set.mkPDFs(1);
+    const double t = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint64_t hash = 14695981039346656037ULL;
+    for (const LHAPDF::PDF* pdf : pdfs) {
+      hash = checksum(dynamic_cast<const LHAPDF::GridPDF*>(pdf), hash);
+      delete pdf;
+    }
+
+    cout << setw(30) << left << setname << right
+         << setw(5) << pdfs.size() << " members, "
+         << fixed << setprecision(1) << setw(7) << mb << " MB in "
+         << setprecision(3) << setw(7) << t << " s = "
+         << setprecision(1) << setw(6) << mb/t << " MB/s, checksum "
+         << hex << hash << dec << endl;
+    ttotal += t;
+    mbtotal += mb;
+  }
+  cout << "Total: " << fixed << setprecision(1) << mbtotal << " MB in "
+       << setprecision(3) << ttotal << " s = " << setprecision(1) << mbtotal/ttotal << " MB/s" << endl;
+
+  return 0;
+}
@@ -0,0 +1,33 @@
+// Program to compare the time taken to solve the alpha_s ODE by the RK4 and Dormand-Prince integrators
+
+#include "LHAPDF/LHAPDF.h"
+#include <iostream>
+#include <ctime>
+using namespace std;
+
+
+int main() {
+
+  // Each new alpha_s(MZ) value forces a new solution of the ODE
+  const LHAPDF::AlphaS_ODE::Solver solvers[2] = { LHAPDF::AlphaS_ODE::RK4, LHAPDF::AlphaS_ODE::DOPRI5 };
+  const int nsolves[2] = { 1, 100 }; //< RK4 takes seconds
+  const double masses[6] = { 0.0017, 0.0041, 0.1, 1.29, 4.1, 172.5 };
+  clock_t inittimes[2];
+  for (int i = 0; i < 2; ++i) {
+    LHAPDF::AlphaS_ODE ode;
+    ode.setSolver(solvers[i]);
+    ode.setOrderQCD(5);
+    ode.setMZ(91);
+    for (int iq = 1; iq <= 6; ++iq) ode.setQuarkMass(iq, masses[iq-1]);
+    const clock_t start = clock();
+    for (int n = 0; n < nsolves[i]; ++n) {
+      ode.setAlphaSMZ(0.118 + 1e-6*n);
+      ode.alphasQ2(100);
+    }
+    inittimes[i] = (clock() - start) / nsolves[i];
+  }
+
+  cout << "ODE initialisation time: RK4 = " << inittimes[0] << ", Dormand-Prince = " << inittimes[1]
+       << " (x" << double(inittimes[0])/double(max(inittimes[1], clock_t(1))) << ")" << endl;
+  return 0;
+}
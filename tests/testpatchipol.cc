@@ -0,0 +1,75 @@
+// Regression test of the logcubic-patch interpolator against logcubic, sweeping every cell of the grid
+
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const int member = (argc < 3) ? 0 : atoi(argv[2]);
+  requirePDFSet(setname);
+
+  LHAPDF::GridPDF* pdf_ref = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, member));
+  LHAPDF::GridPDF* pdf_patch = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, member));
+  if (pdf_ref == 0 || pdf_patch == 0) {
+    cout << setname << " is not a grid PDF" << endl;
+    return 1;
+  }
+  pdf_ref->setInterpolator(string("logcubic"));
+  pdf_patch->setInterpolator(string("logcubic-patch"));
+
+  // Sample each cell at a few fractions of its width in log(x) and log(Q2), including the knots
+  const double TS[] = {0.0, 0.1, 0.25, 0.5, 0.75, 0.9};
+  const double TOL = 1e-12;
+  size_t npoints = 0, nfail = 0;
+  double maxdiff = 0;
+  for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : pdf_ref->knotarrays()) {
+    const LHAPDF::KnotArrayNF& subgrid = q2_ka.second;
+    for (int pid : subgrid.pids()) {
+      const LHAPDF::KnotArray1F& ka = subgrid.get_pid(pid);
+      for (size_t ix = 0; ix < ka.xsize(); ++ix) {
+        for (size_t iq2 = 0; iq2 < ka.q2size(); ++iq2) {
+          for (double tx : TS) {
+            if (ix+1 == ka.xsize() && tx > 0) continue;
+            for (double tq : TS) {
+              if (iq2+1 == ka.q2size() && tq > 0) continue;
+              const double logx = (tx == 0) ? ka.logxs()[ix] : ka.logxs()[ix] + tx*(ka.logxs()[ix+1] - ka.logxs()[ix]);
+              const double logq2 = (tq == 0) ? ka.logq2s()[iq2] : ka.logq2s()[iq2] + tq*(ka.logq2s()[iq2+1] - ka.logq2s()[iq2]);
+              const double x = (tx == 0) ? ka.xs()[ix] : exp(logx);
+              const double q2 = (tq == 0) ? ka.q2s()[iq2] : exp(logq2);
+              if (!pdf_ref->inRangeXQ2(x, q2)) continue;
+              const double xf_ref = pdf_ref->interpolator().interpolateXQ2(pid, x, q2);
+              const double xf_patch = pdf_patch->interpolator().interpolateXQ2(pid, x, q2);
+              // Compare relative to the size of the xf values on the enclosing cell corners, to allow for cancellations
+              const size_t jx = min(ix, ka.xsize()-2), jq2 = min(iq2, ka.q2size()-2);
+              const double scale = max(max(fabs(ka.xf(jx, jq2)), fabs(ka.xf(jx+1, jq2))),
+                                       max(fabs(ka.xf(jx, jq2+1)), fabs(ka.xf(jx+1, jq2+1))));
+              const double diff = (scale > 0) ? fabs(xf_patch - xf_ref) / scale : fabs(xf_patch - xf_ref);
+              maxdiff = max(maxdiff, diff);
+              npoints += 1;
+              if (diff > TOL) {
+                nfail += 1;
+                if (nfail <= 10)
+                  cout << "Mismatch for PID " << pid << " at x = " << x << ", Q2 = " << q2 << ": "
+                       << xf_ref << " (logcubic) vs. " << xf_patch << " (logcubic-patch)" << endl;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  cout << "Points tested = " << npoints << endl;
+  cout << "Max rel diff  = " << maxdiff << endl;
+  cout << "Failures      = " << nfail << endl;
+
+  delete pdf_ref;
+  delete pdf_patch;
+  return (nfail == 0) ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+// Test of prepared-point evaluation across the members of a set, and fallback for incompatible PDFs
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+// Relative difference, in units of max(|xf|, 1)
+double reldiff(double a, double b) {
+  return fabs(a - b) / max(fabs(b), 1.0);
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const string othername = (argc < 3) ? "MSTW2008nlo68cl" : argv[2];
+  const size_t npoints = 2000;
+  const double tolerance = 1e-12;
+  requirePDFSet(setname);
+  requirePDFSet(othername);
+  LHAPDF::setVerbosity(0);
+  const vector<LHAPDF::PDF*> pdfs = LHAPDF::mkPDFs(setname);
+  const LHAPDF::GridPDF& pdf0 = dynamic_cast<const LHAPDF::GridPDF&>(*pdfs[0]);
+
+  // Random points, log-distributed over the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf0.xKnots().front()), log10(pdf0.xKnots().back()),
+                  log10(pdf0.q2Knots().front()), log10(pdf0.q2Knots().back()), xs, q2s);
+  // ... and one beyond it in each direction, which cannot be prepared
+  xs.push_back(pdf0.xKnots().front()/10); q2s.push_back(100);
+  xs.push_back(0.1); q2s.push_back(pdf0.q2Knots().back()*10);
+
+  // Prepare the points once, on the first member
+  bool ok = true;
+  vector<LHAPDF::PreparedPoint> pts;
+  size_t nprepared = 0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    pts.push_back(pdf0.prepare(xs[i], q2s[i]));
+    if (pts.back().prepared()) nprepared += 1;
+  }
+  if (nprepared != npoints) ok = false;
+  cout << nprepared << " of " << xs.size() << " points prepared" << endl;
+
+  // All-parton values over all the members, directly and from the prepared points
+  vector<double> xfs1, xfs2;
+  double maxdev = 0;
+  for (const LHAPDF::PDF* pdf : pdfs) {
+    const LHAPDF::GridPDF& gpdf = dynamic_cast<const LHAPDF::GridPDF&>(*pdf);
+    for (size_t i = 0; i < xs.size(); ++i) {
+      gpdf.xfxQ2(xs[i], q2s[i], xfs1);
+      gpdf.xfxQ2(pts[i], xfs2);
+      for (size_t j = 0; j < 13; ++j) maxdev = max(maxdev, reldiff(xfs2[j], xfs1[j]));
+    }
+  }
+  for (size_t i = 0; i < xs.size(); ++i)
+    if (reldiff(pdf0.xfxQ2(21, pts[i]), pdf0.xfxQ2(21, xs[i], q2s[i])) > tolerance) ok = false;
+  if (maxdev > tolerance) ok = false;
+  cout << "Members = " << pdfs.size() << ", max deviation = " << maxdev << endl;
+
+  // Another set, evaluated on the prepared points if its knots agree, or else by the normal route
+  const LHAPDF::GridPDF* other = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(othername, 0));
+  for (size_t i = 0; i < xs.size(); ++i) {
+    other->xfxQ2(xs[i], q2s[i], xfs1);
+    other->xfxQ2(pts[i], xfs2);
+    for (size_t j = 0; j < 13; ++j)
+      if (reldiff(xfs2[j], xfs1[j]) > tolerance) ok = false;
+  }
+
+  // A different interpolator must give exactly the normal results
+  LHAPDF::GridPDF* relinked = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+  relinked->setInterpolator(string("linear"));
+  for (size_t i = 0; i < xs.size(); ++i) {
+    relinked->xfxQ2(xs[i], q2s[i], xfs1);
+    relinked->xfxQ2(pts[i], xfs2);
+    if (xfs1 != xfs2 || relinked->xfxQ2(2, pts[i]) != relinked->xfxQ2(2, xs[i], q2s[i])) ok = false;
+  }
+
+  delete other;
+  delete relinked;
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  cout << (ok ? "Prepared values match the direct ones" : "Prepared values differ from the direct ones!") << endl;
+  return ok ? 0 : 1;
+}
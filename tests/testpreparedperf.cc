@@ -0,0 +1,47 @@
+// Program to compare direct and prepared-point all-parton evaluation throughput across the members of a set
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = (argc < 3) ? 2000 : atoi(argv[2]);
+  LHAPDF::setVerbosity(0);
+  const vector<LHAPDF::PDF*> pdfs = LHAPDF::mkPDFs(setname);
+  const LHAPDF::GridPDF& pdf0 = dynamic_cast<const LHAPDF::GridPDF&>(*pdfs[0]);
+
+  // Random points, log-distributed over the grid, prepared once on the first member
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf0.xKnots().front()), log10(pdf0.xKnots().back()),
+                  log10(pdf0.q2Knots().front()), log10(pdf0.q2Knots().back()), xs, q2s);
+  vector<LHAPDF::PreparedPoint> pts;
+  for (size_t i = 0; i < npoints; ++i) pts.push_back(pdf0.prepare(xs[i], q2s[i]));
+
+  // All-parton values over all the members, directly and from the prepared points
+  vector<double> xfs;
+  clock_t start = clock();
+  for (const LHAPDF::PDF* pdf : pdfs)
+    for (size_t i = 0; i < npoints; ++i)
+      pdf->xfxQ2(xs[i], q2s[i], xfs);
+  const clock_t t_direct = clock() - start;
+  start = clock();
+  for (const LHAPDF::PDF* pdf : pdfs) {
+    const LHAPDF::GridPDF& gpdf = dynamic_cast<const LHAPDF::GridPDF&>(*pdf);
+    for (size_t i = 0; i < npoints; ++i)
+      gpdf.xfxQ2(pts[i], xfs);
+  }
+  const clock_t t_prepared = clock() - start;
+  cout << "Members = " << pdfs.size() << ": direct = " << t_direct << ", prepared = " << t_prepared
+       << ", speed-up = " << double(t_direct)/double(max(t_prepared, clock_t(1))) << endl;
+
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Test of the per-thread query cache, checking that the cached results are identical to the uncached ones
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points within the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf->xKnots().front()), 0.0, log10(pdf->q2Knots().front()), log10(pdf->q2Knots().back()), xs, q2s);
+
+  bool ok = true;
+  const vector<string> ipolnames = {"linear", "log", "cubic", "logcubic", "logcubic-patch"};
+  for (const string& ipolname : ipolnames) {
+    vector<double> xfs[2], allxfs;
+    for (int cache = 0; cache < 2; ++cache) {
+      pdf->info().set_entry("QueryCache", bool(cache));
+      pdf->setInterpolator(ipolname);
+      xfs[cache].clear();
+      LHAPDF::resetQueryCacheStats();
+      // The flavors one after another at each point, as in the usual per-parton loops
+      for (size_t i = 0; i < npoints; ++i)
+        for (int id = -5; id <= 5; ++id)
+          xfs[cache].push_back(pdf->xfxQ2(id, xs[i], q2s[i]));
+      // The all-parton path shares the cache
+      for (size_t i = 0; i < npoints; i += 100) {
+        pdf->xfxQ2(xs[i], q2s[i], allxfs);
+        for (int id = -5; id <= 5; ++id)
+          if (allxfs[id+6] != pdf->xfxQ2(id, xs[i], q2s[i])) ok = false;
+      }
+    }
+    const LHAPDF::QueryCacheStats stats = LHAPDF::queryCacheStats();
+    cout << ipolname << ": hit rate = " << stats.hitRate() << endl;
+    if (xfs[0] != xfs[1]) ok = false;
+    if (stats.hitRate() < 0.8) ok = false;
+  }
+
+  // All-new points only miss, and give the same values again
+  pdf->info().set_entry("QueryCache", true);
+  pdf->setInterpolator(string("logcubic"));
+  LHAPDF::resetQueryCacheStats();
+  for (size_t i = 0; i < npoints; ++i) pdf->xfxQ2(21, xs[i], q2s[i]);
+  if (LHAPDF::queryCacheStats().hits != 0 || LHAPDF::queryCacheStats().misses != npoints) ok = false;
+
+  delete pdf;
+  cout << (ok ? "Cached values match the uncached ones" : "Cached values differ from the uncached ones!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+// Benchmark of the per-thread query cache, against uncached evaluation
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 10000;
+  const int nrepeats = 5;
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points within the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf->xKnots().front()), 0.0, log10(pdf->q2Knots().front()), log10(pdf->q2Knots().back()), xs, q2s);
+
+  const vector<string> ipolnames = {"linear", "log", "cubic", "logcubic", "logcubic-patch"};
+  for (const string& ipolname : ipolnames) {
+    vector<double> xfs[2];
+    clock_t times[2];
+    for (int cache = 0; cache < 2; ++cache) {
+      pdf->info().set_entry("QueryCache", bool(cache));
+      pdf->setInterpolator(ipolname);
+      xfs[cache].clear();
+      LHAPDF::resetQueryCacheStats();
+      // The flavors one after another at each point, as in the usual per-parton loops
+      const clock_t start = clock();
+      for (int n = 0; n < nrepeats; ++n)
+        for (size_t i = 0; i < npoints; ++i)
+          for (int id = -5; id <= 5; ++id)
+            xfs[cache].push_back(pdf->xfxQ2(id, xs[i], q2s[i]));
+      times[cache] = clock() - start;
+    }
+    const LHAPDF::QueryCacheStats stats = LHAPDF::queryCacheStats();
+    cout << ipolname << ": uncached = " << times[0] << ", cached = " << times[1]
+         << " (x" << double(times[0])/double(max(times[1], clock_t(1))) << ")"
+         << ", hit rate = " << stats.hitRate() << endl;
+  }
+
+  delete pdf;
+  return 0;
+}
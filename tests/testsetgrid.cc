@@ -0,0 +1,60 @@
+// Test of set-wide evaluation from a set-level grid, against member-by-member evaluation
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 2000;
+  const double tolerance = 1e-12;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+  const vector<LHAPDF::PDF*> pdfs = set.mkPDFs();
+  const LHAPDF::SetGrid setgrid = set.mkSetGrid();
+  cout << "Set " << setname << " with " << setgrid.size() << " members, "
+       << (setgrid.tensor() ? "stored as a tensor" : "evaluated member by member") << endl;
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+
+  // Gluon values over the members, set-wide and one member at a time
+  bool ok = true;
+  double maxdev = 0;
+  vector<double> setwide;
+  for (size_t i = 0; i < npoints; ++i) {
+    setgrid.xfxQ2(21, xs[i], q2s[i], setwide);
+    for (size_t imem = 0; imem < pdfs.size(); ++imem) {
+      const double direct = pdfs[imem]->xfxQ2(21, xs[i], q2s[i]);
+      maxdev = max(maxdev, fabs(setwide[imem] - direct) / max(fabs(direct), 1.0));
+    }
+  }
+  if (maxdev > tolerance) ok = false;
+  cout << "Gluon: max deviation = " << maxdev << endl;
+
+  // All partons, fed straight into the uncertainty calculation
+  vector< vector<double> > xfs;
+  vector<double> memxfs;
+  for (size_t i = 0; i < npoints; i += 100) {
+    setgrid.xfxQ2(xs[i], q2s[i], xfs);
+    for (size_t j = 0; j < 13; ++j) {
+      for (size_t imem = 0; imem < pdfs.size(); ++imem) memxfs.push_back(pdfs[imem]->xfxQ2(int(j)-6, xs[i], q2s[i]));
+      const LHAPDF::PDFUncertainty u1 = set.uncertainty(memxfs);
+      const LHAPDF::PDFUncertainty u2 = set.uncertainty(xfs[j]);
+      if (fabs(u2.central - u1.central) > tolerance*max(fabs(u1.central), 1.0) ||
+          fabs(u2.errsymm - u1.errsymm) > 1e-8*max(fabs(u1.errsymm), 1.0)) ok = false;
+      memxfs.clear();
+    }
+  }
+
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  cout << (ok ? "Set-wide values match the member ones" : "Set-wide values differ from the member ones!") << endl;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+// Program to compare set-wide evaluation throughput from a set-level grid with member-by-member evaluation
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = (argc < 3) ? 2000 : atoi(argv[2]);
+  LHAPDF::setVerbosity(0);
+  const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+  const vector<LHAPDF::PDF*> pdfs = set.mkPDFs();
+  const LHAPDF::SetGrid setgrid = set.mkSetGrid();
+  cout << "Set " << setname << " with " << setgrid.size() << " members, "
+       << (setgrid.tensor() ? "stored as a tensor" : "evaluated member by member") << endl;
+
+  // Random points, log-distributed over and slightly beyond the grid
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+
+  // Gluon values over the members, one member at a time and set-wide, after a first point outside
+  // the grid has loaded the members for the fallback evaluation
+  vector< vector<double> > direct(npoints, vector<double>(pdfs.size())), setwide(npoints);
+  setgrid.xfxQ2(21, 1e-10, 100.0, setwide[0]);
+  clock_t start = clock();
+  for (size_t i = 0; i < npoints; ++i)
+    for (size_t imem = 0; imem < pdfs.size(); ++imem)
+      direct[i][imem] = pdfs[imem]->xfxQ2(21, xs[i], q2s[i]);
+  const clock_t t_direct = clock() - start;
+  start = clock();
+  for (size_t i = 0; i < npoints; ++i)
+    setgrid.xfxQ2(21, xs[i], q2s[i], setwide[i]);
+  const clock_t t_setwide = clock() - start;
+  cout << "Gluon: member by member = " << t_direct << ", set-wide = " << t_setwide
+       << ", speed-up = " << double(t_direct)/double(max(t_setwide, clock_t(1))) << endl;
+
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  return 0;
+}
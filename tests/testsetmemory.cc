@@ -0,0 +1,63 @@
+// Program to report the memory footprint of loading a whole PDF set, and to check that its knot arrays share their knots
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include <iostream>
+#include <fstream>
+#include <set>
+#include <unistd.h>
+using namespace std;
+
+
+// Get the resident memory size of this process in bytes, or 0 if unavailable
+size_t resident_bytes() {
+  ifstream statm("/proc/self/statm");
+  size_t npages_total = 0, npages_resident = 0;
+  if (!(statm >> npages_total >> npages_resident)) return 0;
+  return npages_resident * sysconf(_SC_PAGESIZE);
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "NNPDF23_nlo_as_0118" : argv[1];
+  const LHAPDF::PDFSet& set = LHAPDF::getPDFSet(setname);
+
+  const size_t rss_before = resident_bytes();
+  const vector<LHAPDF::PDF*> pdfs = set.mkPDFs();
+  const size_t rss_after = resident_bytes();
+
+  // Compare the knot memory actually used with that of one knot copy per flavour array
+  size_t narrays = 0, knotbytes_unshared = 0, knotbytes_shared = 0;
+  std::set<const LHAPDF::KnotAxes*> axes;
+  std::set< pair< vector<double>, vector<double> > > knots;
+  for (const LHAPDF::PDF* pdf : pdfs) {
+    const LHAPDF::GridPDF* gpdf = dynamic_cast<const LHAPDF::GridPDF*>(pdf);
+    if (gpdf == 0) continue;
+    for (const pair<const double, LHAPDF::KnotArrayNF>& q2_ka : gpdf->knotarrays()) {
+      for (int pid : q2_ka.second.pids()) {
+        const LHAPDF::KnotArray1F& ka = q2_ka.second.get_pid(pid);
+        narrays += 1;
+        knotbytes_unshared += ka.axes()->memsize();
+        if (axes.insert(ka.axes().get()).second) knotbytes_shared += ka.axes()->memsize();
+        knots.insert(make_pair(ka.xs(), ka.q2s()));
+      }
+    }
+  }
+
+  cout << "Members         = " << pdfs.size() << endl;
+  cout << "RSS before      = " << rss_before << " bytes" << endl;
+  cout << "RSS after       = " << rss_after << " bytes" << endl;
+  cout << "RSS per member  = " << (rss_after - rss_before) / max(pdfs.size(), size_t(1)) << " bytes" << endl;
+  cout << "Flavour arrays  = " << narrays << endl;
+  cout << "Knot axes       = " << axes.size() << endl;
+  cout << "Knots unshared  = " << knotbytes_unshared << " bytes" << endl;
+  cout << "Knots shared    = " << knotbytes_shared << " bytes" << endl;
+
+  // Each distinct set of knots is held once only, by all the arrays and members using it
+  const bool ok = (narrays > 0 && axes.size() == knots.size());
+  cout << (ok ? "Knot axes are shared between arrays and members" : "Knot axes are duplicated!") << endl;
+
+  for (LHAPDF::PDF* pdf : pdfs) delete pdf;
+  return ok ? 0 : 1;
+}
@@ -4,6 +4,8 @@
 #include <iostream>
 #include <cmath>
 #include <ctime>
+#include <chrono>
+#include <thread>
 using namespace std;
 
 int main(int argc, char* argv[]) {
@@ -45,6 +47,17 @@ int main(int argc, char* argv[]) {
 
   #if LHAPDF_MAJOR_VERSION > 5
   for (const LHAPDF::PDF* pdf : pdfs) delete pdf;
+
+  /// Wall-clock time to load the whole set, with different numbers of loading threads
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const int nmax = max(thread::hardware_concurrency(), 1u);
+  for (int nthreads : {1, 2, 4, nmax}) {
+    const chrono::steady_clock::time_point wstart = chrono::steady_clock::now();
+    const vector<LHAPDF::PDF*> tpdfs = LHAPDF::getPDFSet(setname).mkPDFs(nthreads);
+    const chrono::duration<double> wtime = chrono::steady_clock::now() - wstart;
+    std::cout << "Load (" << nthreads << " threads) = " << wtime.count() << " s" << std::endl;
+    for (const LHAPDF::PDF* pdf : tpdfs) delete pdf;
+  }
   #endif
 
   return 0;
@@ -0,0 +1,73 @@
+// Test of the vectorised interpolation kernels at each SIMD level supported by the host, checking their precision
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+// Largest difference from the reference values, in units of max(|xf|, 1)
+double maxdev(const vector<double>& xfs, const vector<double>& refs) {
+  double rtn = 0;
+  for (size_t i = 0; i < xfs.size(); ++i)
+    rtn = max(rtn, fabs(xfs[i] - refs[i]) / max(fabs(refs[i]), 1.0));
+  return rtn;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 2000;
+  const double tolerance = 1e-12;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over the grid, since only the interpolation is vectorised
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf->xMin()), log10(pdf->xMax()), log10(pdf->q2Min()), log10(pdf->q2Max()), xs, q2s);
+
+  cout << "Host SIMD level: " << LHAPDF::simdLevelName(LHAPDF::simdLevelSupported()) << endl;
+  bool ok = true;
+  const vector<string> ipols = {"linear", "log", "cubic", "logcubic"};
+  for (const string& ipol : ipols) {
+    vector<double> refnf, refbatch;
+    for (int ilevel = LHAPDF::SIMD_NONE; ilevel <= LHAPDF::simdLevelSupported(); ++ilevel) {
+      const LHAPDF::SIMDLevel level = LHAPDF::SIMDLevel(ilevel);
+      pdf->info().set_entry("SIMD", LHAPDF::simdLevelName(level));
+      pdf->setInterpolator(ipol);
+
+      // All partons at each point, vectorised across the flavors
+      vector<double> xfsnf(13*npoints), xfs;
+      for (size_t i = 0; i < npoints; ++i) {
+        pdf->xfxQ2(xs[i], q2s[i], xfs);
+        copy(xfs.begin(), xfs.end(), xfsnf.begin() + 13*i);
+      }
+
+      // Gluon at all the points, vectorised across the points
+      vector<double> xfsbatch(npoints);
+      pdf->xfxQ2(21, xs.data(), q2s.data(), npoints, xfsbatch.data());
+
+      if (level == LHAPDF::SIMD_NONE) {
+        refnf = xfsnf; refbatch = xfsbatch;
+      }
+      const double dev = max(maxdev(xfsnf, refnf), maxdev(xfsbatch, refbatch));
+      if (dev > tolerance) ok = false;
+      cout << ipol << " " << LHAPDF::simdLevelName(level) << ": max deviation = " << dev << endl;
+    }
+
+    // "auto" only enables the kernels for the cubic interpolators
+    pdf->info().set_entry("SIMD", "auto");
+    pdf->setInterpolator(ipol);
+    const bool linear = (ipol == "linear" || ipol == "log");
+    if (pdf->interpolator().simdLevel() != (linear ? LHAPDF::SIMD_NONE : LHAPDF::simdLevelSupported())) ok = false;
+  }
+
+  cout << (ok ? "Vectorised values are within the tolerance" : "Vectorised values exceed the tolerance!") << endl;
+  delete pdf;
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+// Benchmark of the vectorised interpolation kernels at each SIMD level supported by the host
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+using namespace std;
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = (argc < 3) ? 20000 : atoi(argv[2]);
+  LHAPDF::setVerbosity(0);
+  LHAPDF::GridPDF* pdf = dynamic_cast<LHAPDF::GridPDF*>(LHAPDF::mkPDF(setname, 0));
+
+  // Random points, log-distributed over the grid, since only the interpolation is vectorised
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, log10(pdf->xMin()), log10(pdf->xMax()), log10(pdf->q2Min()), log10(pdf->q2Max()), xs, q2s);
+
+  cout << "Host SIMD level: " << LHAPDF::simdLevelName(LHAPDF::simdLevelSupported()) << endl;
+  const vector<string> ipols = {"linear", "log", "cubic", "logcubic"};
+  for (const string& ipol : ipols) {
+    clock_t t0nf = 1, t0batch = 1;
+    for (int ilevel = LHAPDF::SIMD_NONE; ilevel <= LHAPDF::simdLevelSupported(); ++ilevel) {
+      const LHAPDF::SIMDLevel level = LHAPDF::SIMDLevel(ilevel);
+      pdf->info().set_entry("SIMD", LHAPDF::simdLevelName(level));
+      pdf->setInterpolator(ipol);
+
+      // All partons at each point, vectorised across the flavors
+      vector<double> xfsnf(13*npoints), xfs;
+      clock_t start = clock();
+      for (size_t i = 0; i < npoints; ++i) {
+        pdf->xfxQ2(xs[i], q2s[i], xfs);
+        copy(xfs.begin(), xfs.end(), xfsnf.begin() + 13*i);
+      }
+      const clock_t tnf = max(clock() - start, clock_t(1));
+
+      // Gluon at all the points, vectorised across the points
+      vector<double> xfsbatch(npoints);
+      start = clock();
+      for (int n = 0; n < 10; ++n)
+        pdf->xfxQ2(21, xs.data(), q2s.data(), npoints, xfsbatch.data());
+      const clock_t tbatch = max(clock() - start, clock_t(1));
+
+      if (level == LHAPDF::SIMD_NONE) {
+        t0nf = tnf; t0batch = tbatch;
+      }
+      cout << setw(9) << left << ipol << setw(7) << LHAPDF::simdLevelName(level) << right
+           << ": all-parton = " << setw(6) << tnf << " (x" << fixed << setprecision(2) << double(t0nf)/tnf << ")"
+           << ", batch = " << setw(6) << tbatch << " (x" << double(t0batch)/tbatch << ")" << endl;
+      cout.unsetf(ios::floatfield);
+    }
+  }
+
+  delete pdf;
+  return 0;
+}
@@ -0,0 +1,98 @@
+// Multi-threaded stress test of concurrent queries on shared PDF and AlphaS objects, for use with ThreadSanitizer
+
+#include "LHAPDF/LHAPDF.h"
+#include "LHAPDF/GridPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+/// A PDF not loaded from file, whose flavor list is cached on first use
+struct AnalyticPDF : public LHAPDF::PDF {
+  AnalyticPDF() { info().set_entry("Flavors", "-5,-4,-3,-2,-1,21,1,2,3,4,5"); }
+  double _xfxQ2(int id, double x, double q2) const { return 0.15 * sin(20.0*x) * sin(20.0*log(q2)) + id; }
+  bool inRangeX(double x) const { return true; }
+  bool inRangeQ2(double q2) const { return true; }
+};
+
+
+/// An ODE alpha_s solver with fixed parameters
+LHAPDF::AlphaS_ODE* mkODE() {
+  LHAPDF::AlphaS_ODE* as = new LHAPDF::AlphaS_ODE();
+  as->setMZ(91.1876);
+  as->setAlphaSMZ(0.118);
+  as->setOrderQCD(4);
+  return as;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const string setname = (argc < 2) ? "CT10nlo" : argv[1];
+  const size_t npoints = 2000, nthreads = 4;
+  requirePDFSet(setname);
+  LHAPDF::setVerbosity(0);
+
+  // Random points, log-distributed over and slightly beyond the grid, and reference values from private objects
+  vector<double> xs, q2s;
+  randomLogPoints(npoints, xs, q2s);
+  const int ids[] = { -5, -4, -3, -2, -1, 21, 1, 2, 3, 4, 5, 22 };
+  vector<double> refxfs, refas, refode, refanalytic;
+  {
+    const unique_ptr<LHAPDF::PDF> pdf(LHAPDF::mkPDF(setname, 0));
+    const unique_ptr<LHAPDF::AlphaS_ODE> ode(mkODE());
+    const AnalyticPDF analytic;
+    for (size_t i = 0; i < npoints; ++i) {
+      for (int id : ids) refxfs.push_back(pdf->xfxQ2(id, xs[i], q2s[i]));
+      refas.push_back(pdf->alphasQ2(q2s[i]));
+      refode.push_back(ode->alphasQ2(q2s[i]));
+      refanalytic.push_back(analytic.xfxQ2(2, xs[i], q2s[i]));
+    }
+  }
+
+  // Shared objects, first queried concurrently
+  const unique_ptr<const LHAPDF::PDF> pdf(LHAPDF::mkPDF(setname, 0));
+  const unique_ptr<const LHAPDF::AlphaS_ODE> ode(mkODE());
+  const AnalyticPDF analytic;
+  vector<size_t> nbad(nthreads, 0);
+  vector<thread> threads;
+  for (size_t ithread = 0; ithread < nthreads; ++ithread) {
+    threads.push_back(thread([&, ithread]() {
+      vector<double> xfs;
+      for (size_t n = 0; n < npoints; ++n) {
+        // Each thread walks the points from a different start
+        const size_t i = (n + ithread*npoints/nthreads) % npoints;
+        size_t k = 0;
+        for (int id : ids)
+          if (pdf->xfxQ2(id, xs[i], q2s[i]) != refxfs[i*12 + k++]) nbad[ithread] += 1;
+        pdf->xfxQ2(xs[i], q2s[i], xfs);
+        if (xfs[6] != refxfs[i*12 + 5]) nbad[ithread] += 1;
+        if (pdf->alphasQ2(q2s[i]) != refas[i]) nbad[ithread] += 1;
+        if (ode->alphasQ2(q2s[i]) != refode[i]) nbad[ithread] += 1;
+        if (analytic.xfxQ2(2, xs[i], q2s[i]) != refanalytic[i]) nbad[ithread] += 1;
+      }
+    }));
+  }
+  for (thread& t : threads) t.join();
+
+  size_t ntotal = 0;
+  for (size_t ithread = 0; ithread < nthreads; ++ithread) {
+    cout << "Thread " << ithread << ": " << nbad[ithread] << " mismatches" << endl;
+    ntotal += nbad[ithread];
+  }
+
+  // The cached metadata is read on first use, so it can still be changed after loading
+  const unique_ptr<LHAPDF::PDF> pdf2(LHAPDF::mkPDF(setname, 0));
+  pdf2->info().set_entry("ForcePositive", 2);
+  if (pdf2->forcePositive() != 2) ntotal += 1;
+  pdf2->setForcePositive(1);
+  if (pdf2->forcePositive() != 1 || pdf2->info().get_entry_as<int>("ForcePositive") != 1) ntotal += 1;
+  pdf2->setFlavors({21, 2, 1});
+  if (pdf2->flavors() != vector<int>({1, 2, 21}) || pdf2->hasFlavor(-1)) ntotal += 1;
+
+  cout << (ntotal == 0 ? "Concurrent values match the serial ones" : "Concurrent values differ from the serial ones!") << endl;
+  return ntotal == 0 ? 0 : 1;
+}
@@ -0,0 +1,85 @@
+// Test of the streaming uncertainty accumulator, checking it against PDFSet::uncertainty on the summed member values
+
+#include "LHAPDF/LHAPDF.h"
+#include "testutils.h"
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+using namespace std;
+
+
+/// Do two uncertainties agree, to relative precision @a eps?
+bool agree(const LHAPDF::PDFUncertainty& a, const LHAPDF::PDFUncertainty& b, double eps) {
+  const double va[] = { a.central, a.errplus, a.errminus, a.errsymm, a.scale, a.errplus_pdf, a.errminus_pdf, a.errsymm_pdf, a.err_par };
+  const double vb[] = { b.central, b.errplus, b.errminus, b.errsymm, b.scale, b.errplus_pdf, b.errminus_pdf, b.errsymm_pdf, b.err_par };
+  for (size_t i = 0; i < 9; ++i)
+    if (fabs(va[i] - vb[i]) > eps * max(fabs(va[i]), 1.0)) return false;
+  return true;
+}
+
+
+int main(int argc, char* argv[]) {
+
+  const size_t nevents = 2000, nbins = 20;
+  requirePDFSet("CT10nlo");
+  requirePDFSet("NNPDF23_nlo_as_0118");
+  LHAPDF::setVerbosity(0);
+
+  // Hessian and replica sets, and the Hessian one relabelled as symmetric and with parameter variations
+  LHAPDF::PDFSet hessian("CT10nlo"), symmhessian("CT10nlo"), hessianas("CT10nlo"), replicas("NNPDF23_nlo_as_0118");
+  symmhessian.set_entry("ErrorType", "symmhessian");
+  hessianas.set_entry("ErrorType", "hessian+as");
+  const LHAPDF::PDFSet* sets[] = { &hessian, &symmhessian, &hessianas, &replicas };
+
+  bool ok = true;
+  seedRandom();
+  for (const LHAPDF::PDFSet* set : sets) {
+    const size_t nmem = set->size();
+    for (double cl : { -1.0, 100*erf(1/sqrt(2)), 90.0 }) {
+      // Events each filling one bin, with a weight and per-member values spread around the central one,
+      // into one accumulator, and alternately into two to be merged, with the member totals kept for comparison
+      LHAPDF::UncertaintyAccumulator acc(*set, nbins, cl), acc1(*set, nbins, cl), acc2(*set, nbins, cl);
+      vector< vector<double> > totals(nbins, vector<double>(nmem, 0.0));
+      vector<double> values(nmem);
+      for (size_t ievt = 0; ievt < nevents; ++ievt) {
+        const size_t ibin = rand() % nbins;
+        const double weight = randomUniform(0.5, 1.5);
+        for (size_t imem = 0; imem < nmem; ++imem)
+          values[imem] = 1 + randomUniform(-0.05, 0.05) * (imem > 0);
+        acc.fill(ibin, values, weight);
+        (ievt % 2 ? acc1 : acc2).fill(ibin, values.data(), weight);
+        for (size_t imem = 0; imem < nmem; ++imem) totals[ibin][imem] += weight * values[imem];
+      }
+      acc1.merge(acc2);
+
+      // A separate job's sums, merged into an empty accumulator
+      LHAPDF::UncertaintyAccumulator job(*set, nbins, cl);
+      job.merge(acc.sums());
+
+      for (size_t ibin = 0; ibin < nbins; ++ibin) {
+        const LHAPDF::PDFUncertainty ref = set->uncertainty(totals[ibin], cl);
+        // The same sums in the same order give identical results, and merged ones agree up to rounding
+        if (!agree(acc.uncertainty(ibin), ref, 0) || !agree(job.uncertainty(ibin), ref, 0)) ok = false;
+        if (!agree(acc1.uncertainty(ibin), ref, 1e-10)) ok = false;
+        if (set == &replicas && !agree(acc.uncertainty(ibin, true), set->uncertainty(totals[ibin], cl, true), 0)) ok = false;
+      }
+    }
+    const LHAPDF::PDFUncertainty unc = LHAPDF::UncertaintyAccumulator(*set, 1).uncertainty(vector<double>(nmem, 1.0).data());
+    cout << set->errorType() << ": " << nmem << " members, uncertainty of a constant = " << unc.errsymm << endl;
+  }
+
+  // Mismatched accumulators cannot be merged, and reset clears the sums
+  LHAPDF::UncertaintyAccumulator a(hessian, 3), b(hessian, 4);
+  try {
+    a.merge(b);
+    ok = false;
+  } catch (const LHAPDF::UserError&) { }
+  a.fillMember(1, 5, 2.0);
+  a.fillMember(1, 0, 2.0, 0.5);
+  if (a.sums(1)[5] != 2.0 || a.sums(1)[0] != 1.0) ok = false;
+  a.reset();
+  for (double s : a.sums()) if (s != 0) ok = false;
+
+  cout << (ok ? "Accumulated uncertainties match PDFSet::uncertainty" : "Accumulated uncertainties differ from PDFSet::uncertainty!") << endl;
+  return ok ? 0 : 1;
+}
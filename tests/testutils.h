@@ -0,0 +1,71 @@
+// -*- C++ -*-
+//
+// This file is part of LHAPDF
+// Copyright (C) 2012-2016 The LHAPDF collaboration (see AUTHORS for details)
+//
+// Shared helpers for the test programs
+#pragma once
+#ifndef LHAPDF_TestUtils_H
+#define LHAPDF_TestUtils_H
+
+#include "LHAPDF/Paths.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+
+/// Reseed the random number sequence, so that every test run uses the same values
+inline void seedRandom() {
+  srand(1234);
+}
+
+/// A random number uniformly distributed between @a a and @a b
+inline double randomUniform(double a=0, double b=1) {
+  return a + (b - a)*rand()/double(RAND_MAX);
+}
+
+/// @brief Random values, uniformly distributed in log10 between @a log10min and @a log10max
+///
+/// The sequence is reseeded first, so that the values are the same in every call.
+inline std::vector<double> randomLogValues(size_t n, double log10min, double log10max) {
+  seedRandom();
+  std::vector<double> rtn(n);
+  for (size_t i = 0; i < n; ++i) rtn[i] = pow(10, randomUniform(log10min, log10max));
+  return rtn;
+}
+
+/// @brief Fill @a xs and @a q2s with @a n random points, uniformly distributed in log10(x) and log10(Q2)
+///
+/// The sequence is reseeded first, so that the points are the same in every call.
+inline void randomLogPoints(size_t n, double log10xmin, double log10xmax, double log10q2min, double log10q2max,
+                            std::vector<double>& xs, std::vector<double>& q2s) {
+  seedRandom();
+  xs.resize(n);
+  q2s.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    xs[i] = pow(10, randomUniform(log10xmin, log10xmax));
+    q2s[i] = pow(10, randomUniform(log10q2min, log10q2max));
+  }
+}
+
+/// @brief Fill @a xs and @a q2s with @a n random points, log-distributed over and slightly beyond a typical grid
+///
+/// Covering 10^-8.2 < x < 1 and 10^0.2 < Q2 < 10^9.2 GeV2, so including extrapolation at low x and at both Q2 ends.
+inline void randomLogPoints(size_t n, std::vector<double>& xs, std::vector<double>& q2s) {
+  randomLogPoints(n, -8.2, 0.0, 0.2, 9.2, xs, q2s);
+}
+
+
+/// @brief Exit with the automake SKIP status, 77, if the PDF set @a setname is not installed
+///
+/// For the checks run by make check, which need data that is not shipped with the code.
+inline void requirePDFSet(const std::string& setname) {
+  if (!LHAPDF::findpdfsetinfopath(setname).empty()) return;
+  std::cout << "PDF set " << setname << " not found: skipping" << std::endl;
+  exit(77);
+}
+
+
+#endif
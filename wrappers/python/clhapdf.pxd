@@ -22,6 +22,7 @@ cdef extern from "../../include/LHAPDF/PDF.h" namespace "LHAPDF":
         map[int,double] xfxQ2(double, double) except +
         double alphasQ(double) except +
         double alphasQ2(double) except +
+        void alphasQ2(const double*, double*, size_t) except +
         double xMin()
         double xMax()
         double q2Min()
@@ -87,6 +88,7 @@ cdef extern from "../../include/LHAPDF/AlphaS.h" namespace "LHAPDF":
         string type() except +
         double alphasQ(double q) except +
         double alphasQ2(double q2) except +
+        void alphasQ2(const double* q2s, double* out, size_t n) except +
         int numFlavorsQ(double q) except +
         int numFlavorsQ2(double q2) except +
         double quarkMass(int id) except +
@@ -94,8 +94,15 @@ cdef class PDF:
         return self._ptr.alphasQ(q)
 
     def alphasQ2(self, q2):
-        "Return alpha_s at q2"
-        return self._ptr.alphasQ2(q2)
+        "Return alpha_s at q2, or a list of values if q2 is a sequence of scales"
+        cdef vector[double] q2s, rtn
+        if not hasattr(q2, "__iter__"):
+            return self._ptr.alphasQ2(<double>q2)
+        q2s = q2
+        rtn.resize(q2s.size())
+        if q2s.size() > 0:
+            self._ptr.alphasQ2(q2s.data(), rtn.data(), q2s.size())
+        return rtn
 
     def xfxQ(self, *args):
         """Return the PDF xf(x,Q2) value for the given parton ID, x, and Q values.
@@ -465,9 +472,16 @@ cdef class AlphaS:
          "Get alpha_s value at scale q"
          return self._ptr.alphasQ(q)
 
-     def alphasQ2(self, double q2):
-         "Get alpha_s value at scale q"
-         return self._ptr.alphasQ2(q2)
+     def alphasQ2(self, q2):
+         "Get alpha_s value at scale q2, or a list of values if q2 is a sequence of scales"
+         cdef vector[double] q2s, rtn
+         if not hasattr(q2, "__iter__"):
+             return self._ptr.alphasQ2(<double>q2)
+         q2s = q2
+         rtn.resize(q2s.size())
+         if q2s.size() > 0:
+             self._ptr.alphasQ2(q2s.data(), rtn.data(), q2s.size())
+         return rtn
 
      def numFlavorsQ(self, double q):
          "Get number of active flavors at scale q"